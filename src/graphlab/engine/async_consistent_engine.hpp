@@ -1240,9 +1240,15 @@ namespace graphlab {
       thrgroup.set_stacksize(stacksize);
         
       size_t effncpus = std::min(ncpus, fiber_control::get_instance().num_workers());
+      size_t fiber_steals = fiber_control::get_instance().total_steals();
+      size_t idle_waits = fiber_control::get_instance().total_idle_waits();
+      // The fibers may run on, and be stolen by, any of the first effncpus
+      // workers. The per worker state above is indexed by worker id.
+      fiber_control::affinity_type worker_affinity;
+      for (size_t i = 0; i < effncpus; ++i) worker_affinity.set_bit(i);
       for (size_t i = 0; i < nfibers ; ++i) {
         thrgroup.launch(boost::bind(&engine_type::thread_start, this, i), 
-                        i % effncpus);
+                        worker_affinity);
       }
       thrgroup.join();
       aggregator.stop();
@@ -1266,6 +1272,14 @@ namespace graphlab {
       rmi.all_reduce(numadds);
       rmi.cout() << "Schedule Adds: " << numadds << std::endl;
 
+      fiber_steals = fiber_control::get_instance().total_steals() - fiber_steals;
+      rmi.all_reduce(fiber_steals);
+      rmi.cout() << "Fiber Steals: " << fiber_steals << std::endl;
+
+      idle_waits = fiber_control::get_instance().total_idle_waits() - idle_waits;
+      rmi.all_reduce(idle_waits);
+      rmi.cout() << "Worker Idle Waits: " << idle_waits << std::endl;
+
       if (track_task_time) {
         double total_task_time = 0;
         for (size_t i = 0;i < total_completion_time.size(); ++i) {
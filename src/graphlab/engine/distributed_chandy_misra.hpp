@@ -35,6 +35,8 @@ namespace graphlab {
 /**
   *
   * \internal
+  * The fork messages are sent with the LATENCY_SEND class since
+  * hungry philosophers wait on them.
   */
 template <typename GraphType>
 class distributed_chandy_misra {
@@ -271,11 +273,13 @@ class distributed_chandy_misra {
         
         if (requestor != rmi.procid()) {
           unsigned char pkey = rmi.dc().set_sequentialization_key(gvid % 254 + 1);
+          dc_send_class pclass = rmi.dc().set_send_class(LATENCY_SEND);
           rmi.remote_call(requestor,
                           &dcm_type::rpc_cancellation_accept,
                           gvid,
                           lockid);
           rmi.dc().set_sequentialization_key(pkey);
+          rmi.dc().set_send_class(pclass);
         }
         else {
           cancellation_accept_unlocked(lvid, lockid);
@@ -313,12 +317,14 @@ class distributed_chandy_misra {
     }
     else {
       unsigned char pkey = rmi.dc().set_sequentialization_key(lvertex.global_id() % 254 + 1);
+      dc_send_class pclass = rmi.dc().set_send_class(LATENCY_SEND);
       rmi.remote_call(lvertex.owner(),
                     &dcm_type::rpc_cancellation_request,
                     lvertex.global_id(),
                     rmi.procid(), 
                     lockid);
       rmi.dc().set_sequentialization_key(pkey);
+      rmi.dc().set_send_class(pclass);
 
     }
   }
@@ -524,11 +530,13 @@ class distributed_chandy_misra {
     }
     else {
       unsigned char pkey = rmi.dc().set_sequentialization_key(lvertex.global_id() % 254 + 1);
+      dc_send_class pclass = rmi.dc().set_send_class(LATENCY_SEND);
       if (hors_doeuvre_callback != NULL) hors_doeuvre_callback(p_id);
       rmi.remote_call(lvertex.owner(),
                       &dcm_type::rpc_signal_ready,
                       lvertex.global_id(), philosopherset[p_id].lockid);
       rmi.dc().set_sequentialization_key(pkey);
+      rmi.dc().set_send_class(pclass);
     }
   }
 
@@ -572,10 +580,12 @@ class distributed_chandy_misra {
       // broadcast EATING
       local_vertex_type lvertex(graph.l_vertex(lvid));
       unsigned char pkey = rmi.dc().set_sequentialization_key(lvertex.global_id() % 254 + 1);
+      dc_send_class pclass = rmi.dc().set_send_class(LATENCY_SEND);
       rmi.remote_call(lvertex.mirrors().begin(), lvertex.mirrors().end(),
                       &dcm_type::rpc_set_eating, lvertex.global_id(), lockid);
       set_eating(lvid, lockid);
       rmi.dc().set_sequentialization_key(pkey);
+      rmi.dc().set_send_class(pclass);
     }
     else {
       philosopherset[lvid].lock.unlock();
@@ -785,9 +795,11 @@ class distributed_chandy_misra {
     philosopherset[p_id].lock.unlock();
     
     unsigned char pkey = rmi.dc().set_sequentialization_key(lvertex.global_id() % 254 + 1);
+    dc_send_class pclass = rmi.dc().set_send_class(LATENCY_SEND);
     rmi.remote_call(lvertex.mirrors().begin(), lvertex.mirrors().end(),
                     &dcm_type::rpc_make_philosopher_hungry, lvertex.global_id(), newlockid);
     rmi.dc().set_sequentialization_key(pkey);
+    rmi.dc().set_send_class(pclass);
     local_philosopher_grabs_forks(p_id);
   }
   
@@ -827,9 +839,11 @@ class distributed_chandy_misra {
     philosopherset[p_id].counter = 0;
     philosopherset[p_id].lock.unlock();
     unsigned char pkey = rmi.dc().set_sequentialization_key(lvertex.global_id() % 254 + 1);
+    dc_send_class pclass = rmi.dc().set_send_class(LATENCY_SEND);
     rmi.remote_call(lvertex.mirrors().begin(), lvertex.mirrors().end(),
                     &dcm_type::rpc_philosopher_stops_eating, lvertex.global_id());
     rmi.dc().set_sequentialization_key(pkey);
+    rmi.dc().set_send_class(pclass);
     local_philosopher_stops_eating(p_id);
   }
 
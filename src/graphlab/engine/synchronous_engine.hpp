@@ -42,8 +42,11 @@
 
 #include <graphlab/parallel/pthread_tools.hpp>
 #include <graphlab/parallel/fiber_barrier.hpp>
+#include <graphlab/parallel/work_stealing_ranges.hpp>
+#include <graphlab/parallel/numa_tools.hpp>
 #include <graphlab/util/tracepoint.hpp>
 #include <graphlab/util/memory_info.hpp>
+#include <graphlab/util/frontier_bitset.hpp>
 
 #include <graphlab/rpc/dc_dist_object.hpp>
 #include <graphlab/rpc/distributed_event_log.hpp>
@@ -199,6 +202,37 @@ namespace graphlab {
    * for the snapshot. The path including folder and file prefix in
    * which the snapshots should be saved.
    *
+   * \li \b snapshot_incremental (default: false) If set to true, only
+   * the first snapshot is a full binary dump of the graph (see
+   * \ref graphlab::distributed_graph::save_binary_base). Every later
+   * snapshot only writes the vertex data changed by apply and the edge
+   * data of the edges touched by scatter since the previous snapshot
+   * (see \ref graphlab::distributed_graph::save_binary_delta). Changes
+   * made to edge data in gather are not captured. The snapshot is
+   * restored with \ref graphlab::distributed_graph::load_binary_incremental.
+   *
+   * \li \b direction (default: push) The direction in which the
+   * scatter phase runs. "push" runs scatter top-down from every
+   * scattering vertex. "pull" runs it bottom-up: every vertex walks its
+   * \ref graphlab::ivertex_program::pull_edges and invokes scatter for
+   * the neighbors which are scattering, until
+   * \ref graphlab::ivertex_program::pull_complete reports that it
+   * needs no more scatters. Vertices whose pull_edges are NO_EDGES are
+   * skipped. "auto" picks the direction every iteration, pulling once
+   * the edges of the scattering vertices exceed 1/direction_alpha of
+   * the edges of the vertices which would pull. Only takes effect if
+   * the vertex program declares \ref
+   * graphlab::ivertex_program::supports_pull. The direction used by
+   * each iteration is logged and available through pull_iterations().
+   *
+   * \li \b direction_alpha (default: 2) See \b direction.
+   *
+   * \li \b hub_gather_threshold (default: 100000) The gather of a
+   * vertex with at least this many local gather edges is split into
+   * edge ranges which are gathered by all threads. The partial sums
+   * are merged in edge order with the gather_type operator+=. 0
+   * disables the split.
+   *
    * \see graphlab::omni_engine
    * \see graphlab::async_consistent_engine
    * \see graphlab::semi_synchronous_engine
@@ -310,6 +344,11 @@ namespace graphlab {
      */
     typedef typename graph_type::local_edge_type      local_edge_type;
 
+    /**
+     * \brief Local edge list type used by the engine for fast indexing
+     */
+    typedef typename graph_type::local_edge_list_type local_edge_list_type;
+
     /**
      * \brief Local vertex id type used by the engine for fast indexing
      */
@@ -383,6 +422,18 @@ namespace graphlab {
     /// \brief The target base name the snapshot is saved in.
     std::string snapshot_path;
 
+    /**
+     * \brief If set, snapshots after the first one only save the vertex
+     * and edge data which changed since the previous snapshot.
+     */
+    bool snapshot_incremental;
+
+    /**
+     * \brief True once the full base of the incremental snapshot has
+     * been saved in the current call to start.
+     */
+    bool snapshot_base_saved;
+
     /**
      * \brief A counter that tracks the current iteration number since
      * start was last invoked.
@@ -404,6 +455,77 @@ namespace graphlab {
      */
     bool sched_allv;
 
+    /**
+     * \brief The direction of the scatter phase: "push", "pull" or
+     * "auto".
+     */
+    std::string direction;
+
+    /**
+     * \brief In the "auto" direction scatter is pulled once the
+     * scattering vertices have more than 1/direction_alpha of the edges
+     * of the pulling vertices.
+     */
+    double direction_alpha;
+
+    /**
+     * \brief Vertices with at least this many local gather edges are
+     * gathered by all threads in parallel. 0 disables it.
+     */
+    size_t hub_gather_threshold;
+
+    /**
+     * \brief A vertex whose gather is split into edge ranges. The
+     * gather edges are numbered in edges first (if gathered), then out
+     * edges.
+     */
+    struct hub_gather_record {
+      lvid_type lvid;
+      edge_dir_type gather_dir;
+      /// the number of gathered in edges
+      size_t num_in;
+      /// the number of gathered edges
+      size_t num_edges;
+      /// the index of the first task of the vertex in hub_tasks
+      size_t first_task;
+    };
+
+    /**
+     * \brief The gather edge range [begin, end) of a hub handled by
+     * one thread.
+     */
+    struct hub_gather_task {
+      size_t hub;
+      size_t begin, end;
+    };
+
+    /// \brief The hubs of the current gather phase
+    std::vector<hub_gather_record> hub_gathers;
+    simple_spinlock hub_gathers_lock;
+    std::vector<hub_gather_task> hub_tasks;
+    /// \brief The partial gather of every task and whether it is set
+    std::vector<gather_type> hub_partials;
+    std::vector<char> hub_partial_set;
+    atomic<size_t> hub_task_counter;
+
+    /**
+     * \brief True for each iteration of the last call to start whose
+     * scatter phase was pulled.
+     */
+    std::vector<bool> pull_iteration_flags;
+
+    /**
+     * \brief The number of local edges along which the vertices active
+     * in the current minor-step scatter.
+     */
+    atomic<size_t> num_scatter_edges;
+
+    /**
+     * \brief The number of local edges along which vertices would pull
+     * in the current minor-step.
+     */
+    atomic<size_t> num_pull_edges;
+
     /**
      * \brief Used to stop the engine prematurely
      */
@@ -443,7 +565,7 @@ namespace graphlab {
     /**
      * \brief Bit indicating whether a message is present for each vertex.
      */
-    dense_bitset has_message;
+    frontier_bitset<lvid_type> has_message;
 
 
     /**
@@ -467,7 +589,7 @@ namespace graphlab {
      * set while holding the lock in
      * \ref graphlab::synchronous_engine::vlocks.
      */
-    dense_bitset has_gather_accum;
+    frontier_bitset<lvid_type> has_gather_accum;
 
 
     /**
@@ -488,8 +610,13 @@ namespace graphlab {
     /**
      * \brief A bit (for master vertices) indicating if that vertex is active
      * (received a message on this iteration).
+     *
+     * This and the other per-iteration bitsets are frontier bitsets:
+     * while only a few vertices are active they are iterated and
+     * cleared through a list of the set positions rather than by
+     * scanning every word.
      */
-    dense_bitset active_superstep;
+    frontier_bitset<lvid_type> active_superstep;
 
     /**
      * \brief  The number of local vertices (masters) that are active on this
@@ -501,7 +628,34 @@ namespace graphlab {
      * \brief A bit indicating (for all vertices) whether to
      * participate in the current minor-step (gather or scatter).
      */
-    dense_bitset active_minorstep;
+    frontier_bitset<lvid_type> active_minorstep;
+
+    /**
+     * \brief A bit indicating (for all vertices) whether the vertex
+     * data changed since the last incremental snapshot.
+     */
+    dense_bitset snapshot_dirty_vertices;
+
+    /**
+     * \brief A bit indicating (for all vertices) whether the in edges
+     * of the vertex were scattered on since the last incremental
+     * snapshot.
+     */
+    dense_bitset snapshot_dirty_in_edges;
+
+    /**
+     * \brief A bit indicating (for all vertices) whether the out edges
+     * of the vertex were scattered on since the last incremental
+     * snapshot.
+     */
+    dense_bitset snapshot_dirty_out_edges;
+
+    /**
+     * \brief The edges (by local edge id) written to an incremental
+     * snapshot. Built from the per vertex bits when the snapshot is
+     * taken.
+     */
+    dense_bitset snapshot_dirty_edges;
 
     /**
      * \brief A counter measuring the number of applys that have been completed
@@ -515,11 +669,65 @@ namespace graphlab {
      */
     atomic<size_t> shared_lvid_counter;
 
+    /**
+     * \brief The chunks of the frontier handed out to the threads of
+     * the gather and scatter phases. Unlike shared_lvid_counter the
+     * chunks hold about the same number of edges, and idle threads
+     * steal chunks from busy ones.
+     */
+    work_stealing_ranges vertex_ranges;
+
+    /**
+     * \brief vertex_cost_prefix[v] is the number of vertices before
+     * lvid v plus their edges, the estimated cost of a gather or
+     * scatter over them.
+     */
+    std::vector<size_t> vertex_cost_prefix;
+
+    /**
+     * \brief True if the gather of some local vertex may exceed
+     * hub_gather_threshold. Otherwise the gather phase skips the hub
+     * gathers and the barrier they need.
+     */
+    bool has_hub_vertices;
+
+
+    /**
+     * \brief The position of a vertex in the ordered list of vertices
+     * shared between its master and one of its mirrors. Exchanges
+     * address vertices by slot so that the receiver can find the local
+     * vertex with an array lookup instead of a vid2lvid probe.
+     */
+    typedef uint32_t slot_type;
+
+    /**
+     * \brief For every machine, the local ids of the vertices mastered
+     * by this machine which have a mirror on that machine, ordered by
+     * global id. Indexed by the slots of incoming gathers and messages.
+     */
+    std::vector<std::vector<lvid_type> > master_slot_lvids;
+
+    /**
+     * \brief For every machine, the local ids of the mirrors on this
+     * machine of vertices mastered by that machine, ordered by global
+     * id. Indexed by the slots of incoming vertex programs and data.
+     */
+    std::vector<std::vector<lvid_type> > mirror_slot_lvids;
+
+    /**
+     * \brief The outgoing slots of each local vertex. A master has one
+     * slot per mirror in the iteration order of its mirror set, a
+     * mirror has the single slot used to reach its master. The slots of
+     * lvid are lvid_slots[lvid_slot_begin[lvid]] up to
+     * lvid_slots[lvid_slot_begin[lvid + 1]].
+     */
+    std::vector<slot_type> lvid_slots;
+    std::vector<size_t> lvid_slot_begin;
 
     /**
      * \brief The pair type used to synchronize vertex programs across machines.
      */
-    typedef std::pair<vertex_id_type, vertex_program_type> vid_prog_pair_type;
+    typedef std::pair<slot_type, vertex_program_type> vid_prog_pair_type;
 
     /**
      * \brief The type of the exchange used to synchronize vertex programs
@@ -535,7 +743,7 @@ namespace graphlab {
     /**
      * \brief The pair type used to synchronize vertex across across machines.
      */
-    typedef std::pair<vertex_id_type, vertex_data_type> vid_vdata_pair_type;
+    typedef std::pair<slot_type, vertex_data_type> vid_vdata_pair_type;
 
     /**
      * \brief The type of the exchange used to synchronize vertex data
@@ -551,7 +759,7 @@ namespace graphlab {
     /**
      * \brief The pair type used to synchronize the results of the gather phase
      */
-    typedef std::pair<vertex_id_type, gather_type> vid_gather_pair_type;
+    typedef std::pair<slot_type, gather_type> vid_gather_pair_type;
 
     /**
      * \brief The type of the exchange used to synchronize gather
@@ -568,7 +776,7 @@ namespace graphlab {
     /**
      * \brief The pair type used to synchronize messages
      */
-    typedef std::pair<vertex_id_type, message_type> vid_message_pair_type;
+    typedef std::pair<slot_type, message_type> vid_message_pair_type;
 
     /**
      * \brief The type of the exchange used to synchronize messages
@@ -668,6 +876,13 @@ namespace graphlab {
      */
     int iteration() const;
 
+    /**
+     * \brief Returns, for each iteration run by the last call to
+     * start(), true if its scatter phase ran bottom-up (see the
+     * \c direction engine option).
+     */
+    const std::vector<bool>& pull_iterations() const;
+
 
     /**
      * \brief Compute the total memory used by the entire distributed
@@ -703,6 +918,14 @@ namespace graphlab {
      */
     void resize();
 
+    /**
+     * \brief Build the slot tables used to address vertices in the
+     * exchanges between masters and mirrors. Both sides of every
+     * (master, mirror) machine pair order the vertices they share by
+     * global id, so the tables agree without any communication.
+     */
+    void build_mirror_slots();
+
     /**
      * \brief This internal stop function is called by the \ref graphlab::context to
      * terminate execution of the engine.
@@ -764,6 +987,15 @@ namespace graphlab {
      */
     void internal_clear_gather_cache(const vertex_type& vertex);
 
+    /**
+     * \brief Save a snapshot of the graph to the snapshot path.
+     *
+     * Saves a full binary dump of the graph, or if incremental
+     * snapshots are enabled and a base has already been saved, only the
+     * vertex and edge data which changed since the last snapshot.
+     */
+    void save_snapshot();
+
 
     // Program Steps ==========================================================
 
@@ -854,6 +1086,48 @@ namespace graphlab {
      */
     void execute_gathers(size_t thread_id);
 
+    /**
+     * \brief Splits the prepared frontier into chunks of about equal
+     * vertex plus edge cost and resets vertex_ranges to them. Must be
+     * called by a single thread before the phase iterating over
+     * vertex_ranges.
+     */
+    void plan_vertex_ranges(frontier_bitset<lvid_type>& frontier);
+
+    /**
+     * \brief Splits the hubs deferred by execute_gathers into edge
+     * range tasks. Called by a single thread.
+     */
+    void plan_hub_gathers();
+
+    /**
+     * \brief Gathers the edge ranges claimed from hub_tasks and then
+     * merges the partial sums of the claimed hubs, completing their
+     * gather like execute_gathers does for other vertices. Must be
+     * called by all threads between barriers.
+     */
+    void execute_hub_gathers(size_t thread_id);
+
+    /**
+     * \brief Fills lvid_block with the next (at most 64) active
+     * vertices of the frontier planned by plan_vertex_ranges, claiming
+     * or stealing a new chunk once [begin, end) is done.
+     *
+     * \return false once all chunks have been processed.
+     */
+    bool next_vertex_block(frontier_bitset<lvid_type>& frontier,
+                           size_t thread_id, size_t& begin, size_t& end,
+                           std::vector<lvid_type>& lvid_block) {
+      const size_t WORD_SIZE = 8 * sizeof(size_t);
+      if (begin >= end && !vertex_ranges.next(thread_id, begin, end)) {
+        return false;
+      }
+      const size_t block_end = std::min(begin + WORD_SIZE, end);
+      frontier.get_block(begin, block_end, lvid_block);
+      begin = block_end;
+      return true;
+    }
+
 
 
 
@@ -876,6 +1150,64 @@ namespace graphlab {
      */
     void execute_scatters(size_t thread_id);
 
+    /**
+     * \brief Decides the direction of the current scatter phase.
+     * Must be called by all machines.
+     *
+     * \return true if the scatter phase should be pulled.
+     */
+    bool choose_pull_direction();
+
+    /**
+     * \brief Count the local edges along which the vertices active in
+     * the current minor-step scatter into
+     * \ref graphlab::synchronous_engine::num_scatter_edges.
+     *
+     * @param thread_id the thread to run this as which determines
+     * which vertices to process.
+     */
+    void count_scatter_edges(size_t thread_id);
+
+    /**
+     * \brief Count the local edges along which the vertices would pull
+     * in the current minor-step into
+     * \ref graphlab::synchronous_engine::num_pull_edges.
+     *
+     * @param thread_id the thread to run this as which determines
+     * which vertices to process.
+     */
+    void count_pull_edges(size_t thread_id);
+
+    /**
+     * \brief Execute the scatter phase bottom-up: every vertex invokes
+     * the \ref graphlab::ivertex_program::scatter function of its
+     * neighbors which are active on this minor-step along its
+     * \ref graphlab::ivertex_program::pull_edges.
+     *
+     * @param thread_id the thread to run this as which determines
+     * which vertices to process.
+     */
+    void execute_pulls(size_t thread_id);
+
+    /**
+     * \brief Returns true if the vertex has been signaled in the
+     * current pulled scatter phase and
+     * \ref graphlab::ivertex_program::pull_complete reports that it
+     * does not need to pull along its remaining edges.
+     */
+    bool pull_is_complete(context_type& context,
+                          const vertex_program_type& pull_program,
+                          const vertex_type& vertex);
+
+    /**
+     * \brief Clear the vertex programs of the vertices which scattered
+     * in a pulled scatter phase.
+     *
+     * @param thread_id the thread to run this as which determines
+     * which vertices to process.
+     */
+    void finish_pulls(size_t thread_id);
+
     // Data Synchronization ===================================================
     /**
      * \brief Send the vertex program for the local vertex id to all
@@ -1006,8 +1338,10 @@ namespace graphlab {
     ncpus(opts.get_ncpus()),
     threads(2*1024*1024 /* 2MB stack per fiber*/),
     thread_barrier(opts.get_ncpus()),
-    max_iterations(-1), snapshot_interval(-1), iteration_counter(0),
-    timeout(0), sched_allv(false),
+    max_iterations(-1), snapshot_interval(-1), snapshot_incremental(false),
+    snapshot_base_saved(false), iteration_counter(0),
+    timeout(0), sched_allv(false), direction("push"), direction_alpha(2),
+    hub_gather_threshold(100000), has_hub_vertices(false),
     vprog_exchange(dc),
     vdata_exchange(dc),
     gather_exchange(dc),
@@ -1043,11 +1377,37 @@ namespace graphlab {
         if (rmi.procid() == 0)
           logstream(LOG_EMPH) << "Engine Option: snapshot_path = "
             << snapshot_path << std::endl;
+      } else if (opt == "snapshot_incremental") {
+        opts.get_engine_args().get_option("snapshot_incremental",
+                                          snapshot_incremental);
+        if (rmi.procid() == 0)
+          logstream(LOG_EMPH) << "Engine Option: snapshot_incremental = "
+            << snapshot_incremental << std::endl;
       } else if (opt == "sched_allv") {
         opts.get_engine_args().get_option("sched_allv", sched_allv);
         if (rmi.procid() == 0)
           logstream(LOG_EMPH) << "Engine Option: sched_allv = "
             << sched_allv << std::endl;
+      } else if (opt == "direction") {
+        opts.get_engine_args().get_option("direction", direction);
+        if (direction != "push" && direction != "pull" && direction != "auto") {
+          logstream(LOG_FATAL) << "Unknown direction: " << direction
+            << ". Expected push, pull or auto" << std::endl;
+        }
+        if (rmi.procid() == 0)
+          logstream(LOG_EMPH) << "Engine Option: direction = "
+            << direction << std::endl;
+      } else if (opt == "direction_alpha") {
+        opts.get_engine_args().get_option("direction_alpha", direction_alpha);
+        if (rmi.procid() == 0)
+          logstream(LOG_EMPH) << "Engine Option: direction_alpha = "
+            << direction_alpha << std::endl;
+      } else if (opt == "hub_gather_threshold") {
+        opts.get_engine_args().get_option("hub_gather_threshold",
+                                          hub_gather_threshold);
+        if (rmi.procid() == 0)
+          logstream(LOG_EMPH) << "Engine Option: hub_gather_threshold = "
+            << hub_gather_threshold << std::endl;
       } else {
         logstream(LOG_FATAL) << "Unexpected Engine Option: " << opt << std::endl;
       }
@@ -1057,6 +1417,13 @@ namespace graphlab {
       logstream(LOG_FATAL)
         << "Snapshot interval specified, but no snapshot path" << std::endl;
     }
+    if (direction != "push" && !vertex_program_type().supports_pull()) {
+      if (rmi.procid() == 0)
+        logstream(LOG_WARNING)
+          << "Vertex program does not support pull. Scatter is pushed."
+          << std::endl;
+      direction = "push";
+    }
     INITIALIZE_EVENT_LOG(dc);
     ADD_CUMULATIVE_EVENT(EVENT_APPLIES, "Applies", "Calls");
     ADD_CUMULATIVE_EVENT(EVENT_GATHERS , "Gathers", "Calls");
@@ -1079,12 +1446,17 @@ namespace graphlab {
     has_cache.clear();
     active_superstep.clear();
     active_minorstep.clear();
+    snapshot_dirty_vertices.clear();
+    snapshot_dirty_in_edges.clear();
+    snapshot_dirty_out_edges.clear();
   }
 
 
   template<typename VertexProgram>
   void synchronous_engine<VertexProgram>:: resize() {
     memory_info::log_usage("Before Engine Initialization");
+    const bool reallocate =
+        vertex_programs.size() != graph.num_local_vertices();
     // Allocate vertex locks and vertex programs
     vlocks.resize(graph.num_local_vertices());
     vertex_programs.resize(graph.num_local_vertices());
@@ -1106,11 +1478,80 @@ namespace graphlab {
     active_superstep.resize(graph.num_local_vertices());
     active_minorstep.resize(graph.num_local_vertices());
 
+    // If incremental snapshots are used then allocate the dirty bits
+    if (snapshot_incremental) {
+      snapshot_dirty_vertices.resize(graph.num_local_vertices());
+      snapshot_dirty_in_edges.resize(graph.num_local_vertices());
+      snapshot_dirty_out_edges.resize(graph.num_local_vertices());
+      snapshot_dirty_edges.resize(graph.num_local_edges());
+    }
+
+    // The arrays were first touched by this thread and hence live on
+    // its socket. Spread them and the graph over all sockets so that
+    // the workers, which take lvid ranges anywhere, share the memory
+    // bandwidth of the machine.
+    if (reallocate && numa::num_nodes() > 1) {
+      numa::interleave_vector(vlocks);
+      numa::interleave_vector(vertex_programs);
+      numa::interleave_vector(messages);
+      numa::interleave_vector(gather_accum);
+      numa::interleave_vector(gather_cache);
+      graph.get_local_graph().interleave_memory();
+    }
+
     // Print memory usage after initialization
     memory_info::log_usage("After Engine Initialization");
   }
 
 
+  template<typename VertexProgram>
+  void synchronous_engine<VertexProgram>:: build_mirror_slots() {
+    typedef std::pair<vertex_id_type, lvid_type> gvid_lvid_pair_type;
+    const size_t nprocs = rmi.numprocs();
+    std::vector<std::vector<gvid_lvid_pair_type> > masters(nprocs);
+    std::vector<std::vector<gvid_lvid_pair_type> > mirrors(nprocs);
+    lvid_slot_begin.assign(graph.num_local_vertices() + 1, 0);
+    for (lvid_type lvid = 0; lvid < graph.num_local_vertices(); ++lvid) {
+      const vertex_id_type gvid = graph.global_vid(lvid);
+      if (graph.l_is_master(lvid)) {
+        local_vertex_type vertex = graph.l_vertex(lvid);
+        foreach(const procid_t& mirror, vertex.mirrors()) {
+          masters[mirror].push_back(std::make_pair(gvid, lvid));
+          ++lvid_slot_begin[lvid + 1];
+        }
+      } else {
+        mirrors[graph.l_master(lvid)].push_back(std::make_pair(gvid, lvid));
+        ++lvid_slot_begin[lvid + 1];
+      }
+    }
+    for (size_t i = 1; i < lvid_slot_begin.size(); ++i) {
+      lvid_slot_begin[i] += lvid_slot_begin[i - 1];
+    }
+    lvid_slots.resize(lvid_slot_begin.back());
+    // Machines are visited in increasing order, which is also the
+    // iteration order of the mirror sets.
+    std::vector<size_t> cursor(lvid_slot_begin.begin(), lvid_slot_begin.end() - 1);
+    master_slot_lvids.resize(nprocs);
+    mirror_slot_lvids.resize(nprocs);
+    for (size_t p = 0; p < nprocs; ++p) {
+      std::sort(masters[p].begin(), masters[p].end());
+      std::sort(mirrors[p].begin(), mirrors[p].end());
+      master_slot_lvids[p].resize(masters[p].size());
+      for (size_t i = 0; i < masters[p].size(); ++i) {
+        const lvid_type lvid = masters[p][i].second;
+        master_slot_lvids[p][i] = lvid;
+        lvid_slots[cursor[lvid]++] = slot_type(i);
+      }
+      mirror_slot_lvids[p].resize(mirrors[p].size());
+      for (size_t i = 0; i < mirrors[p].size(); ++i) {
+        const lvid_type lvid = mirrors[p][i].second;
+        mirror_slot_lvids[p][i] = lvid;
+        lvid_slots[cursor[lvid]++] = slot_type(i);
+      }
+    }
+  } // end of build_mirror_slots
+
+
   template<typename VertexProgram>
   typename synchronous_engine<VertexProgram>::aggregator_type*
   synchronous_engine<VertexProgram>::get_aggregator() {
@@ -1243,6 +1684,37 @@ namespace graphlab {
   } // end of clear_gather_cache
 
 
+  template<typename VertexProgram>
+  void synchronous_engine<VertexProgram>::save_snapshot() {
+    if (!snapshot_incremental) {
+      graph.save_binary(snapshot_path);
+      return;
+    }
+    if (!snapshot_base_saved) {
+      graph.save_binary_base(snapshot_path);
+      snapshot_base_saved = true;
+    } else {
+      // expand the scattered vertices into the edges they touched
+      snapshot_dirty_edges.clear();
+      foreach(size_t lvid, snapshot_dirty_in_edges) {
+        foreach(local_edge_type local_edge, graph.l_vertex(lvid).in_edges()) {
+          snapshot_dirty_edges.set_bit_unsync(local_edge.id());
+        }
+      }
+      foreach(size_t lvid, snapshot_dirty_out_edges) {
+        foreach(local_edge_type local_edge, graph.l_vertex(lvid).out_edges()) {
+          snapshot_dirty_edges.set_bit_unsync(local_edge.id());
+        }
+      }
+      graph.save_binary_delta(snapshot_path, snapshot_dirty_vertices,
+                              snapshot_dirty_edges);
+    }
+    snapshot_dirty_vertices.clear();
+    snapshot_dirty_in_edges.clear();
+    snapshot_dirty_out_edges.clear();
+  } // end of save_snapshot
+
+
 
 
   template<typename VertexProgram>
@@ -1257,6 +1729,10 @@ namespace graphlab {
   int synchronous_engine<VertexProgram>::
   iteration() const { return iteration_counter; }
 
+  template<typename VertexProgram>
+  const std::vector<bool>& synchronous_engine<VertexProgram>::
+  pull_iterations() const { return pull_iteration_flags; }
+
 
 
   template<typename VertexProgram>
@@ -1271,6 +1747,9 @@ namespace graphlab {
   synchronous_engine<VertexProgram>::start() {
     if (vlocks.size() != graph.num_local_vertices())
       resize();
+    // rebuilt on every start since a dynamic graph may have gained
+    // mirrors without changing its number of local vertices
+    build_mirror_slots();
     completed_applys = 0;
     rmi.barrier();
 
@@ -1280,6 +1759,7 @@ namespace graphlab {
     graphlab::timer timer; timer.start();
     start_time = timer::approx_time_seconds();
     iteration_counter = 0;
+    pull_iteration_flags.clear();
     force_abort = false;
     execution_status::status_enum termination_reason =
       execution_status::UNSET;
@@ -1288,10 +1768,24 @@ namespace graphlab {
     //   run_synchronous( &synchronous_engine::initialize_vertex_programs );
     // }
     aggregator.start();
+    vertex_cost_prefix.resize(graph.num_local_vertices() + 1);
+    vertex_cost_prefix[0] = 0;
+    has_hub_vertices = false;
+    for (lvid_type lvid = 0; lvid < graph.num_local_vertices(); ++lvid) {
+      const local_vertex_type local_vertex = graph.l_vertex(lvid);
+      vertex_cost_prefix[lvid + 1] = vertex_cost_prefix[lvid] + 1 +
+          local_vertex.num_in_edges() + local_vertex.num_out_edges();
+      if (hub_gather_threshold > 0 &&
+          vertex_cost_prefix[lvid + 1] - vertex_cost_prefix[lvid] >
+          hub_gather_threshold) {
+        has_hub_vertices = true;
+      }
+    }
     rmi.barrier();
 
+    snapshot_base_saved = false;
     if (snapshot_interval == 0) {
-      graph.save_binary(snapshot_path);
+      save_snapshot();
     }
 
     float last_print = -5;
@@ -1326,6 +1820,7 @@ namespace graphlab {
       // Exchange Messages --------------------------------------------------
       // Exchange any messages in the local message vectors
       // if (rmi.procid() == 0) std::cout << "Exchange messages..." << std::endl;
+      has_message.prepare();
       run_synchronous( &synchronous_engine::exchange_messages );
       /**
        * Post conditions:
@@ -1339,6 +1834,7 @@ namespace graphlab {
 
       // if (rmi.procid() == 0) std::cout << "Receive messages..." << std::endl;
       num_active_vertices = 0;
+      has_message.prepare();
       run_synchronous( &synchronous_engine::receive_messages );
       if (sched_allv) {
         active_minorstep.fill();
@@ -1372,6 +1868,9 @@ namespace graphlab {
       // Execute the gather operation for all vertices that are active
       // in this minor-step (active-minorstep bit set).
       // if (rmi.procid() == 0) std::cout << "Gathering..." << std::endl;
+      active_minorstep.prepare();
+      plan_vertex_ranges(active_minorstep);
+      hub_gathers.clear();
       run_synchronous( &synchronous_engine::execute_gathers );
       // Clear the minor step bit since only super-step vertices
       // (only master vertices are required to participate in the
@@ -1388,6 +1887,7 @@ namespace graphlab {
       // Execute Apply Operations -------------------------------------------
       // Run the apply function on all active vertices
       // if (rmi.procid() == 0) std::cout << "Applying..." << std::endl;
+      active_superstep.prepare();
       run_synchronous( &synchronous_engine::execute_applys );
       /**
        * Post conditions:
@@ -1402,8 +1902,22 @@ namespace graphlab {
 
 
       // Execute Scatter Operations -----------------------------------------
-      // Execute each of the scatters on all minor-step active vertices.
-      run_synchronous( &synchronous_engine::execute_scatters );
+      // Execute each of the scatters on all minor-step active vertices,
+      // either from the scattering vertices (push) or from the vertices
+      // they scatter into (pull).
+      const bool pull = choose_pull_direction();
+      pull_iteration_flags.push_back(pull);
+      if(rmi.procid() == 0 && print_this_round && direction != "push")
+        logstream(LOG_EMPH) << "\tScatter direction: "
+                            << (pull ? "pull" : "push") << std::endl;
+      active_minorstep.prepare();
+      if (pull) {
+        run_synchronous( &synchronous_engine::execute_pulls );
+        run_synchronous( &synchronous_engine::finish_pulls );
+      } else {
+        plan_vertex_ranges(active_minorstep);
+        run_synchronous( &synchronous_engine::execute_scatters );
+      }
       /**
        * Post conditions:
        *   1) NONE
@@ -1416,13 +1930,20 @@ namespace graphlab {
       ++iteration_counter;
 
       if (snapshot_interval > 0 && iteration_counter % snapshot_interval == 0) {
-        graph.save_binary(snapshot_path);
+        save_snapshot();
       }
     }
 
     if (rmi.procid() == 0) {
       logstream(LOG_EMPH) << iteration_counter
                         << " iterations completed." << std::endl;
+      if (direction != "push") {
+        const size_t npull = std::count(pull_iteration_flags.begin(),
+                                        pull_iteration_flags.end(), true);
+        logstream(LOG_EMPH) << "Scatter directions: "
+                            << pull_iteration_flags.size() - npull << " push, "
+                            << npull << " pull" << std::endl;
+      }
     }
     // Final barrier to ensure that all engines terminate at the same time
     double total_compute_time = 0;
@@ -1437,6 +1958,15 @@ namespace graphlab {
     rmi.all_reduce(global_completed);
     completed_applys = global_completed;
     rmi.cout() << "Updates: " << completed_applys.value << "\n";
+    if (rmi.procid() == 0 && !per_thread_compute_time.empty()) {
+      logstream(LOG_INFO) << "Thread Compute Balance: min "
+        << *std::min_element(per_thread_compute_time.begin(),
+                             per_thread_compute_time.end())
+        << " max "
+        << *std::max_element(per_thread_compute_time.begin(),
+                             per_thread_compute_time.end())
+        << std::endl;
+    }
     if (rmi.procid() == 0) {
       logstream(LOG_INFO) << "Compute Balance: ";
       for (size_t i = 0;i < all_compute_time_vec.size(); ++i) {
@@ -1459,21 +1989,10 @@ namespace graphlab {
     context_type context(*this, graph);
     const size_t TRY_RECV_MOD = 100;
     size_t vcount = 0;
-    fixed_dense_bitset<8 * sizeof(size_t)> local_bitset; // a word-size = 64 bit
-    while (1) {
-      // increment by a word at a time
-      lvid_type lvid_block_start =
-                  shared_lvid_counter.inc_ret_last(8 * sizeof(size_t));
-      if (lvid_block_start >= graph.num_local_vertices()) break;
-      // get the bit field from has_message
-      size_t lvid_bit_block = has_message.containing_word(lvid_block_start);
-      if (lvid_bit_block == 0) continue;
-      // initialize a word sized bitfield
-      local_bitset.clear();
-      local_bitset.initialize_from_mem(&lvid_bit_block, sizeof(size_t));
-      foreach(size_t lvid_block_offset, local_bitset) {
-        lvid_type lvid = lvid_block_start + lvid_block_offset;
-        if (lvid >= graph.num_local_vertices()) break;
+    std::vector<lvid_type> lvid_block;
+    // claim a block of active vertices at a time
+    while (has_message.next_block(shared_lvid_counter, lvid_block)) {
+      foreach(lvid_type lvid, lvid_block) {
         // if the vertex is not local and has a message send the
         // message and clear the bit
         if(!graph.l_is_master(lvid)) {
@@ -1502,23 +2021,12 @@ namespace graphlab {
     const size_t TRY_RECV_MOD = 100;
     size_t vcount = 0;
     size_t nactive_inc = 0;
-    fixed_dense_bitset<8 * sizeof(size_t)> local_bitset; // a word-size = 64 bit
+    std::vector<lvid_type> lvid_block;
 
-    while (1) {
-      // increment by a word at a time
-      lvid_type lvid_block_start =
-                  shared_lvid_counter.inc_ret_last(8 * sizeof(size_t));
-      if (lvid_block_start >= graph.num_local_vertices()) break;
-      // get the bit field from has_message
-      size_t lvid_bit_block = has_message.containing_word(lvid_block_start);
-      if (lvid_bit_block == 0) continue;
-      // initialize a word sized bitfield
-      local_bitset.clear();
-      local_bitset.initialize_from_mem(&lvid_bit_block, sizeof(size_t));
+    // claim a block of active vertices at a time
+    while (has_message.next_block(shared_lvid_counter, lvid_block)) {
 
-      foreach(size_t lvid_block_offset, local_bitset) {
-        lvid_type lvid = lvid_block_start + lvid_block_offset;
-        if (lvid >= graph.num_local_vertices()) break;
+      foreach(lvid_type lvid, lvid_block) {
 
         // if this is the master of lvid and we have a message
         if(graph.l_is_master(lvid)) {
@@ -1559,6 +2067,144 @@ namespace graphlab {
   } // end of receive messages
 
 
+  template<typename VertexProgram>
+  void synchronous_engine<VertexProgram>::
+  plan_vertex_ranges(frontier_bitset<lvid_type>& frontier) {
+    // aim for several chunks per thread so that there is something to
+    // steal, but keep small frontiers in few chunks
+    const size_t CHUNKS_PER_THREAD = 16;
+    const size_t MIN_CHUNK_COST = 1024;
+    const size_t WORD_SIZE = 8 * sizeof(size_t);
+    const size_t nslots = frontier.num_slots();
+    const bool sparse = frontier.slots_are_sparse();
+    size_t total_cost = 0;
+    if (sparse) {
+      for (size_t i = 0; i < nslots; ++i) {
+        const lvid_type lvid = frontier.slot_index(i);
+        total_cost += vertex_cost_prefix[lvid + 1] - vertex_cost_prefix[lvid];
+      }
+    } else {
+      total_cost = vertex_cost_prefix[nslots];
+    }
+    const size_t target_cost =
+        std::max(total_cost / (ncpus * CHUNKS_PER_THREAD), MIN_CHUNK_COST);
+    // dense frontiers are split at word boundaries, sparse ones at
+    // any slot
+    const size_t unit = sparse ? 1 : WORD_SIZE;
+    std::vector<size_t> bounds(1, 0);
+    size_t cost = 0;
+    for (size_t begin = 0; begin < nslots; begin += unit) {
+      const size_t end = std::min(begin + unit, nslots);
+      if (sparse) {
+        const lvid_type lvid = frontier.slot_index(begin);
+        cost += vertex_cost_prefix[lvid + 1] - vertex_cost_prefix[lvid];
+      } else {
+        cost += vertex_cost_prefix[end] - vertex_cost_prefix[begin];
+      }
+      if (cost >= target_cost) {
+        bounds.push_back(end);
+        cost = 0;
+      }
+    }
+    if (bounds.back() != nslots) bounds.push_back(nslots);
+    vertex_ranges.reset(ncpus, bounds);
+  } // end of plan_vertex_ranges
+
+
+  template<typename VertexProgram>
+  void synchronous_engine<VertexProgram>::plan_hub_gathers() {
+    // ranges large enough to amortize seeking into the edge lists
+    const size_t MIN_TASK_EDGES = 4096;
+    const size_t TASKS_PER_THREAD = 4;
+    hub_tasks.clear();
+    for (size_t i = 0; i < hub_gathers.size(); ++i) {
+      hub_gather_record& hub = hub_gathers[i];
+      hub.first_task = hub_tasks.size();
+      const size_t ntasks =
+          std::max<size_t>(1, std::min(ncpus * TASKS_PER_THREAD,
+                                       hub.num_edges / MIN_TASK_EDGES));
+      for (size_t j = 0; j < ntasks; ++j) {
+        hub_gather_task task;
+        task.hub = i;
+        task.begin = j * hub.num_edges / ntasks;
+        task.end = (j + 1) * hub.num_edges / ntasks;
+        hub_tasks.push_back(task);
+      }
+    }
+    hub_partials.assign(hub_tasks.size(), gather_type());
+    hub_partial_set.assign(hub_tasks.size(), false);
+    hub_task_counter = 0;
+  } // end of plan_hub_gathers
+
+
+  template<typename VertexProgram>
+  void synchronous_engine<VertexProgram>::
+  execute_hub_gathers(const size_t thread_id) {
+    typedef typename local_edge_list_type::iterator edge_iterator;
+    context_type context(*this, graph);
+    size_t edges_touched = 0;
+    for (size_t t = hub_task_counter.inc_ret_last(); t < hub_tasks.size();
+         t = hub_task_counter.inc_ret_last()) {
+      const hub_gather_task& task = hub_tasks[t];
+      const hub_gather_record& hub = hub_gathers[task.hub];
+      const vertex_program_type& vprog = vertex_programs[hub.lvid];
+      local_vertex_type local_vertex = graph.l_vertex(hub.lvid);
+      const vertex_type vertex(local_vertex);
+      gather_type& accum = hub_partials[t];
+      bool accum_is_set = false;
+      if (task.begin < hub.num_in) {
+        const local_edge_list_type edges = local_vertex.in_edges();
+        edge_iterator end = edges.begin() + std::min(task.end, hub.num_in);
+        for (edge_iterator it = edges.begin() + task.begin; it != end; ++it) {
+          edge_type edge(*it);
+          if(accum_is_set) accum += vprog.gather(context, vertex, edge);
+          else { accum = vprog.gather(context, vertex, edge); accum_is_set = true; }
+        }
+      }
+      if (task.end > hub.num_in) {
+        const local_edge_list_type edges = local_vertex.out_edges();
+        const size_t begin = std::max(task.begin, hub.num_in) - hub.num_in;
+        edge_iterator end = edges.begin() + (task.end - hub.num_in);
+        for (edge_iterator it = edges.begin() + begin; it != end; ++it) {
+          edge_type edge(*it);
+          if(accum_is_set) accum += vprog.gather(context, vertex, edge);
+          else { accum = vprog.gather(context, vertex, edge); accum_is_set = true; }
+        }
+      }
+      hub_partial_set[t] = accum_is_set;
+      edges_touched += task.end - task.begin;
+    }
+    INCREMENT_EVENT(EVENT_GATHERS, edges_touched);
+    thread_barrier.wait();
+
+    // merge the partial sums in edge order, one hub per thread at a time
+    const bool caching_enabled = !gather_cache.empty();
+    for (size_t i = thread_id; i < hub_gathers.size(); i += ncpus) {
+      const hub_gather_record& hub = hub_gathers[i];
+      const lvid_type lvid = hub.lvid;
+      const vertex_program_type& vprog = vertex_programs[lvid];
+      const size_t last_task = (i + 1 < hub_gathers.size()) ?
+          hub_gathers[i + 1].first_task : hub_tasks.size();
+      bool accum_is_set = false;
+      gather_type accum = gather_type();
+      vprog.pre_local_gather(accum);
+      for (size_t t = hub.first_task; t < last_task; ++t) {
+        if (!hub_partial_set[t]) continue;
+        if (accum_is_set) accum += hub_partials[t];
+        else { accum = hub_partials[t]; accum_is_set = true; }
+      }
+      vprog.post_local_gather(accum);
+      if(caching_enabled && accum_is_set) {
+        gather_cache[lvid] = accum; has_cache.set_bit(lvid);
+      }
+      if(accum_is_set) sync_gather(lvid, accum, thread_id);
+      if(!graph.l_is_master(lvid)) {
+        vertex_programs[lvid] = vertex_program_type();
+      }
+    }
+  } // end of execute_hub_gathers
+
+
   template<typename VertexProgram>
   void synchronous_engine<VertexProgram>::
   execute_gathers(const size_t thread_id) {
@@ -1568,23 +2214,13 @@ namespace graphlab {
     const bool caching_enabled = !gather_cache.empty();
     timer ti;
 
-    fixed_dense_bitset<8 * sizeof(size_t)> local_bitset; // a word-size = 64 bit
-
-    while (1) {
-      // increment by a word at a time
-      lvid_type lvid_block_start =
-                  shared_lvid_counter.inc_ret_last(8 * sizeof(size_t));
-      if (lvid_block_start >= graph.num_local_vertices()) break;
-      // get the bit field from has_message
-      size_t lvid_bit_block = active_minorstep.containing_word(lvid_block_start);
-      if (lvid_bit_block == 0) continue;
-      // initialize a word sized bitfield
-      local_bitset.clear();
-      local_bitset.initialize_from_mem(&lvid_bit_block, sizeof(size_t));
+    std::vector<lvid_type> lvid_block;
+    size_t begin = 0, end = 0;
 
-      foreach(size_t lvid_block_offset, local_bitset) {
-        lvid_type lvid = lvid_block_start + lvid_block_offset;
-        if (lvid >= graph.num_local_vertices()) break;
+    // claim a block of active vertices at a time
+    while (next_vertex_block(active_minorstep, thread_id, begin, end,
+                             lvid_block)) {
+      foreach(lvid_type lvid, lvid_block) {
 
         bool accum_is_set = false;
         gather_type accum = gather_type();
@@ -1599,6 +2235,25 @@ namespace graphlab {
           local_vertex_type local_vertex = graph.l_vertex(lvid);
           const vertex_type vertex(local_vertex);
           const edge_dir_type gather_dir = vprog.gather_edges(context, vertex);
+          if (has_hub_vertices &&
+              vertex_cost_prefix[lvid + 1] - vertex_cost_prefix[lvid] >
+              hub_gather_threshold) {
+            hub_gather_record hub;
+            hub.lvid = lvid;
+            hub.gather_dir = gather_dir;
+            hub.num_in = (gather_dir == IN_EDGES || gather_dir == ALL_EDGES) ?
+                local_vertex.num_in_edges() : 0;
+            hub.num_edges = hub.num_in +
+                ((gather_dir == OUT_EDGES || gather_dir == ALL_EDGES) ?
+                 local_vertex.num_out_edges() : 0);
+            if (hub.num_edges >= hub_gather_threshold) {
+              // completed by execute_hub_gathers
+              hub_gathers_lock.lock();
+              hub_gathers.push_back(hub);
+              hub_gathers_lock.unlock();
+              continue;
+            }
+          }
           // Loop over in edges
           size_t edges_touched = 0;
           vprog.pre_local_gather(accum);
@@ -1653,6 +2308,15 @@ namespace graphlab {
         if(++vcount % TRY_RECV_MOD == 0) recv_gathers();
       }
     } // end of loop over vertices to compute gather accumulators
+    // all threads split the gathers of the hubs
+    if (has_hub_vertices) {
+      thread_barrier.wait();
+      if (!hub_gathers.empty()) {
+        if (thread_id == 0) plan_hub_gathers();
+        thread_barrier.wait();
+        execute_hub_gathers(thread_id);
+      }
+    }
     per_thread_compute_time[thread_id] += ti.current_time();
     gather_exchange.partial_flush();
       // Finish sending and receiving all gather operations
@@ -1671,21 +2335,10 @@ namespace graphlab {
     size_t vcount = 0;
     timer ti;
 
-    fixed_dense_bitset<8 * sizeof(size_t)> local_bitset;  // allocate a word size = 64bits
-    while (1) {
-      // increment by a word at a time
-      lvid_type lvid_block_start =
-                  shared_lvid_counter.inc_ret_last(8 * sizeof(size_t));
-      if (lvid_block_start >= graph.num_local_vertices()) break;
-      // get the bit field from has_message
-      size_t lvid_bit_block = active_superstep.containing_word(lvid_block_start);
-      if (lvid_bit_block == 0) continue;
-      // initialize a word sized bitfield
-      local_bitset.clear();
-      local_bitset.initialize_from_mem(&lvid_bit_block, sizeof(size_t));
-      foreach(size_t lvid_block_offset, local_bitset) {
-        lvid_type lvid = lvid_block_start + lvid_block_offset;
-        if (lvid >= graph.num_local_vertices()) break;
+    std::vector<lvid_type> lvid_block;
+    // claim a block of active vertices at a time
+    while (active_superstep.next_block(shared_lvid_counter, lvid_block)) {
+      foreach(lvid_type lvid, lvid_block) {
 
         // Only master vertices can be active in a super-step
         ASSERT_TRUE(graph.l_is_master(lvid));
@@ -1699,6 +2352,7 @@ namespace graphlab {
         ++completed_applys;
         // Clear the accumulator to save some memory
         gather_accum[lvid] = gather_type();
+        if (snapshot_incremental) snapshot_dirty_vertices.set_bit(lvid);
         // synchronize the changed vertex data with all mirrors
         sync_vertex_data(lvid, thread_id);
         // determine if a scatter operation is needed
@@ -1740,26 +2394,23 @@ namespace graphlab {
   execute_scatters(const size_t thread_id) {
     context_type context(*this, graph);
     timer ti;
-    fixed_dense_bitset<8 * sizeof(size_t)> local_bitset; // allocate a word size = 64 bits
-    while (1) {
-      // increment by a word at a time
-      lvid_type lvid_block_start =
-                  shared_lvid_counter.inc_ret_last(8 * sizeof(size_t));
-      if (lvid_block_start >= graph.num_local_vertices()) break;
-      // get the bit field from has_message
-      size_t lvid_bit_block = active_minorstep.containing_word(lvid_block_start);
-      if (lvid_bit_block == 0) continue;
-      // initialize a word sized bitfield
-      local_bitset.clear();
-      local_bitset.initialize_from_mem(&lvid_bit_block, sizeof(size_t));
-      foreach(size_t lvid_block_offset, local_bitset) {
-        lvid_type lvid = lvid_block_start + lvid_block_offset;
-        if (lvid >= graph.num_local_vertices()) break;
+    std::vector<lvid_type> lvid_block;
+    size_t begin = 0, end = 0;
+    // claim a block of active vertices at a time
+    while (next_vertex_block(active_minorstep, thread_id, begin, end,
+                             lvid_block)) {
+      foreach(lvid_type lvid, lvid_block) {
 
         const vertex_program_type& vprog = vertex_programs[lvid];
         local_vertex_type local_vertex = graph.l_vertex(lvid);
         const vertex_type vertex(local_vertex);
         const edge_dir_type scatter_dir = vprog.scatter_edges(context, vertex);
+        if (snapshot_incremental) {
+          if (scatter_dir == IN_EDGES || scatter_dir == ALL_EDGES)
+            snapshot_dirty_in_edges.set_bit(lvid);
+          if (scatter_dir == OUT_EDGES || scatter_dir == ALL_EDGES)
+            snapshot_dirty_out_edges.set_bit(lvid);
+        }
 				size_t edges_touched = 0;
         // Loop over in edges
         if(scatter_dir == IN_EDGES || scatter_dir == ALL_EDGES) {
@@ -1791,17 +2442,203 @@ namespace graphlab {
   } // end of execute_scatters
 
 
+  template<typename VertexProgram>
+  bool synchronous_engine<VertexProgram>::choose_pull_direction() {
+    if (direction == "push") return false;
+    bool pull = true;
+    size_t total_scatter_edges = 0, total_pull_edges = 0;
+    if (direction == "auto") {
+      // Pulling touches the edges of the vertices which still pull,
+      // pushing the edges of the scattering vertices.
+      active_minorstep.prepare();
+      num_scatter_edges = 0;
+      run_synchronous( &synchronous_engine::count_scatter_edges );
+      num_pull_edges = 0;
+      run_synchronous( &synchronous_engine::count_pull_edges );
+      total_scatter_edges = num_scatter_edges.value;
+      total_pull_edges = num_pull_edges.value;
+      rmi.all_reduce(total_scatter_edges);
+      rmi.all_reduce(total_pull_edges);
+      pull = direction_alpha * total_scatter_edges > total_pull_edges;
+    }
+    if (rmi.procid() == 0) {
+      logstream(LOG_INFO) << "Iteration " << iteration_counter
+                          << " scatter direction: "
+                          << (pull ? "pull" : "push");
+      if (direction == "auto") {
+        logstream(LOG_INFO) << " (" << total_scatter_edges
+                            << " scatter edges, " << total_pull_edges
+                            << " pull edges)";
+      }
+      logstream(LOG_INFO) << std::endl;
+    }
+    return pull;
+  } // end of choose_pull_direction
+
+
+  template<typename VertexProgram>
+  void synchronous_engine<VertexProgram>::
+  count_scatter_edges(const size_t thread_id) {
+    context_type context(*this, graph);
+    size_t nedges = 0;
+    std::vector<lvid_type> lvid_block;
+    while (active_minorstep.next_block(shared_lvid_counter, lvid_block)) {
+      foreach(lvid_type lvid, lvid_block) {
+        local_vertex_type local_vertex = graph.l_vertex(lvid);
+        const edge_dir_type scatter_dir =
+          vertex_programs[lvid].scatter_edges(context, vertex_type(local_vertex));
+        if(scatter_dir == IN_EDGES || scatter_dir == ALL_EDGES)
+          nedges += local_vertex.num_in_edges();
+        if(scatter_dir == OUT_EDGES || scatter_dir == ALL_EDGES)
+          nedges += local_vertex.num_out_edges();
+      }
+    }
+    num_scatter_edges.inc(nedges);
+  } // end of count_scatter_edges
+
+
+  template<typename VertexProgram>
+  void synchronous_engine<VertexProgram>::
+  count_pull_edges(const size_t thread_id) {
+    context_type context(*this, graph);
+    const vertex_program_type pull_program = vertex_program_type();
+    size_t nedges = 0;
+    while (1) {
+      const lvid_type lvid_block_start =
+                  shared_lvid_counter.inc_ret_last(8 * sizeof(size_t));
+      if (lvid_block_start >= graph.num_local_vertices()) break;
+      const lvid_type lvid_block_end =
+        std::min<size_t>(lvid_block_start + 8 * sizeof(size_t),
+                         graph.num_local_vertices());
+      for (lvid_type lvid = lvid_block_start; lvid < lvid_block_end; ++lvid) {
+        local_vertex_type local_vertex = graph.l_vertex(lvid);
+        const edge_dir_type pull_dir =
+          pull_program.pull_edges(context, vertex_type(local_vertex));
+        if(pull_dir == IN_EDGES || pull_dir == ALL_EDGES)
+          nedges += local_vertex.num_in_edges();
+        if(pull_dir == OUT_EDGES || pull_dir == ALL_EDGES)
+          nedges += local_vertex.num_out_edges();
+      }
+    }
+    num_pull_edges.inc(nedges);
+  } // end of count_pull_edges
+
+
+  template<typename VertexProgram>
+  void synchronous_engine<VertexProgram>::
+  execute_pulls(const size_t thread_id) {
+    context_type context(*this, graph);
+    // pull_edges is invoked on a default constructed vertex program
+    const vertex_program_type pull_program = vertex_program_type();
+    timer ti;
+    size_t edges_touched = 0;
+    while (1) {
+      // every vertex may receive a scatter so claim plain ranges
+      const lvid_type lvid_block_start =
+                  shared_lvid_counter.inc_ret_last(8 * sizeof(size_t));
+      if (lvid_block_start >= graph.num_local_vertices()) break;
+      const lvid_type lvid_block_end =
+        std::min<size_t>(lvid_block_start + 8 * sizeof(size_t),
+                         graph.num_local_vertices());
+      for (lvid_type lvid = lvid_block_start; lvid < lvid_block_end; ++lvid) {
+        local_vertex_type local_vertex = graph.l_vertex(lvid);
+        const vertex_type vertex(local_vertex);
+        const edge_dir_type pull_dir = pull_program.pull_edges(context, vertex);
+        if (pull_dir == NO_EDGES) continue;
+        bool complete = false;
+        // Pull from the sources of in edges which scatter on out edges
+        if(pull_dir == IN_EDGES || pull_dir == ALL_EDGES) {
+          foreach(local_edge_type local_edge, local_vertex.in_edges()) {
+            local_vertex_type other = local_edge.source();
+            if (!active_minorstep.get(other.id())) continue;
+            const vertex_program_type& vprog = vertex_programs[other.id()];
+            const vertex_type other_vertex(other);
+            const edge_dir_type scatter_dir =
+              vprog.scatter_edges(context, other_vertex);
+            if(scatter_dir == OUT_EDGES || scatter_dir == ALL_EDGES) {
+              edge_type edge(local_edge);
+              vprog.scatter(context, other_vertex, edge);
+              ++edges_touched;
+              if (pull_is_complete(context, pull_program, vertex)) {
+                complete = true;
+                break;
+              }
+            }
+          }
+        } // end of if in_edges/all_edges
+        // Pull from the targets of out edges which scatter on in edges
+        if(!complete && (pull_dir == OUT_EDGES || pull_dir == ALL_EDGES)) {
+          foreach(local_edge_type local_edge, local_vertex.out_edges()) {
+            local_vertex_type other = local_edge.target();
+            if (!active_minorstep.get(other.id())) continue;
+            const vertex_program_type& vprog = vertex_programs[other.id()];
+            const vertex_type other_vertex(other);
+            const edge_dir_type scatter_dir =
+              vprog.scatter_edges(context, other_vertex);
+            if(scatter_dir == IN_EDGES || scatter_dir == ALL_EDGES) {
+              edge_type edge(local_edge);
+              vprog.scatter(context, other_vertex, edge);
+              ++edges_touched;
+              if (pull_is_complete(context, pull_program, vertex)) break;
+            }
+          }
+        } // end of if out_edges/all_edges
+      }
+    } // end of loop over vertices to pull scatters into
+    INCREMENT_EVENT(EVENT_SCATTERS, edges_touched);
+    per_thread_compute_time[thread_id] += ti.current_time();
+  } // end of execute_pulls
+
+
+  template<typename VertexProgram>
+  bool synchronous_engine<VertexProgram>::
+  pull_is_complete(context_type& context,
+                   const vertex_program_type& pull_program,
+                   const vertex_type& vertex) {
+    const lvid_type lvid = vertex.local_id();
+    if (!has_message.get(lvid)) return false;
+    vlocks[lvid].lock();
+    const bool complete =
+      pull_program.pull_complete(context, vertex, messages[lvid]);
+    vlocks[lvid].unlock();
+    return complete;
+  } // end of pull_is_complete
+
+
+  template<typename VertexProgram>
+  void synchronous_engine<VertexProgram>::
+  finish_pulls(const size_t thread_id) {
+    context_type context(*this, graph);
+    std::vector<lvid_type> lvid_block;
+    while (active_minorstep.next_block(shared_lvid_counter, lvid_block)) {
+      foreach(lvid_type lvid, lvid_block) {
+        if (snapshot_incremental) {
+          const edge_dir_type scatter_dir = vertex_programs[lvid].
+            scatter_edges(context, vertex_type(graph.l_vertex(lvid)));
+          if (scatter_dir == IN_EDGES || scatter_dir == ALL_EDGES)
+            snapshot_dirty_in_edges.set_bit(lvid);
+          if (scatter_dir == OUT_EDGES || scatter_dir == ALL_EDGES)
+            snapshot_dirty_out_edges.set_bit(lvid);
+        }
+        // Clear the vertex program
+        vertex_programs[lvid] = vertex_program_type();
+      }
+    }
+  } // end of finish_pulls
+
+
 
   // Data Synchronization ===================================================
   template<typename VertexProgram>
   void synchronous_engine<VertexProgram>::
   sync_vertex_program(lvid_type lvid, const size_t thread_id) {
     ASSERT_TRUE(graph.l_is_master(lvid));
-    const vertex_id_type vid = graph.global_vid(lvid);
     local_vertex_type vertex = graph.l_vertex(lvid);
+    typename std::vector<slot_type>::const_iterator slot =
+      lvid_slots.begin() + lvid_slot_begin[lvid];
     foreach(const procid_t& mirror, vertex.mirrors()) {
       vprog_exchange.send(mirror,
-                          std::make_pair(vid, vertex_programs[lvid]));
+                          std::make_pair(*slot++, vertex_programs[lvid]));
     }
   } // end of sync_vertex_program
 
@@ -1814,8 +2651,10 @@ namespace graphlab {
     while(vprog_exchange.recv(recv_buffer)) {
       for (size_t i = 0;i < recv_buffer.size(); ++i) {
         typename vprog_exchange_type::buffer_type& buffer = recv_buffer[i].buffer;
+        const std::vector<lvid_type>& slot_lvids =
+          mirror_slot_lvids[recv_buffer[i].proc];
         foreach(const vid_prog_pair_type& pair, buffer) {
-          const lvid_type lvid = graph.local_vid(pair.first);
+          const lvid_type lvid = slot_lvids[pair.first];
           //      ASSERT_FALSE(graph.l_is_master(lvid));
           vertex_programs[lvid] = pair.second;
           active_minorstep.set_bit(lvid);
@@ -1829,10 +2668,11 @@ namespace graphlab {
   void synchronous_engine<VertexProgram>::
   sync_vertex_data(lvid_type lvid, const size_t thread_id) {
     ASSERT_TRUE(graph.l_is_master(lvid));
-    const vertex_id_type vid = graph.global_vid(lvid);
     local_vertex_type vertex = graph.l_vertex(lvid);
+    typename std::vector<slot_type>::const_iterator slot =
+      lvid_slots.begin() + lvid_slot_begin[lvid];
     foreach(const procid_t& mirror, vertex.mirrors()) {
-      vdata_exchange.send(mirror, std::make_pair(vid, vertex.data()));
+      vdata_exchange.send(mirror, std::make_pair(*slot++, vertex.data()));
     }
   } // end of sync_vertex_data
 
@@ -1847,10 +2687,13 @@ namespace graphlab {
     while(vdata_exchange.recv(recv_buffer)) {
       for (size_t i = 0;i < recv_buffer.size(); ++i) {
         typename vdata_exchange_type::buffer_type& buffer = recv_buffer[i].buffer;
+        const std::vector<lvid_type>& slot_lvids =
+          mirror_slot_lvids[recv_buffer[i].proc];
         foreach(const vid_vdata_pair_type& pair, buffer) {
-          const lvid_type lvid = graph.local_vid(pair.first);
+          const lvid_type lvid = slot_lvids[pair.first];
           ASSERT_FALSE(graph.l_is_master(lvid));
           graph.l_vertex(lvid).data() = pair.second;
+          if (snapshot_incremental) snapshot_dirty_vertices.set_bit(lvid);
         }
       }
     }
@@ -1871,8 +2714,8 @@ namespace graphlab {
       vlocks[lvid].unlock();
     } else {
       const procid_t master = graph.l_master(lvid);
-      const vertex_id_type vid = graph.global_vid(lvid);
-      gather_exchange.send(master, std::make_pair(vid, accum));
+      const slot_type slot = lvid_slots[lvid_slot_begin[lvid]];
+      gather_exchange.send(master, std::make_pair(slot, accum));
     }
   } // end of sync_gather
 
@@ -1883,8 +2726,10 @@ namespace graphlab {
     while(gather_exchange.recv(recv_buffer)) {
       for (size_t i = 0;i < recv_buffer.size(); ++i) {
         typename gather_exchange_type::buffer_type& buffer = recv_buffer[i].buffer;
+        const std::vector<lvid_type>& slot_lvids =
+          master_slot_lvids[recv_buffer[i].proc];
         foreach(const vid_gather_pair_type& pair, buffer) {
-          const lvid_type lvid = graph.local_vid(pair.first);
+          const lvid_type lvid = slot_lvids[pair.first];
           const gather_type& accum = pair.second;
           ASSERT_TRUE(graph.l_is_master(lvid));
           vlocks[lvid].lock();
@@ -1906,8 +2751,8 @@ namespace graphlab {
   sync_message(lvid_type lvid, const size_t thread_id) {
     ASSERT_FALSE(graph.l_is_master(lvid));
     const procid_t master = graph.l_master(lvid);
-    const vertex_id_type vid = graph.global_vid(lvid);
-    message_exchange.send(master, std::make_pair(vid, messages[lvid]));
+    const slot_type slot = lvid_slots[lvid_slot_begin[lvid]];
+    message_exchange.send(master, std::make_pair(slot, messages[lvid]));
   } // end of send_message
 
 
@@ -1920,8 +2765,10 @@ namespace graphlab {
     while(message_exchange.recv(recv_buffer)) {
       for (size_t i = 0;i < recv_buffer.size(); ++i) {
         typename message_exchange_type::buffer_type& buffer = recv_buffer[i].buffer;
+        const std::vector<lvid_type>& slot_lvids =
+          master_slot_lvids[recv_buffer[i].proc];
         foreach(const vid_message_pair_type& pair, buffer) {
-          const lvid_type lvid = graph.local_vid(pair.first);
+          const lvid_type lvid = slot_lvids[pair.first];
           ASSERT_TRUE(graph.l_is_master(lvid));
           vlocks[lvid].lock();
           if( has_message.get(lvid) ) {
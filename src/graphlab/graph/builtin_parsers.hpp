@@ -26,17 +26,8 @@
 #include <sstream>
 #include <iostream>
 
-#if defined(__cplusplus) && __cplusplus >= 201103L
-// do not include spirit
-#else
-#include <boost/config/warning_disable.hpp>
-#include <boost/spirit/include/qi.hpp>
-#include <boost/spirit/include/phoenix_core.hpp>
-#include <boost/spirit/include/phoenix_operator.hpp>
-#include <boost/spirit/include/phoenix_stl.hpp>
-#endif
-
 #include <graphlab/util/stl_util.hpp>
+#include <graphlab/util/integer_tokenizer.hpp>
 #include <graphlab/logger/logger.hpp>
 #include <graphlab/serialization/serialization_includes.hpp>
 
@@ -47,6 +38,29 @@ namespace graphlab {
 
   namespace builtin_parsers {
   
+    /**
+     * \brief Parse files in the standard tsv format
+     *
+     * This is identical to the SNAP format but does not allow comments.
+     * Anything following the target id on a line is ignored.
+     *
+     */
+    template <typename Graph>
+    bool tsv_parser(Graph& graph, const std::string& srcfilename,
+                    const std::string& str) {
+      namespace tok = integer_tokenizer;
+      const char* ptr = str.c_str();
+      const char* end = ptr + str.size();
+      // blank line
+      if (!tok::skip_separators(ptr, end)) return true;
+      size_t source, target;
+      if (!tok::next_uint(ptr, end, source) ||
+          !tok::next_uint(ptr, end, target)) return false;
+      if(source != target) graph.add_edge(source, target);
+      return true;
+    } // end of tsv parser
+
+
     /**
      * \brief Parse files in the Stanford Network Analysis Package format.
      *
@@ -65,36 +79,11 @@ namespace graphlab {
       if (str.empty()) return true;
       else if (str[0] == '#') {
         std::cout << str << std::endl;
-      } else {
-        size_t source, target;
-        char* targetptr;
-        source = strtoul(str.c_str(), &targetptr, 10);
-        if (targetptr == NULL) return false;
-        target = strtoul(targetptr, NULL, 10);
-        if(source != target) graph.add_edge(source, target);
+        return true;
       }
-      return true;
+      return tsv_parser(graph, srcfilename, str);
     } // end of snap parser
 
-    /**
-     * \brief Parse files in the standard tsv format
-     *
-     * This is identical to the SNAP format but does not allow comments.
-     *
-     */
-    template <typename Graph>
-    bool tsv_parser(Graph& graph, const std::string& srcfilename,
-                    const std::string& str) {
-      if (str.empty()) return true;
-      size_t source, target;
-      char* targetptr;
-      source = strtoul(str.c_str(), &targetptr, 10);
-      if (targetptr == NULL) return false;
-      target = strtoul(targetptr, NULL, 10);
-      if(source != target) graph.add_edge(source, target);
-      return true;
-    } // end of tsv parser
-
 
     template <typename Graph>
     bool csv_parser(Graph& graph, 
@@ -113,71 +102,48 @@ namespace graphlab {
     }
 
 
-#if defined(__cplusplus) && __cplusplus >= 201103L
-    // The spirit parser seems to have issues when compiling under
-    // C++11. Temporary workaround with a hard coded parser. TOFIX
-    template <typename Graph>
-    bool adj_parser(Graph& graph, const std::string& srcfilename,
-                    const std::string& line) {
-      // If the line is empty simply skip it
-      if(line.empty()) return true;
-      std::stringstream strm(line);
-      vertex_id_type source; 
-      size_t n;
-      strm >> source;
-      if (strm.fail()) return false;
-      strm >> n;
-      if (strm.fail()) return true;
-
-      size_t nadded = 0;
-      while (strm.good()) {
-        vertex_id_type target;
-        strm >> target;
-        if (strm.fail()) break;
-        if (source != target) graph.add_edge(source, target);
-        ++nadded;
-      } 
-      if (n != nadded) return false;
-      return true;
-    } // end of adj parser
-
-#else
-
+    /**
+     * \brief Parse files in the adjacency list format
+     *
+     * Each line holds a source id, the number of targets and the list
+     * of targets, separated by whitespace and optionally commas:
+     *
+     *  1 2 4 5
+     *  7, 1, 8
+     *
+     */
     template <typename Graph>
     bool adj_parser(Graph& graph, const std::string& srcfilename,
                     const std::string& line) {
+      namespace tok = integer_tokenizer;
+      const char* begin = line.c_str();
+      const char* end = begin + line.size();
       // If the line is empty simply skip it
-      if(line.empty()) return true;
-      // We use the boost spirit parser which requires (too) many separate
-      // namespaces so to make things clear we shorten them here.
-      namespace qi = boost::spirit::qi;
-      namespace ascii = boost::spirit::ascii;
-      namespace phoenix = boost::phoenix;
+      if (!tok::skip_separators(begin, end)) return true;
       vertex_id_type source(-1);
-      vertex_id_type ntargets(-1);
-      std::vector<vertex_id_type> targets;
-      const bool success = qi::phrase_parse
-        (line.begin(), line.end(),       
-         //  Begin grammar
-         (
-          qi::ulong_[phoenix::ref(source) = qi::_1] >> -qi::char_(",") >>
-          qi::ulong_[phoenix::ref(ntargets) = qi::_1] >> -qi::char_(",") >>
-          *(qi::ulong_[phoenix::push_back(phoenix::ref(targets), qi::_1)] % -qi::char_(","))
-          )
-         ,
-         //  End grammar
-         ascii::space); 
-      // Test to see if the boost parser was able to parse the line
-      if(!success || ntargets != targets.size()) {
+      size_t ntargets(-1);
+      if (!tok::next_uint(begin, end, source, true) ||
+          !tok::next_uint(begin, end, ntargets, true)) {
+        logstream(LOG_ERROR) << "Parse error in vertex prior parser." << std::endl;
+        return false;
+      }
+      // Validate the whole line before adding any edge. The targets are
+      // parsed twice rather than buffered to keep the parser allocation
+      // free.
+      const char* ptr = begin;
+      size_t nfound = 0;
+      vertex_id_type target;
+      while (tok::next_uint(ptr, end, target, true)) ++nfound;
+      if (tok::skip_separators(ptr, end, true) || nfound != ntargets) {
         logstream(LOG_ERROR) << "Parse error in vertex prior parser." << std::endl;
         return false;
       }
-      for(size_t i = 0; i < targets.size(); ++i) {
-        if(source != targets[i]) graph.add_edge(source, targets[i]);
+      ptr = begin;
+      while (tok::next_uint(ptr, end, target, true)) {
+        if(source != target) graph.add_edge(source, target);
       }
       return true;
     } // end of adj parser
-#endif
 
     template <typename Graph>
     struct tsv_writer{
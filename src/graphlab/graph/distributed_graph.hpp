@@ -29,6 +29,8 @@
 
 #include <cmath>
 
+#include <cstdio>
+#include <cstring>
 #include <string>
 #include <list>
 #include <vector>
@@ -88,6 +90,7 @@
 #include <graphlab/util/hopscotch_map.hpp>
 
 #include <graphlab/util/fs_util.hpp>
+#include <graphlab/util/mapped_image.hpp>
 #include <graphlab/util/hdfs.hpp>
 
 
@@ -612,6 +615,23 @@ namespace graphlab {
      *                Defaults to 50,000. Increasing this number will
      *                decrease partitioning time with a penalty to partitioning
      *                quality.
+     * \li \c ingress_chunk_size Uncompressed input files larger than this
+     *                many bytes are split into newline aligned byte ranges
+     *                which are parsed in parallel by all machines and
+     *                threads. Defaults to 64MB. Set to 0 to only parallelize
+     *                across files.
+     * \li \c compress_edges If set to 1 the local graph stores its edge
+     *                lists sorted and delta/varint encoded, which needs
+     *                2-3x less memory for the graph structure than the
+     *                plain CSR/CSC arrays at some cost in edge iteration
+     *                speed. Defaults to 0. Only supported if the graph
+     *                is built without USE_DYNAMIC_LOCAL_GRAPH.
+     * \li \c reorder_vertices The order of the local vertex ids assigned
+     *                by the first finalize(). "none" (the default) keeps
+     *                the order in which the edges arrived. "degree" sorts
+     *                by decreasing degree, "bfs" numbers the vertices in
+     *                breadth first order from the highest degree vertices
+     *                so that neighbors tend to share cache lines.
      *
      * \param [in] dc Distributed controller to associate with
      * \param [in] opts A graphlab::graphlab_options object specifying engine
@@ -622,13 +642,15 @@ namespace graphlab {
                       const graphlab_options& opts = graphlab_options()) :
       rpc(dc, this), finalized(false), vid2lvid(),
       nverts(0), nedges(0), local_own_nverts(0), nreplicas(0),
+      snapshot_stamp(0), snapshot_ndeltas(0),
       ingress_ptr(NULL), 
 #ifdef _OPENMP
       vertex_exchange(dc, omp_get_max_threads()), 
 #else
       vertex_exchange(dc), 
 #endif
-      vset_exchange(dc), parallel_ingress(true) {
+      vset_exchange(dc), parallel_ingress(true),
+      ingress_chunk_size(64 * 1024 * 1024), vertex_order(VERTEX_ORDER_NONE) {
       rpc.barrier();
       set_options(opts);
     }
@@ -659,6 +681,28 @@ namespace graphlab {
           if (!parallel_ingress && rpc.procid() == 0)
             logstream(LOG_EMPH) << "Disable parallel ingress. Graph will be streamed through one node."
               << std::endl;
+        } else if (opt == "ingress_chunk_size") {
+          opts.get_graph_args().get_option("ingress_chunk_size", ingress_chunk_size);
+          if (rpc.procid() == 0)
+            logstream(LOG_EMPH) << "Graph Option: ingress_chunk_size = "
+              << ingress_chunk_size << std::endl;
+        } else if (opt == "compress_edges") {
+          bool compress_edges = false;
+          opts.get_graph_args().get_option("compress_edges", compress_edges);
+          if (rpc.procid() == 0)
+            logstream(LOG_EMPH) << "Graph Option: compress_edges = "
+              << compress_edges << std::endl;
+          local_graph.set_compressed(compress_edges);
+        } else if (opt == "reorder_vertices") {
+          std::string order;
+          opts.get_graph_args().get_option("reorder_vertices", order);
+          if (!parse_vertex_order(order, vertex_order)) {
+            logstream(LOG_FATAL) << "Unknown vertex order " << order
+              << ". Valid orders are none, degree and bfs." << std::endl;
+          }
+          if (rpc.procid() == 0)
+            logstream(LOG_EMPH) << "Graph Option: reorder_vertices = "
+              << order << std::endl;
         }
         /**
          * These options below are deprecated.
@@ -1827,6 +1871,249 @@ namespace graphlab {
     } // end of save
 
 
+    /** \brief Saves a base for incremental binary snapshots.
+     *
+     * Writes the complete graph exactly like save_binary() and then
+     * starts a new delta chain for the same prefix. Subsequent calls to
+     * save_binary_delta() append only the vertex and edge data which
+     * changed, and load_binary_incremental() replays the base followed
+     * by all deltas of the chain. This function must be called
+     * simultaneously on all machines.
+     *
+     * Each delta chain is identified by a stamp which is written to a
+     * marker file [prefix][procid].delta0.bin, so deltas left behind by
+     * an earlier chain using the same prefix are never replayed on top
+     * of a newer base.
+     *
+     * Returns true on success, and false if the files cannot be written.
+     */
+    bool save_binary_base(const std::string& prefix) {
+      if (!save_binary(prefix)) return false;
+      snapshot_stamp = uint64_t(time(NULL)) * 1000000 +
+                       timer::usec_of_day() % 1000000;
+      snapshot_ndeltas = 0;
+      dense_bitset empty_vertices(local_graph.num_vertices());
+      dense_bitset empty_edges(local_graph.num_edges());
+      return save_binary_delta(prefix, empty_vertices, empty_edges);
+    } // end of save_binary_base
+
+
+    /** \brief Appends a delta to the incremental binary snapshot
+     * started by save_binary_base(). This function must be called
+     * simultaneously on all machines.
+     *
+     * Only the data of the local vertices (masters and mirrors) set in
+     * dirty_vertices and of the local edges whose local edge id is set in
+     * dirty_edges is written to the file [prefix][procid].delta[n].bin.
+     * The graph structure must not change between the base and its
+     * deltas.
+     *
+     * The delta is first written to [prefix][procid].delta[n].bin.tmp and
+     * only renamed to its final name once it is complete, so a crash
+     * while saving never leaves a truncated delta behind.
+     *
+     * Returns true on success, and false if the file cannot be written.
+     */
+    bool save_binary_delta(const std::string& prefix,
+                           const dense_bitset& dirty_vertices,
+                           const dense_bitset& dirty_edges) {
+      ASSERT_EQ(dirty_vertices.size(), local_graph.num_vertices());
+      ASSERT_EQ(dirty_edges.size(), local_graph.num_edges());
+      rpc.full_barrier();
+      timer savetime;  savetime.start();
+      const size_t delta_id = snapshot_ndeltas;
+      std::string fname = binary_delta_fname(prefix, delta_id);
+      std::string tmpname = fname + ".tmp";
+      logstream(LOG_INFO) << "Save graph delta to " << fname << std::endl;
+      bool success = false;
+      if(boost::starts_with(fname, "hdfs://")) {
+        graphlab::hdfs hdfs;
+        {
+          graphlab::hdfs::fstream out_file(hdfs, tmpname, true);
+          boost::iostreams::filtering_stream<boost::iostreams::output> fout;
+          fout.push(boost::iostreams::gzip_compressor());
+          fout.push(out_file);
+          if (!fout.good()) {
+            logstream(LOG_ERROR) << "\n\tError opening file: " << tmpname << std::endl;
+            return false;
+          }
+          oarchive oarc(fout);
+          save_delta(oarc, delta_id, dirty_vertices, dirty_edges);
+          success = !oarc.fail();
+          fout.pop();
+          fout.pop();
+          out_file.close();
+        }
+        success = success && hdfs.rename(tmpname, fname);
+      } else {
+        std::ofstream out_file(tmpname.c_str(),
+                               std::ios_base::out | std::ios_base::binary);
+        if (!out_file.good()) {
+          logstream(LOG_ERROR) << "\n\tError opening file: " << tmpname << std::endl;
+          return false;
+        }
+        boost::iostreams::filtering_stream<boost::iostreams::output> fout;
+        fout.push(boost::iostreams::gzip_compressor());
+        fout.push(out_file);
+        oarchive oarc(fout);
+        save_delta(oarc, delta_id, dirty_vertices, dirty_edges);
+        fout.pop();
+        fout.pop();
+        out_file.close();
+        success = !out_file.fail() &&
+                  std::rename(tmpname.c_str(), fname.c_str()) == 0;
+      }
+      if (!success) {
+        logstream(LOG_ERROR) << "\n\tError writing file: " << fname << std::endl;
+        return false;
+      }
+      ++snapshot_ndeltas;
+      logstream(LOG_INFO) << "Finished saving binary graph delta: "
+                          << savetime.current_time() << std::endl;
+      rpc.full_barrier();
+      return true;
+    } // end of save_binary_delta
+
+
+    /** \brief Loads an incremental binary snapshot written with
+     * save_binary_base() and save_binary_delta(). This function must be
+     * called simultaneously on all machines.
+     *
+     * The base is loaded with load_binary() and the deltas
+     * [prefix][procid].delta1.bin, [prefix][procid].delta2.bin, ... are
+     * then replayed in order. Replay stops at the first delta which is
+     * missing or does not belong to the chain of the base on any machine,
+     * so all machines end up at the same snapshot.
+     *
+     * Return true on success and false on failure if the base cannot be
+     * loaded.
+     */
+    bool load_binary_incremental(const std::string& prefix) {
+      if (!load_binary(prefix)) return false;
+      // the marker delta identifies the chain of this base
+      snapshot_ndeltas = 0;
+      bool success = load_binary_delta(prefix, 0, true);
+      while(success) {
+        success = load_binary_delta(prefix, snapshot_ndeltas, false);
+      }
+      logstream(LOG_INFO) << "Replayed " << (snapshot_ndeltas > 0 ?
+                                             snapshot_ndeltas - 1 : 0)
+                          << " graph deltas" << std::endl;
+      return true;
+    } // end of load_binary_incremental
+
+
+    /** \brief Saves a distributed graph to an uncompressed, page aligned
+     * image which can be loaded with load_binary_mmap(). This function
+     * must be called simultaneously on all machines.
+     *
+     * Each machine writes a single file [prefix][procid].img holding the
+     * raw arrays of its local graph: lvid2record, the vertex and edge data
+     * and the CSR/CSC offsets and values. Since the arrays are written
+     * byte for byte, the vertex data and the edge data must be POD types,
+     * and the image can only be loaded by the same build on the
+     * <b>same number of machines</b>. Only the local filesystem is
+     * supported.
+     *
+     * If the graph is not already finalized before save_binary_mmap() is
+     * called, this function will finalize the graph.
+     *
+     * Returns true on success, and false if the image cannot be written.
+     */
+    bool save_binary_mmap(const std::string& prefix) {
+      check_mmap_types();
+      rpc.full_barrier();
+      finalize();
+      timer savetime;  savetime.start();
+      std::string fname = prefix + tostr(rpc.procid()) + ".img";
+      logstream(LOG_INFO) << "Save graph image to " << fname << std::endl;
+      if(boost::starts_with(fname, "hdfs://")) {
+        logstream(LOG_ERROR) << "Graph images cannot be written to HDFS: "
+                             << fname << std::endl;
+        return false;
+      }
+      mapped_image_writer img(fname);
+      if(!img.good()) {
+        logstream(LOG_ERROR) << "\n\tError opening file: " << fname << std::endl;
+        return false;
+      }
+      img.set_scalar(0, rpc.procid());
+      img.set_scalar(1, rpc.numprocs());
+      img.set_scalar(2, nverts);
+      img.set_scalar(3, nedges);
+      img.set_scalar(4, local_own_nverts);
+      img.set_scalar(5, nreplicas);
+      img.write_section(lvid2record);
+      local_graph.save_image(img);
+      if (!img.close()) return false;
+      logstream(LOG_INFO) << "Finish saving graph image to " << fname << std::endl
+                          << "Finished saving graph image at "
+                          << savetime.current_time() << std::endl;
+      rpc.full_barrier();
+      return true;
+    } // end of save_binary_mmap
+
+
+    /** \brief Loads a distributed graph from an image previously saved
+     * with save_binary_mmap(). This function must be called
+     * simultaneously on all machines.
+     *
+     * The image is mapped into memory and the arrays are copied into the
+     * local graph in bulk, without going through the serialization
+     * system. Only vid2lvid is rebuilt, from the global ids stored in
+     * lvid2record.
+     *
+     * A graph loaded using load_binary_mmap() is already finalized and
+     * structure modifications are not permitted after loading.
+     *
+     * Return true on success and false on failure if the image cannot be
+     * loaded.
+     */
+    bool load_binary_mmap(const std::string& prefix) {
+      check_mmap_types();
+      rpc.full_barrier();
+      timer loadtime;  loadtime.start();
+      std::string fname = prefix + tostr(rpc.procid()) + ".img";
+      logstream(LOG_INFO) << "Load graph image from " << fname << std::endl;
+      bool success = false;
+      {
+        mapped_image_reader img(fname);
+        if(!img.good()) {
+          logstream(LOG_ERROR) << "\n\tError opening file: " << fname << std::endl;
+        } else if (img.scalar(0) != rpc.procid() ||
+                   img.scalar(1) != rpc.numprocs()) {
+          logstream(LOG_ERROR) << "Graph image " << fname << " was saved by machine "
+                               << img.scalar(0) << " of " << img.scalar(1)
+                               << std::endl;
+        } else {
+          clear();
+          nverts = img.scalar(2);
+          nedges = img.scalar(3);
+          local_own_nverts = img.scalar(4);
+          nreplicas = img.scalar(5);
+          success = img.next_section(lvid2record) &&
+              local_graph.load_image(img) &&
+              local_graph.num_vertices() == lvid2record.size();
+          if (!success) {
+            logstream(LOG_ERROR) << "Corrupted graph image " << fname << std::endl;
+            clear();
+          }
+        }
+      }
+      if (!success) return false;
+      vid2lvid.rehash(lvid2record.size());
+      for (lvid_type lvid = 0; lvid < lvid2record.size(); ++lvid) {
+        vid2lvid[lvid2record[lvid].gvid] = lvid;
+      }
+      finalized = true;
+      logstream(LOG_INFO) << "Finish loading graph image from " << fname << std::endl
+                          << "Finished loading graph image at "
+                          << loadtime.current_time() << std::endl;
+      rpc.full_barrier();
+      return true;
+    } // end of load_binary_mmap
+
+
     /**
      * \brief Saves the graph to the filesystem using a provided Writer object.
      * Like \ref save(const std::string& prefix, writer writer, bool gzip, bool save_vertex, bool save_edge, size_t files_per_machine) "save()"
@@ -2131,7 +2418,7 @@ namespace graphlab {
      *               If prefix begins with "hdfs://", the output is written to
      *               HDFS.
      * \param format The file format to save in.
-     *               Either "tsv", "snap", "graphjrl" or "bin".
+     *               Either "tsv", "snap", "graphjrl", "bin" or "binmmap".
      * \param gzip If gzip compression should be used. If set, all files will be
      *             appended with the .gz suffix. Defaults to true. Ignored
      *             if format == "bin".
@@ -2149,6 +2436,8 @@ namespace graphlab {
              gzip, true, true, files_per_machine);
       } else if (format == "bin") {
          save_binary(prefix);
+      } else if (format == "binmmap") {
+         save_binary_mmap(prefix);
       } else if (format == "bintsv4") {
          save_direct(prefix, gzip, &graph_type::save_bintsv4_to_stream);
       } else {
@@ -2190,30 +2479,68 @@ namespace graphlab {
         logstream(LOG_WARNING) << "No files found matching " << original_path << std::endl;
       }
 
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
+      // Cut the files into work items. Compressed and small files are
+      // parsed whole, large uncompressed files are cut into byte ranges
+      // so that a single huge file is spread over all machines and
+      // threads. Every machine computes the same list and picks its
+      // items round robin.
+      std::vector<file_range> ranges;
       for(size_t i = 0; i < graph_files.size(); ++i) {
+        const bool gzip = boost::ends_with(graph_files[i], ".gz");
+        size_t fsize = 0;
+        if (!gzip) {
+          boost::system::error_code ec;
+          fsize = boost::filesystem::file_size(graph_files[i], ec);
+          if (ec) fsize = 0;
+        }
+        if (gzip || ingress_chunk_size == 0 || fsize <= ingress_chunk_size) {
+          ranges.push_back(file_range(i, 0, size_t(-1)));
+        } else {
+          for (size_t begin = 0; begin < fsize; begin += ingress_chunk_size) {
+            ranges.push_back(file_range(i, begin,
+                                        std::min(begin + ingress_chunk_size,
+                                                 fsize)));
+          }
+        }
+      }
+      std::vector<file_range> local_ranges;
+      for(size_t i = 0; i < ranges.size(); ++i) {
         if ((parallel_ingress && (i % rpc.numprocs() == rpc.procid()))
             || (!parallel_ingress && (rpc.procid() == 0))) {
-          logstream(LOG_EMPH) << "Loading graph from file: " << graph_files[i] << std::endl;
-          // is it a gzip file ?
-          const bool gzip = boost::ends_with(graph_files[i], ".gz");
-          // open the stream
-          std::ifstream in_file(graph_files[i].c_str(),
+          local_ranges.push_back(ranges[i]);
+        }
+      }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for(size_t i = 0; i < local_ranges.size(); ++i) {
+        const std::string& fname = graph_files[local_ranges[i].file];
+        bool success;
+        if (boost::ends_with(fname, ".gz")) {
+          logstream(LOG_EMPH) << "Loading graph from file: " << fname << std::endl;
+          std::ifstream in_file(fname.c_str(),
                                 std::ios_base::in | std::ios_base::binary);
-          // attach gzip if the file is gzip
           boost::iostreams::filtering_stream<boost::iostreams::input> fin;
-          // Using gzip filter
-          if (gzip) fin.push(boost::iostreams::gzip_decompressor());
+          fin.push(boost::iostreams::gzip_decompressor());
           fin.push(in_file);
-          const bool success = load_from_stream(graph_files[i], fin, line_parser);
-          if(!success) {
-            logstream(LOG_FATAL)
-              << "\n\tError parsing file: " << graph_files[i] << std::endl;
-          }
+          success = load_from_stream(fname, fin, line_parser);
           fin.pop();
-          if (gzip) fin.pop();
+          fin.pop();
+        } else {
+          if (local_ranges[i].end == size_t(-1)) {
+            logstream(LOG_EMPH) << "Loading graph from file: " << fname << std::endl;
+          } else {
+            logstream(LOG_EMPH) << "Loading graph from file: " << fname
+                                << " bytes [" << local_ranges[i].begin << ", "
+                                << local_ranges[i].end << ")" << std::endl;
+          }
+          success = load_from_file_range(fname, local_ranges[i].begin,
+                                         local_ranges[i].end, line_parser);
+        }
+        if(!success) {
+          logstream(LOG_FATAL)
+            << "\n\tError parsing file: " << fname << std::endl;
         }
       }
       rpc.full_barrier();
@@ -2439,6 +2766,8 @@ namespace graphlab {
          load_direct(path,&graph_type::load_bintsv4_from_stream);
       } else if (format == "bin") {
          load_binary(path);
+      } else if (format == "binmmap") {
+         load_binary_mmap(path);
       } else {
         logstream(LOG_ERROR)
           << "Unrecognized Format \"" << format << "\"!" << std::endl;
@@ -3175,6 +3504,13 @@ namespace graphlab {
     /** The global number of vertex replica */
     size_t nreplicas;
 
+    /** The stamp of the current incremental binary snapshot chain */
+    uint64_t snapshot_stamp;
+
+    /** The number of deltas written to or replayed from the current
+        incremental binary snapshot chain (including its marker) */
+    size_t snapshot_ndeltas;
+
     /** pointer to the distributed ingress object*/
     distributed_ingress_base<VertexData, EdgeData>* ingress_ptr;
 
@@ -3187,6 +3523,13 @@ namespace graphlab {
     /** Command option to disable parallel ingress. Used for simulating single node ingress */
     bool parallel_ingress;
 
+    /** Uncompressed files larger than this are split into byte ranges
+        by load_from_posixfs(). 0 disables splitting. */
+    size_t ingress_chunk_size;
+
+    /** The order in which finalize() numbers the local vertices */
+    vertex_order_type vertex_order;
+
 
     lock_manager_type lock_manager;
 
@@ -3246,8 +3589,9 @@ namespace graphlab {
                           line_parser_type& line_parser) {
       size_t linecount = 0;
       timer ti; ti.start();
+      // reused across lines to avoid an allocation per line
+      std::string line;
       while(fin.good() && !fin.eof()) {
-        std::string line;
         std::getline(fin, line);
         if(line.empty()) continue;
         if(fin.fail()) break;
@@ -3269,6 +3613,114 @@ namespace graphlab {
     } // end of load from stream
 
 
+    /** \internal
+     * A byte range of one of the input files of load_from_posixfs().
+     * An end of size_t(-1) denotes the whole file.
+     */
+    struct file_range {
+      size_t file;
+      size_t begin;
+      size_t end;
+      file_range(size_t file, size_t begin, size_t end) :
+        file(file), begin(begin), end(end) { }
+    };
+
+
+    /** \internal
+     * \brief Parses the lines of an uncompressed file which start within
+     * the byte range [begin, end).
+     *
+     * A line belongs to the range containing its first byte, so a range
+     * which does not start at the beginning of the file skips the partial
+     * line it starts in and the last line of a range is read past end.
+     * The file is read in large blocks into a reused buffer and each line
+     * is copied into a reused string which is handed to the line parser.
+     */
+    bool load_from_file_range(const std::string& filename,
+                              size_t begin, size_t end,
+                              line_parser_type& line_parser) {
+      std::ifstream fin(filename.c_str(),
+                        std::ios_base::in | std::ios_base::binary);
+      if (!fin.good()) {
+        logstream(LOG_ERROR) << "Error opening file: " << filename << std::endl;
+        return false;
+      }
+      const size_t BLOCK_SIZE = 4 * 1024 * 1024;
+      std::vector<char> buffer(BLOCK_SIZE);
+      std::string line;
+      // file offset of the first byte in the buffer
+      size_t buffer_offset = begin;
+      // if the range starts right after a newline there is no partial line
+      // to skip. Otherwise the skipped bytes belong to the previous range.
+      bool skip_partial = false;
+      if (begin > 0) {
+        fin.seekg(begin - 1);
+        char prev = 0;
+        fin.get(prev);
+        skip_partial = (prev != '\n');
+      }
+      // file offset of the first byte of the line in progress
+      size_t line_start = begin;
+      size_t linecount = 0;
+      timer ti; ti.start();
+      while(fin.good()) {
+        fin.read(&(buffer[0]), BLOCK_SIZE);
+        const size_t nread = fin.gcount();
+        if (nread == 0) break;
+        const char* ptr = &(buffer[0]);
+        const char* bufend = ptr + nread;
+        while (ptr < bufend) {
+          if (!skip_partial && line.empty() && line_start >= end) return true;
+          const char* eol = (const char*)memchr(ptr, '\n', bufend - ptr);
+          const char* stop = (eol == NULL) ? bufend : eol;
+          if (!skip_partial) line.append(ptr, stop);
+          if (eol == NULL) break;
+          ptr = eol + 1;
+          const size_t next_start = buffer_offset + (ptr - &(buffer[0]));
+          if (skip_partial) {
+            skip_partial = false;
+          } else {
+            if (!line.empty() &&
+                !parse_line(filename, line, linecount, line_parser)) {
+              return false;
+            }
+            line.clear();
+          }
+          line_start = next_start;
+          if (ti.current_time() > 5.0) {
+            logstream(LOG_INFO) << linecount << " Lines read" << std::endl;
+            ti.start();
+          }
+        }
+        buffer_offset += nread;
+      }
+      // last line of the file without a trailing newline
+      if (!skip_partial && !line.empty() && line_start < end) {
+        return parse_line(filename, line, linecount, line_parser);
+      }
+      return true;
+    } // end of load_from_file_range
+
+
+    /** \internal
+     * \brief Hands one line to the line parser, reporting failures like
+     * load_from_stream().
+     */
+    bool parse_line(const std::string& filename, const std::string& line,
+                    size_t& linecount, line_parser_type& line_parser) {
+      const bool success = line_parser(*this, filename, line);
+      if (!success) {
+        logstream(LOG_WARNING)
+          << "Error parsing line " << linecount << " in "
+          << filename << ": " << std::endl
+          << "\t\"" << line << "\"" << std::endl;
+        return false;
+      }
+      ++linecount;
+      return true;
+    } // end of parse_line
+
+
     template<typename Fstream, typename Writer>
     void save_vertex_to_stream(vertex_type& vertex, Fstream& fout, Writer writer) {
       fout << writer.save_vertex(vertex);
@@ -3281,6 +3733,156 @@ namespace graphlab {
       fout << ret;
     } // end of save_edge_to_stream
 
+    /** \internal
+     * \brief Fails if the vertex or edge data cannot be stored in a
+     * graph image as raw bytes.
+     */
+    void check_mmap_types() const {
+      if (!gl_is_pod<vertex_data_type>::value ||
+          !gl_is_pod<edge_data_type>::value) {
+        logstream(LOG_FATAL)
+          << "\n\tGraph images require POD vertex and edge data types."
+          << std::endl;
+      }
+    } // end of check_mmap_types
+
+    /** \internal
+     * \brief Returns the file name of the binary delta delta_id of this
+     * machine.
+     */
+    std::string binary_delta_fname(const std::string& prefix,
+                                   size_t delta_id) const {
+      return prefix + tostr(rpc.procid()) + ".delta" + tostr(delta_id) + ".bin";
+    } // end of binary_delta_fname
+
+
+    /** \internal
+     * \brief The tag which ends every complete binary delta.
+     */
+    static uint64_t binary_delta_trailer() {
+      return 0x61746c6564707267ULL;
+    } // end of binary_delta_trailer
+
+
+    /** \internal
+     * \brief Writes the header, the dirty vertex and edge data and the
+     * trailer of a binary delta. The trailer repeats the stamp and
+     * holds the number of records, which load_delta() checks before
+     * anything is applied.
+     */
+    void save_delta(oarchive& arc, size_t delta_id,
+                    const dense_bitset& dirty_vertices,
+                    const dense_bitset& dirty_edges) {
+      arc << snapshot_stamp << delta_id
+          << local_graph.num_vertices() << local_graph.num_edges();
+      const size_t nvertices = dirty_vertices.popcount();
+      arc << nvertices;
+      foreach(size_t lvid, dirty_vertices) {
+        arc << lvid_type(lvid) << local_graph.vertex_data(lvid);
+      }
+      const size_t nedges = dirty_edges.popcount();
+      arc << nedges;
+      foreach(size_t eid, dirty_edges) {
+        arc << eid << local_graph.edge_data(eid);
+      }
+      arc << binary_delta_trailer() << snapshot_stamp << (nvertices + nedges);
+    } // end of save_delta
+
+
+    /** \internal
+     * \brief Reads the binary delta delta_id and applies it if it belongs
+     * to the current chain on all machines. If marker is set the delta
+     * starts a chain and its stamp is adopted.
+     */
+    bool load_binary_delta(const std::string& prefix, size_t delta_id,
+                           bool marker) {
+      std::string fname = binary_delta_fname(prefix, delta_id);
+      bool success = false;
+      if(boost::starts_with(fname, "hdfs://")) {
+        graphlab::hdfs hdfs;
+        graphlab::hdfs::fstream in_file(hdfs, fname);
+        boost::iostreams::filtering_stream<boost::iostreams::input> fin;
+        fin.push(boost::iostreams::gzip_decompressor());
+        fin.push(in_file);
+        success = load_delta(fin, in_file.good(), delta_id, marker);
+        fin.pop();
+        fin.pop();
+        in_file.close();
+      } else {
+        std::ifstream in_file(fname.c_str(),
+                              std::ios_base::in | std::ios_base::binary);
+        boost::iostreams::filtering_stream<boost::iostreams::input> fin;
+        fin.push(boost::iostreams::gzip_decompressor());
+        fin.push(in_file);
+        success = load_delta(fin, in_file.good(), delta_id, marker);
+        fin.pop();
+        fin.pop();
+        in_file.close();
+      }
+      return success;
+    } // end of load_binary_delta
+
+
+    /** \internal
+     * \brief Reads a complete binary delta and validates its header and
+     * trailer, agrees with all other machines on whether it is to be
+     * replayed, and applies it. A delta which is truncated or corrupt on
+     * any machine is not applied anywhere.
+     */
+    template<typename Fstream>
+    bool load_delta(Fstream& fin, bool file_good, size_t delta_id,
+                    bool marker) {
+      uint64_t stamp = 0;
+      std::vector<std::pair<lvid_type, vertex_data_type> > vdata;
+      std::vector<std::pair<size_t, edge_data_type> > edata;
+      size_t nfailures = 1;
+      if (file_good) {
+        try {
+          iarchive iarc(fin);
+          size_t id = 0, nlverts = 0, nledges = 0;
+          iarc >> stamp >> id >> nlverts >> nledges;
+          bool valid = fin.good() && id == delta_id &&
+                       nlverts == local_graph.num_vertices() &&
+                       nledges == local_graph.num_edges() &&
+                       (marker || stamp == snapshot_stamp);
+          size_t ndirty = 0;
+          if (valid) iarc >> ndirty;
+          for (size_t i = 0; valid && i < ndirty; ++i) {
+            std::pair<lvid_type, vertex_data_type> entry;
+            iarc >> entry.first >> entry.second;
+            valid = fin.good() && entry.first < nlverts;
+            vdata.push_back(entry);
+          }
+          if (valid) iarc >> ndirty;
+          for (size_t i = 0; valid && i < ndirty; ++i) {
+            std::pair<size_t, edge_data_type> entry;
+            iarc >> entry.first >> entry.second;
+            valid = fin.good() && entry.first < nledges;
+            edata.push_back(entry);
+          }
+          uint64_t trailer = 0, trailer_stamp = 0;
+          size_t nrecords = 0;
+          if (valid) iarc >> trailer >> trailer_stamp >> nrecords;
+          if (valid && !fin.fail() && trailer == binary_delta_trailer() &&
+              trailer_stamp == stamp &&
+              nrecords == vdata.size() + edata.size()) {
+            nfailures = 0;
+          }
+        } catch (std::ios_base::failure&) { }
+      }
+      rpc.all_reduce(nfailures);
+      if (nfailures > 0) return false;
+      if (marker) snapshot_stamp = stamp;
+      for (size_t i = 0; i < vdata.size(); ++i) {
+        local_graph.vertex_data(vdata[i].first) = vdata[i].second;
+      }
+      for (size_t i = 0; i < edata.size(); ++i) {
+        local_graph.edge_data(edata[i].first) = edata[i].second;
+      }
+      ++snapshot_ndeltas;
+      return true;
+    } // end of load_delta
+
 
     void save_bintsv4_to_stream(std::ostream& out) {
       for (int i = 0; i < (int)local_graph.num_vertices(); ++i) {
@@ -48,17 +48,20 @@
 
 #include <graphlab/graph/graph_basic_types.hpp>
 #include <graphlab/graph/local_edge_buffer.hpp>
+#include <graphlab/graph/vertex_ordering.hpp>
 #include <graphlab/util/random.hpp>
 #include <graphlab/util/generics/shuffle.hpp>
 #include <graphlab/util/generics/counting_sort.hpp>
 #include <graphlab/util/generics/dynamic_csr_storage.hpp>
 #include <graphlab/parallel/atomic.hpp>
+#include <graphlab/parallel/numa_tools.hpp>
 
 #include <graphlab/logger/logger.hpp>
 #include <graphlab/logger/assertions.hpp>
 
 #include <graphlab/serialization/iarchive.hpp>
 #include <graphlab/serialization/oarchive.hpp>
+#include <graphlab/util/mapped_image.hpp>
 
 #include <graphlab/util/random.hpp>
 #include <graphlab/macros_def.hpp>
@@ -110,6 +113,32 @@ namespace graphlab {
       return true;
     }
 
+    /**
+     * \brief Compressed edge lists are only supported by the static
+     * local_graph. Requesting them is ignored with a warning.
+     */
+    void set_compressed(bool value) {
+      if (value) {
+        logstream(LOG_WARNING)
+          << "Compressed edge lists are not supported by the dynamic "
+          << "local_graph. Edges are stored uncompressed." << std::endl;
+      }
+    }
+
+    /** \brief Always false: the edge lists are stored uncompressed. */
+    bool is_compressed() const {
+      return false;
+    }
+
+    /**
+     * \brief Spreads the vertex and edge data round robin across the
+     * NUMA nodes of the machine, see numa::interleave_memory().
+     */
+    void interleave_memory() {
+      numa::interleave_vector(vertices);
+      numa::interleave_vector(edges);
+    }
+
     /**
      * \brief Resets the local_graph state.
      */
@@ -169,6 +198,36 @@ namespace graphlab {
     void reserve_edge_space(size_t n) {
       edge_buffer.reserve_edge_space(n);
     }
+
+    /**
+     * \brief Renumbers the vertices in the given order before the edges
+     * are finalized, so that vertices which are accessed together have
+     * nearby ids. Vertex data moves with its vertex and the edges not
+     * yet finalized are relabeled.
+     *
+     * \param [out] new_lvid new_lvid[v] is the new id of old vertex v.
+     *                       Callers must remap their own per vertex state.
+     */
+    void reorder_vertices(vertex_order_type order,
+                          std::vector<lvid_type>& new_lvid) {
+      if (num_edges() > 0) {
+        logstream(LOG_FATAL)
+          << "Attempting to reorder the vertices of a local_graph with "
+          << "finalized edges." << std::endl;
+      }
+      compute_vertex_order(order, vertices.size(), edge_buffer.source_arr,
+                           edge_buffer.target_arr, new_lvid);
+      std::vector<VertexData> permuted(vertices.size());
+      for (size_t i = 0; i < vertices.size(); ++i) {
+        permuted[new_lvid[i]] = vertices[i];
+      }
+      vertices.swap(permuted);
+      for (size_t i = 0; i < edge_buffer.size(); ++i) {
+        edge_buffer.source_arr[i] = new_lvid[edge_buffer.source_arr[i]];
+        edge_buffer.target_arr[i] = new_lvid[edge_buffer.target_arr[i]];
+      }
+    } // end of reorder_vertices
+
     /**
      * \brief Creates an edge connecting vertex source to vertex target.  Any
      * existing data will be cleared. Should not be called after finalization.
@@ -365,6 +424,30 @@ namespace graphlab {
           << _csc_storage;
     } // end of save
 
+    /**
+     * \brief Append the local_graph to a mapped image. Vertex and edge
+     * data are written as raw arrays, so they must be POD types.
+     */
+    void save_image(mapped_image_writer& img) const {
+      img.write_section(vertices);
+      img.write_section(edges);
+      _csr_storage.save_image(img);
+      _csc_storage.save_image(img);
+    } // end of save_image
+
+    /**
+     * \brief Load the local_graph from a mapped image written by
+     * save_image(). Returns false if the image layout does not match.
+     */
+    bool load_image(mapped_image_reader& img) {
+      clear();
+      bool success = img.next_section(vertices)
+          && img.next_section(edges)
+          && _csr_storage.load_image(img)
+          && _csc_storage.load_image(img);
+      return success;
+    } // end of load_image
+
     /** swap two graphs */
     void swap(dynamic_local_graph& other) {
       std::swap(vertices, other.vertices);
@@ -28,6 +28,7 @@
 #include <graphlab/graph/ingress/ingress_edge_decision.hpp>
 #include <graphlab/graph/graph_gather_apply.hpp>
 #include <graphlab/util/memory_info.hpp>
+#include <graphlab/util/timer.hpp>
 #include <graphlab/util/hopscotch_map.hpp>
 #include <graphlab/rpc/buffered_exchange.hpp>
 #include <graphlab/macros_def.hpp>
@@ -370,6 +371,28 @@ namespace graphlab {
           memory_info::log_usage("Finished populating local graph.");
         }
 
+        // Renumber the new vertices for locality. Only possible before
+        // any lvid was handed out, i.e. on the first finalization.
+        if (graph.vertex_order != VERTEX_ORDER_NONE) {
+          if (lvid_start == 0) {
+            timer reorder_timer;
+            std::vector<lvid_type> new_lvid;
+            graph.local_graph.reorder_vertices(graph.vertex_order, new_lvid);
+            typedef typename vid2lvid_map_type::iterator vid2lvid_iterator;
+            for (vid2lvid_iterator it = vid2lvid_buffer.begin();
+                 it != vid2lvid_buffer.end(); ++it) {
+              it->second = new_lvid[it->second];
+            }
+            logstream(LOG_INFO) << "Graph Finalize: reordered "
+                                << new_lvid.size() << " vertices in "
+                                << reorder_timer.current_time() << "s"
+                                << std::endl;
+          } else if (rpc.procid() == 0) {
+            logstream(LOG_WARNING) << "Vertices are only reordered on the "
+                                   << "first finalize()." << std::endl;
+          }
+        }
+
         // Finalize local graph
         logstream(LOG_INFO) << "Graph Finalize: finalizing local graph."
                             << std::endl;
@@ -47,18 +47,22 @@
 
 #include <graphlab/graph/graph_basic_types.hpp>
 #include <graphlab/graph/local_edge_buffer.hpp>
+#include <graphlab/graph/vertex_ordering.hpp>
 #include <graphlab/util/random.hpp>
 #include <graphlab/util/generics/shuffle.hpp>
 #include <graphlab/util/generics/counting_sort.hpp>
 #include <graphlab/util/generics/vector_zip.hpp>
 #include <graphlab/util/generics/csr_storage.hpp>
+#include <graphlab/util/generics/compressed_csr_storage.hpp>
 #include <graphlab/parallel/atomic.hpp>
+#include <graphlab/parallel/numa_tools.hpp>
 
 #include <graphlab/logger/logger.hpp>
 #include <graphlab/logger/assertions.hpp>
 
 #include <graphlab/serialization/iarchive.hpp>
 #include <graphlab/serialization/oarchive.hpp>
+#include <graphlab/util/mapped_image.hpp>
 
 #include <graphlab/util/random.hpp>
 #include <graphlab/macros_def.hpp>
@@ -165,12 +169,12 @@ namespace graphlab {
     // CONSTRUCTORS ============================================================>
     
     /** Create an empty local_graph. */
-    local_graph() : finalized(false) { }
+    local_graph() : finalized(false), compressed(false) { }
 
     /** Create a local_graph with nverts vertices. */
     local_graph(size_t nverts) :
       vertices(nverts),
-      finalized(false) { }
+      finalized(false), compressed(false) { }
 
     // METHODS =================================================================>
     
@@ -178,6 +182,39 @@ namespace graphlab {
       return false;
     }
 
+    /**
+     * \brief Store the edge lists compressed when the graph is
+     * finalized. Must be set before finalize().
+     *
+     * The neighbors of each vertex are sorted and stored as delta and
+     * varint encoded ids which the edge iterators decode on the fly.
+     * This takes a fraction of the memory of the plain CSR/CSC arrays.
+     * Iterating over the edge lists stays linear, but random access
+     * into an edge list (operator[]) costs up to its length.
+     */
+    void set_compressed(bool value) {
+      if (finalized) {
+        logstream(LOG_FATAL)
+          << "Attempting to change the edge layout of a finalized local_graph."
+          << std::endl;
+      }
+      compressed = value;
+    }
+
+    /** \brief Returns true if the edge lists are stored compressed. */
+    bool is_compressed() const {
+      return compressed;
+    }
+
+    /**
+     * \brief Spreads the vertex and edge data round robin across the
+     * NUMA nodes of the machine, see numa::interleave_memory().
+     */
+    void interleave_memory() {
+      numa::interleave_vector(vertices);
+      numa::interleave_vector(edges);
+    }
+
     /**
      * \brief Resets the local_graph state.
      */
@@ -187,6 +224,8 @@ namespace graphlab {
       edges.clear();
       _csc_storage.clear();
       _csr_storage.clear();
+      _compressed_csr.clear();
+      _compressed_csc.clear();
       std::vector<VertexData>().swap(vertices);
       std::vector<EdgeData>().swap(edges);
       edge_buffer.clear();
@@ -221,33 +260,19 @@ namespace graphlab {
 #ifdef DEBUG_GRAPH
       logstream(LOG_DEBUG) << "Graph2 finalize: Inplace permute by source id" << std::endl;
 #endif
-      lvid_type swap_src; lvid_type swap_target; EdgeData  swap_data;
-      for (size_t i = 0; i < permute.size(); ++i) {
-        if (i != permute[i]) {
-          // Reserve the ith entry;
-          size_t j = i;
-          swap_data = edge_buffer.data[i];
-          swap_src = edge_buffer.source_arr[i];
-          swap_target = edge_buffer.target_arr[i];
-          // Begin swap cycle:
-          while (j != permute[j]) {
-            size_t next = permute[j];
-            if (next != i) {
-              edge_buffer.data[j] = edge_buffer.data[next];
-              edge_buffer.source_arr[j] = edge_buffer.source_arr[next];
-              edge_buffer.target_arr[j] = edge_buffer.target_arr[next];
-              permute[j] = j;
-              j = next;
-            } else {
-              // end of cycle
-              edge_buffer.data[j] = swap_data;
-              edge_buffer.source_arr[j] = swap_src;
-              edge_buffer.target_arr[j] = swap_target;
-              permute[j] = j;
-              break;
-            }
-          }
+      permute_edge_buffer(permute);
+      if (compressed) {
+        // Order the out edges of every vertex by target so that the
+        // neighbor lists can be delta encoded.
+        for (size_t i = 0; i < permute.size(); ++i) permute[i] = i;
+        for (size_t i = 0; i < src_counting_prefix_sum.size(); ++i) {
+          const size_t begin = src_counting_prefix_sum[i];
+          const size_t end = (i + 1 < src_counting_prefix_sum.size()) ?
+              src_counting_prefix_sum[i + 1] : permute.size();
+          std::sort(permute.begin() + begin, permute.begin() + end,
+                    target_less(edge_buffer.target_arr));
         }
+        permute_edge_buffer(permute);
       }
 #ifdef DEBUG_GRAPH
       logstream(LOG_DEBUG) << "Graph2 finalize: Sort by dest id" << std::endl;
@@ -263,14 +288,46 @@ namespace graphlab {
       // inplace_shuffle(edge_buffer.source_arr, permute);
       // counting_sort(edge_buffer.target_arr, permute);
 
-      // warp into csr csc storage.
-      _csr_storage.wrap(src_counting_prefix_sum, edge_buffer.target_arr);
-      std::vector<std::pair<lvid_type, edge_id_type> > csc_value = vector_zip(edge_buffer.source_arr, permute);
-      //ASSERT_EQ(csc_value.size(), edge_buffer.size());
-      _csc_storage.wrap(dest_counting_prefix_sum, csc_value); 
-      edges.swap(edge_buffer.data);
-      ASSERT_EQ(_csr_storage.num_values(), _csc_storage.num_values());
-      ASSERT_EQ(_csr_storage.num_values(), edges.size());
+      if (compressed) {
+        // In edges are encoded as the source and the position of the
+        // edge among the out edges of the source.
+        std::vector<std::pair<lvid_type, edge_id_type> > csc_value(permute.size());
+        for (size_t i = 0; i < permute.size(); ++i) {
+          const lvid_type source = edge_buffer.source_arr[i];
+          csc_value[i].first = source;
+          csc_value[i].second = permute[i] - src_counting_prefix_sum[source];
+        }
+        std::vector<lvid_type>().swap(edge_buffer.source_arr);
+        std::vector<edge_id_type>().swap(permute);
+        for (size_t i = 0; i < dest_counting_prefix_sum.size(); ++i) {
+          const size_t begin = dest_counting_prefix_sum[i];
+          const size_t end = (i + 1 < dest_counting_prefix_sum.size()) ?
+              dest_counting_prefix_sum[i + 1] : csc_value.size();
+          std::sort(csc_value.begin() + begin, csc_value.begin() + end);
+        }
+        std::vector<lvid_type> csc_sources(csc_value.size());
+        std::vector<edge_id_type> csc_offsets(csc_value.size());
+        for (size_t i = 0; i < csc_value.size(); ++i) {
+          csc_sources[i] = csc_value[i].first;
+          csc_offsets[i] = csc_value[i].second;
+        }
+        std::vector<std::pair<lvid_type, edge_id_type> >().swap(csc_value);
+        _compressed_csc.init(dest_counting_prefix_sum, csc_sources, csc_offsets);
+        _compressed_csr.init(src_counting_prefix_sum, edge_buffer.target_arr);
+        std::vector<lvid_type>().swap(edge_buffer.target_arr);
+        edges.swap(edge_buffer.data);
+        ASSERT_EQ(_compressed_csr.num_values(), _compressed_csc.num_values());
+        ASSERT_EQ(_compressed_csr.num_values(), edges.size());
+      } else {
+        // warp into csr csc storage.
+        _csr_storage.wrap(src_counting_prefix_sum, edge_buffer.target_arr);
+        std::vector<std::pair<lvid_type, edge_id_type> > csc_value = vector_zip(edge_buffer.source_arr, permute);
+        //ASSERT_EQ(csc_value.size(), edge_buffer.size());
+        _csc_storage.wrap(dest_counting_prefix_sum, csc_value); 
+        edges.swap(edge_buffer.data);
+        ASSERT_EQ(_csr_storage.num_values(), _csc_storage.num_values());
+        ASSERT_EQ(_csr_storage.num_values(), edges.size());
+      }
 #ifdef DEBGU_GRAPH
       logstream(LOG_DEBUG) << "End of finalize." << std::endl;
 #endif
@@ -326,6 +383,36 @@ namespace graphlab {
     void reserve_edge_space(size_t n) {
       edge_buffer.reserve_edge_space(n);
     }
+
+    /**
+     * \brief Renumbers the vertices in the given order before the edges
+     * are finalized, so that vertices which are accessed together have
+     * nearby ids. Vertex data moves with its vertex and the edges not
+     * yet finalized are relabeled.
+     *
+     * \param [out] new_lvid new_lvid[v] is the new id of old vertex v.
+     *                       Callers must remap their own per vertex state.
+     */
+    void reorder_vertices(vertex_order_type order,
+                          std::vector<lvid_type>& new_lvid) {
+      if (finalized) {
+        logstream(LOG_FATAL)
+          << "Attempting to reorder the vertices of a finalized local_graph."
+          << std::endl;
+      }
+      compute_vertex_order(order, vertices.size(), edge_buffer.source_arr,
+                           edge_buffer.target_arr, new_lvid);
+      std::vector<VertexData> permuted(vertices.size());
+      for (size_t i = 0; i < vertices.size(); ++i) {
+        permuted[new_lvid[i]] = vertices[i];
+      }
+      vertices.swap(permuted);
+      for (size_t i = 0; i < edge_buffer.size(); ++i) {
+        edge_buffer.source_arr[i] = new_lvid[edge_buffer.source_arr[i]];
+        edge_buffer.target_arr[i] = new_lvid[edge_buffer.target_arr[i]];
+      }
+    } // end of reorder_vertices
+
     /**
      * \brief Creates an edge connecting vertex source to vertex target.  Any
      * existing data will be cleared. Should not be called after finalization.
@@ -425,7 +512,10 @@ namespace graphlab {
           >> edges 
           >> _csr_storage
           >> _csc_storage
-          >> finalized;
+          >> finalized
+          >> compressed
+          >> _compressed_csr
+          >> _compressed_csc;
     } // end of load
 
     /** \brief Save the local_graph to an archive */
@@ -435,9 +525,45 @@ namespace graphlab {
           << edges
           << _csr_storage  
           << _csc_storage
-          << finalized;
+          << finalized
+          << compressed
+          << _compressed_csr
+          << _compressed_csc;
     } // end of save
-    
+
+    /**
+     * \brief Append the local_graph to a mapped image. Vertex and edge
+     * data are written as raw arrays, so they must be POD types.
+     */
+    void save_image(mapped_image_writer& img) const {
+      img.write_section(vertices);
+      img.write_section(edges);
+      _csr_storage.save_image(img);
+      _csc_storage.save_image(img);
+      img.write_section(&compressed, 1);
+      _compressed_csr.save_image(img);
+      _compressed_csc.save_image(img);
+    } // end of save_image
+
+    /**
+     * \brief Load the local_graph from a mapped image written by
+     * save_image(). Returns false if the image layout does not match.
+     */
+    bool load_image(mapped_image_reader& img) {
+      clear();
+      const bool* is_compressed = NULL; size_t count = 0;
+      bool success = img.next_section(vertices)
+          && img.next_section(edges)
+          && _csr_storage.load_image(img)
+          && _csc_storage.load_image(img)
+          && img.next_section(is_compressed, count) && count == 1
+          && _compressed_csr.load_image(img)
+          && _compressed_csc.load_image(img);
+      compressed = success && *is_compressed;
+      finalized = success;
+      return success;
+    } // end of load_image
+
     /** swap two graphs */
     void swap(local_graph& other) {
       finalized = other.finalized;
@@ -445,7 +571,10 @@ namespace graphlab {
       std::swap(edges, other.edges);
       std::swap(_csr_storage, other._csr_storage);
       std::swap(_csc_storage, other._csc_storage);
+      _compressed_csr.swap(other._compressed_csr);
+      _compressed_csc.swap(other._compressed_csc);
       std::swap(finalized, other.finalized);
+      std::swap(compressed, other.compressed);
     } // end of swap
 
 
@@ -502,6 +631,7 @@ namespace graphlab {
      * \brief Returns the number of in edges of the vertex with the given id. */
     size_t num_in_edges(const lvid_type v) const {
       ASSERT_TRUE(finalized);
+      if (compressed) return _compressed_csc.degree(v);
       return (_csc_storage.end(v) - _csc_storage.begin(v));
     }
 
@@ -510,6 +640,7 @@ namespace graphlab {
      * \brief Returns the number of in edges of the vertex with the given id. */
     size_t num_out_edges(const lvid_type v) const {
       ASSERT_TRUE(finalized);
+      if (compressed) return _compressed_csr.degree(v);
       return (_csr_storage.end(v) - _csr_storage.begin(v));
     }
 
@@ -517,6 +648,12 @@ namespace graphlab {
      * \internal
      * \brief Returns a list of in edges of the vertex with the given id. */
     edge_list_type in_edges(lvid_type v) {
+      if (compressed) {
+        return boost::make_iterator_range(
+            edge_iterator(*this, edge_iterator::CSC_COMPRESSED, v, 0),
+            edge_iterator(*this, edge_iterator::CSC_COMPRESSED, v,
+                          _compressed_csc.degree(v)));
+      }
       edge_iterator begin = edge_iterator(*this, _csc_storage.begin(v), v);
       edge_iterator end = edge_iterator(*this, _csc_storage.end(v), v);
       return boost::make_iterator_range(begin, end);
@@ -526,6 +663,12 @@ namespace graphlab {
      * \internal
      * \brief Returns a list of out edges of the vertex with the given id. */
     edge_list_type out_edges(lvid_type v) {
+      if (compressed) {
+        return boost::make_iterator_range(
+            edge_iterator(*this, edge_iterator::CSR_COMPRESSED, v, 0),
+            edge_iterator(*this, edge_iterator::CSR_COMPRESSED, v,
+                          _compressed_csr.degree(v)));
+      }
 
       csr_type::iterator base_begin = _csr_storage.begin(v);
       csr_type::iterator base_end = _csr_storage.end(v);
@@ -572,6 +715,8 @@ namespace graphlab {
         sizeof(VertexData) * vertices.capacity();
       size_t elist_size = _csr_storage.estimate_sizeof() 
           + _csc_storage.estimate_sizeof()
+          + _compressed_csr.estimate_sizeof()
+          + _compressed_csc.estimate_sizeof()
           + sizeof(edges) + sizeof(EdgeData)*edges.capacity();
       size_t ebuffer_size = edge_buffer.estimate_sizeof();
       // std::cerr << "local_graph: tmplist size: " << (double)elist_size/(1024*1024)
@@ -599,6 +744,52 @@ namespace graphlab {
     }
    
   private:    
+    /**
+     * \internal
+     * Inplace permute of the edge data, source and target arrays of the
+     * edge buffer: entry permute[i] moves to position i.
+     */
+    void permute_edge_buffer(std::vector<edge_id_type>& permute) {
+      lvid_type swap_src; lvid_type swap_target; EdgeData  swap_data;
+      for (size_t i = 0; i < permute.size(); ++i) {
+        if (i != permute[i]) {
+          // Reserve the ith entry;
+          size_t j = i;
+          swap_data = edge_buffer.data[i];
+          swap_src = edge_buffer.source_arr[i];
+          swap_target = edge_buffer.target_arr[i];
+          // Begin swap cycle:
+          while (j != permute[j]) {
+            size_t next = permute[j];
+            if (next != i) {
+              edge_buffer.data[j] = edge_buffer.data[next];
+              edge_buffer.source_arr[j] = edge_buffer.source_arr[next];
+              edge_buffer.target_arr[j] = edge_buffer.target_arr[next];
+              permute[j] = j;
+              j = next;
+            } else {
+              // end of cycle
+              edge_buffer.data[j] = swap_data;
+              edge_buffer.source_arr[j] = swap_src;
+              edge_buffer.target_arr[j] = swap_target;
+              permute[j] = j;
+              break;
+            }
+          }
+        }
+      }
+    }
+
+    /** \internal Orders edge buffer positions by their target */
+    struct target_less {
+      const std::vector<lvid_type>& target_arr;
+      target_less(const std::vector<lvid_type>& target_arr)
+          : target_arr(target_arr) { }
+      bool operator()(edge_id_type a, edge_id_type b) const {
+        return target_arr[a] < target_arr[b];
+      }
+    };
+
     /** 
      * \internal
      * CSR/CSC storage types
@@ -613,6 +804,15 @@ namespace graphlab {
     typedef boost::zip_iterator<csr_iterator_tuple> csr_edge_iterator;
     typedef csc_type::iterator csc_edge_iterator;
 
+    /**
+     * \internal
+     * Compressed CSR/CSC storage types. An in edge stores its source and
+     * the position of the edge among the out edges of the source.
+     */
+    typedef compressed_csr_storage<lvid_type, false, edge_id_type> compressed_csr_type;
+    typedef compressed_csr_storage<lvid_type, true, edge_id_type> compressed_csc_type;
+    typedef compressed_csr_type::cursor compressed_cursor;
+
     class edge_iterator : 
         public boost::iterator_facade <
         edge_iterator,
@@ -626,6 +826,17 @@ namespace graphlab {
            edge_iterator(local_graph& lgraph_ref,
                          csr_edge_iterator iter, lvid_type destid) 
                : lgraph_ref(lgraph_ref), _type(CSR), csr_iter(iter), vid(destid) {}
+           enum list_type {CSR, CSC, CSR_COMPRESSED, CSC_COMPRESSED};
+           /// Iterator at position index of a compressed edge list of vid
+           edge_iterator(local_graph& lgraph_ref, list_type type,
+                         lvid_type vid, size_t index)
+               : lgraph_ref(lgraph_ref), _type(type), vid(vid) {
+             ASSERT_TRUE(type == CSR_COMPRESSED || type == CSC_COMPRESSED);
+             restart();
+             // end iterators must not decode the list
+             if (index >= degree) this->index = degree;
+             else seek(index);
+           }
 
          private:
            friend class boost::iterator_core_access;
@@ -634,7 +845,9 @@ namespace graphlab {
              switch (_type) {
               case CSC: ++csc_iter; break;
               case CSR: ++csr_iter; break;
-              default: return;
+              default: 
+                if (++index < degree) next();
+                return;
              }
            }
            bool equal(const edge_iterator& other) const
@@ -643,7 +856,7 @@ namespace graphlab {
              switch (_type) {
               case CSC: return csc_iter == other.csc_iter;
               case CSR: return csr_iter == other.csr_iter;
-              default: return true;
+              default: return index == other.index;
              }
            }
            edge_type dereference() const { 
@@ -653,21 +866,51 @@ namespace graphlab {
              switch (_type) {
               case CSC: --csc_iter; break;
               case CSR: --csr_iter; break;
-              default: return;
+              default: seek(index - 1); return;
              }
            }
            void advance(int n) {
              switch (_type) {
               case CSC: csc_iter+=n; break;
               case CSR: csr_iter+=n; break;
-              default: return;
+              default: seek(index + n); return;
              }
            } 
            ptrdiff_t distance_to(const edge_iterator& other) const {
              switch (_type) {
               case CSC: return other.csc_iter - csc_iter;
               case CSR: return other.csr_iter - csr_iter;
-              default: return 0;
+              default: return ptrdiff_t(other.index) - ptrdiff_t(index);
+             }
+           }
+           /// Decodes the next entry of a compressed list
+           void next() {
+             if (_type == CSR_COMPRESSED) lgraph_ref._compressed_csr.next(cursor);
+             else lgraph_ref._compressed_csc.next(cursor);
+           }
+           /// Positions a compressed iterator at the first entry of its list
+           void restart() {
+             if (_type == CSR_COMPRESSED) {
+               lgraph_ref._compressed_csr.start(vid, cursor);
+               degree = lgraph_ref._compressed_csr.degree(vid);
+               base_eid = lgraph_ref._compressed_csr.begin_index(vid);
+             } else {
+               lgraph_ref._compressed_csc.start(vid, cursor);
+               degree = lgraph_ref._compressed_csc.degree(vid);
+               base_eid = 0;
+             }
+             index = 0;
+             if (degree > 0) next();
+           }
+           /**
+            * Moves a compressed iterator to position target. Lists can
+            * only be decoded forward, so moving backwards restarts from
+            * the beginning of the list.
+            */
+           void seek(size_t target) {
+             if (target < index) restart();
+             while (index < target && index < degree) {
+               if (++index < degree) next();
              }
            }
          private:
@@ -686,15 +929,25 @@ namespace graphlab {
                                  val.template get<0>(),
                                  val.template get<1>());
               }
+              case CSR_COMPRESSED:
+                return edge_type(lgraph_ref, vid, cursor.id, base_eid + index);
+              case CSC_COMPRESSED:
+                return edge_type(lgraph_ref, cursor.id, vid,
+                                 lgraph_ref._compressed_csr.begin_index(cursor.id)
+                                 + cursor.aux);
               default: return edge_type(lgraph_ref, -1, -1, -1);
              }
            }
-           enum list_type {CSR, CSC}; 
            local_graph& lgraph_ref;
            const list_type _type;
            csc_edge_iterator csc_iter;
            csr_edge_iterator csr_iter;
            const lvid_type vid;
+           // state of a compressed list
+           compressed_cursor cursor;
+           size_t index;
+           size_t degree;
+           edge_id_type base_eid;
         }; // end of edge_iterator
 
 
@@ -711,6 +964,11 @@ namespace graphlab {
     csc_type _csc_storage;
     std::vector<EdgeData> edges;
 
+    /** The edge relationships when the graph is compressed. The plain
+        CSR/CSC storage is empty in this case. */
+    compressed_csr_type _compressed_csr;
+    compressed_csc_type _compressed_csc;
+
     /** The edge data is a vector of edges where each edge stores its
         source, destination, and data. Used for temporary storage. The
         data is transferred into CSR+CSC representation in
@@ -722,6 +980,9 @@ namespace graphlab {
         performance. */
     bool finalized;
 
+    /** Whether the edge relationships are stored compressed. */
+    bool compressed;
+
 
     /**************************************************************************/
     /*                                                                        */
@@ -729,6 +990,7 @@ namespace graphlab {
     /*                                                                        */
     /**************************************************************************/
     friend class local_graph_test; 
+    friend class edge_iterator;
   }; // End of class local_graph
 
 
@@ -0,0 +1,142 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+/**
+ * \file vertex_ordering.hpp
+ *
+ * Computes cache friendly orders of the local vertex ids from a list of
+ * edges. The orders are applied by the local graphs before
+ * finalization, see local_graph::reorder_vertices().
+ */
+
+#ifndef GRAPHLAB_VERTEX_ORDERING_HPP
+#define GRAPHLAB_VERTEX_ORDERING_HPP
+
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include <graphlab/graph/graph_basic_types.hpp>
+#include <graphlab/logger/assertions.hpp>
+
+namespace graphlab {
+
+  /// The vertex orders supported by compute_vertex_order()
+  enum vertex_order_type {
+    /// Keep the ids in the order the vertices were first seen
+    VERTEX_ORDER_NONE,
+    /// Sort by decreasing degree so that the hubs share cache lines
+    VERTEX_ORDER_DEGREE,
+    /**
+     * Breadth first search order (Cuthill-McKee without the degree
+     * sorted neighbor lists) from the highest degree vertex of every
+     * connected component, so neighbors get nearby ids.
+     */
+    VERTEX_ORDER_BFS
+  };
+
+  /**
+   * Parses "none", "degree" or "bfs" into order. Returns false if the
+   * string is not one of them.
+   */
+  inline bool parse_vertex_order(const std::string& str,
+                                 vertex_order_type& order) {
+    if (str == "none") order = VERTEX_ORDER_NONE;
+    else if (str == "degree") order = VERTEX_ORDER_DEGREE;
+    else if (str == "bfs") order = VERTEX_ORDER_BFS;
+    else return false;
+    return true;
+  }
+
+  /**
+   * Computes a vertex order for the graph with nverts vertices and the
+   * edges (source[i], target[i]), ignoring edge directions.
+   *
+   * \param [out] new_lvid new_lvid[v] is the new id of vertex v. It is
+   *                       a permutation of 0 to nverts-1.
+   */
+  inline void compute_vertex_order(vertex_order_type order, size_t nverts,
+                                   const std::vector<lvid_type>& source,
+                                   const std::vector<lvid_type>& target,
+                                   std::vector<lvid_type>& new_lvid) {
+    ASSERT_EQ(source.size(), target.size());
+    new_lvid.resize(nverts);
+    if (order == VERTEX_ORDER_NONE) {
+      for (size_t i = 0; i < nverts; ++i) new_lvid[i] = i;
+      return;
+    }
+    // vertices by decreasing degree, ties in the original order
+    std::vector<size_t> degree(nverts, 0);
+    for (size_t i = 0; i < source.size(); ++i) {
+      ++degree[source[i]]; ++degree[target[i]];
+    }
+    size_t maxdegree = 0;
+    for (size_t i = 0; i < nverts; ++i) maxdegree = std::max(maxdegree, degree[i]);
+    std::vector<size_t> bucket(maxdegree + 2, 0);
+    for (size_t i = 0; i < nverts; ++i) ++bucket[maxdegree - degree[i] + 1];
+    for (size_t i = 1; i < bucket.size(); ++i) bucket[i] += bucket[i - 1];
+    std::vector<lvid_type> by_degree(nverts);
+    for (size_t i = 0; i < nverts; ++i) {
+      by_degree[bucket[maxdegree - degree[i]]++] = i;
+    }
+    if (order == VERTEX_ORDER_DEGREE) {
+      for (size_t i = 0; i < nverts; ++i) new_lvid[by_degree[i]] = i;
+      return;
+    }
+
+    // undirected adjacency lists in csr form
+    std::vector<size_t> index(nverts + 1, 0);
+    for (size_t i = 0; i < nverts; ++i) index[i + 1] = index[i] + degree[i];
+    std::vector<lvid_type> adj(index[nverts]);
+    std::vector<size_t> fill(index.begin(), index.end() - 1);
+    for (size_t i = 0; i < source.size(); ++i) {
+      adj[fill[source[i]]++] = target[i];
+      adj[fill[target[i]]++] = source[i];
+    }
+    std::vector<size_t>().swap(fill);
+    std::vector<size_t>().swap(degree);
+
+    // the queue of the search is the new order itself
+    const lvid_type unvisited = lvid_type(-1);
+    std::vector<lvid_type> visit_order;
+    visit_order.reserve(nverts);
+    for (size_t i = 0; i < nverts; ++i) new_lvid[i] = unvisited;
+    for (size_t i = 0; i < nverts; ++i) {
+      const lvid_type root = by_degree[i];
+      if (new_lvid[root] != unvisited) continue;
+      new_lvid[root] = visit_order.size();
+      visit_order.push_back(root);
+      for (size_t head = new_lvid[root]; head < visit_order.size(); ++head) {
+        const lvid_type v = visit_order[head];
+        for (size_t j = index[v]; j < index[v + 1]; ++j) {
+          if (new_lvid[adj[j]] == unvisited) {
+            new_lvid[adj[j]] = visit_order.size();
+            visit_order.push_back(adj[j]);
+          }
+        }
+      }
+    }
+    ASSERT_EQ(visit_order.size(), nverts);
+  } // end of compute_vertex_order
+
+} // end of namespace graphlab
+#endif
@@ -24,6 +24,7 @@
 #include <boost/bind.hpp>
 #include <graphlab/util/random.hpp>
 #include <graphlab/parallel/fiber_control.hpp>
+#include <graphlab/parallel/numa_tools.hpp>
 #include <graphlab/logger/assertions.hpp>
 #include <graphlab/rpc/dc.hpp>
 #include <graphlab/macros_def.hpp>
@@ -116,12 +117,17 @@ fiber_control::fiber* fiber_control::get_active_fiber() {
 void fiber_control::active_queue_insert_tail(size_t workerid, fiber_control::fiber* value) {
   if (value->scheduleable) {
 //     printf("%ld: Scheduling %ld on %ld\n", get_worker_id(), value->id, workerid);
+    // value may be run and destroyed by another worker once enqueued
+    const bool stealable = value->affinity_array.size() > 1;
+    const affinity_type affinity = value->affinity;
     schedule[workerid].affinity_queue->enqueue(value);
     ++schedule[workerid].nwaiting;
     if (schedule[workerid].waiting) {
       schedule[workerid].active_lock.lock();
       schedule[workerid].active_cond.signal();
       schedule[workerid].active_lock.unlock();
+    } else if (stealable) {
+      wake_idle_worker(workerid, affinity);
     }
   }
 }
@@ -130,12 +136,17 @@ void fiber_control::active_queue_insert_tail(size_t workerid, fiber_control::fib
 void fiber_control::active_queue_insert_head(size_t workerid, fiber_control::fiber* value) {
   if (value->scheduleable) {
 //     printf("%ld: Scheduling %ld on %ld\n", get_worker_id(), value->id, workerid);
+    // value may be run and destroyed by another worker once enqueued
+    const bool stealable = value->affinity_array.size() > 1;
+    const affinity_type affinity = value->affinity;
     schedule[workerid].priority_queue->enqueue(value);
     ++schedule[workerid].nwaiting;
     if (schedule[workerid].waiting) {
       schedule[workerid].active_lock.lock();
       schedule[workerid].active_cond.signal();
       schedule[workerid].active_lock.unlock();
+    } else if (stealable) {
+      wake_idle_worker(workerid, affinity);
     }
   }
 }
@@ -163,19 +174,80 @@ fiber_control::fiber* fiber_control::try_pop_queue(inplace_lf_queue2<fiber>& lfq
   return ret;
 }
 
+fiber_control::fiber* fiber_control::try_steal_queue(inplace_lf_queue2<fiber>& lfqueue,
+                                                     fiber*& popped_queue,
+                                                     size_t workerid) {
+  if (popped_queue == NULL) {
+    popped_queue = lfqueue.dequeue_all();
+  }
+  // only the head is considered so that the queue order is kept
+  if (popped_queue != NULL && popped_queue->affinity.get(workerid)) {
+    return try_pop_queue(lfqueue, popped_queue);
+  }
+  return NULL;
+}
+
 fiber_control::fiber* fiber_control::active_queue_remove(size_t workerid) {
   fiber_control::fiber* ret = NULL;
   thread_schedule& curts = schedule[workerid];
+  curts.pop_lock.lock();
   ret = try_pop_queue(*curts.priority_queue, curts.popped_priority_queue);
   if (ret == NULL) {
     ret = try_pop_queue(*curts.affinity_queue , curts.popped_affinity_queue);
   }
+  curts.pop_lock.unlock();
   if (ret) {
     // printf("%ld: Running %ld\n", get_worker_id(), ret->id);
   }
   return ret;
 }
 
+fiber_control::fiber* fiber_control::active_queue_steal(size_t workerid) {
+  if (nworkers <= 1) return NULL;
+  // start at a random victim so that thieves spread out
+  const size_t start = graphlab::random::fast_uniform<size_t>(0, nworkers - 1);
+  for (size_t i = 0;i < nworkers; ++i) {
+    const size_t victimid = (start + i) % nworkers;
+    if (victimid == workerid) continue;
+    thread_schedule& victim = schedule[victimid];
+    // a victim in its scheduling loop is about to run its queue itself.
+    // Only take the backlog of workers busy running a fiber.
+    if (victim.waiting) continue;
+    if (victim.popped_priority_queue == NULL && victim.priority_queue->empty() &&
+        victim.popped_affinity_queue == NULL && victim.affinity_queue->empty()) {
+      continue;
+    }
+    // never wait for a worker which is popping its own queues
+    if (!victim.pop_lock.try_lock()) continue;
+    // priority fibers first, as the victim itself would
+    fiber* ret = try_steal_queue(*victim.priority_queue,
+                                 victim.popped_priority_queue, workerid);
+    if (ret == NULL) {
+      ret = try_steal_queue(*victim.affinity_queue,
+                            victim.popped_affinity_queue, workerid);
+    }
+    victim.pop_lock.unlock();
+    if (ret != NULL) {
+      ++schedule[workerid].nsteals;
+      return ret;
+    }
+  }
+  return NULL;
+}
+
+void fiber_control::wake_idle_worker(size_t workerid,
+                                     const affinity_type& affinity) {
+  for (size_t i = 1;i < nworkers; ++i) {
+    const size_t idleid = (workerid + i) % nworkers;
+    if (schedule[idleid].waiting && affinity.get(idleid)) {
+      schedule[idleid].active_lock.lock();
+      schedule[idleid].active_cond.signal();
+      schedule[idleid].active_lock.unlock();
+      return;
+    }
+  }
+}
+
 void fiber_control::exit() {
   distributed_control* dc = distributed_control::get_instance();
   if (dc) dc->flush();
@@ -201,6 +273,8 @@ void fiber_control::worker_init(size_t workerid) {
    * But, when the worker has no other fiber to run, it will return to this
    * stack and and wait in a condition variable
    */
+  // keep neighboring workers on the same socket if pinning is enabled
+  numa::pin_worker(affinity_base + workerid, nworkers);
   // create a root context
   create_tls_ptr();
   // set up the tls structure
@@ -216,6 +290,7 @@ void fiber_control::worker_init(size_t workerid) {
   while(!stop_workers) {
     // get a fiber to run
     fiber* next_fib = t->parent->active_queue_remove(workerid);
+    if (next_fib == NULL) next_fib = t->parent->active_queue_steal(workerid);
     if (next_fib != NULL) {
       // if there is a fiber. yield to it
       schedule[workerid].active_lock.unlock();
@@ -233,6 +308,7 @@ void fiber_control::worker_init(size_t workerid) {
       schedule[workerid].active_lock.lock();
     } else {
       // if there is no fiber. wait.
+      ++schedule[workerid].nidle;
       schedule[workerid].active_cond.wait(schedule[workerid].active_lock);
     }
   }
@@ -269,10 +345,16 @@ size_t fiber_control::launch(boost::function<void(void)> fn,
   // make sure there is always a worker I can work on
   ASSERT_LT(b, nworkers);
 
-  // allocate a stack
+  // allocate a stack from the pool of this worker. Stacks go back to
+  // the pool they came from, so that pools of workers which launch
+  // more fibers than they run do not run dry.
   fiber* fib = new fiber;
   fib->parent = this;
-  fib->stack = malloc(stacksize);
+  fib->stack_pool = get_worker_id();
+  if (fib->stack_pool >= nworkers) fib->stack_pool = b;
+  fib->stack = schedule[fib->stack_pool].stack_pool.allocate(stacksize,
+                                                             fib->stack_mapped);
+  fib->stacksize = stacksize;
   fib->id = fiber_id_counter.inc();
   foreach(size_t b, affinity) {
     if (b < nworkers) fib->affinity_array.push_back((unsigned char)b);
@@ -404,7 +486,8 @@ void fiber_control::reschedule_fiber(size_t workerid, fiber* fib) {
   } else if (fib->terminate) {
     fib->lock.unlock();
     // previous fiber is dead. destroy it
-    free(fib->stack);
+    schedule[fib->stack_pool].stack_pool.release(fib->stack, fib->stacksize,
+                                                 fib->stack_mapped);
     //VALGRIND_STACK_DEREGISTER(fib->stack);
     // delete the fiber local storage if any
     if (fib->fls && flsdeleter) flsdeleter(fib->fls);
@@ -486,6 +569,18 @@ bool fiber_control::worker_has_fibers_on_queue() {
           !parentgroup->schedule[workerid].affinity_queue->empty();
 }
 
+size_t fiber_control::total_steals() {
+  size_t ret = 0;
+  for (size_t i = 0;i < nworkers; ++i) ret += schedule[i].nsteals;
+  return ret;
+}
+
+size_t fiber_control::total_idle_waits() {
+  size_t ret = 0;
+  for (size_t i = 0;i < nworkers; ++i) ret += schedule[i].nidle;
+  return ret;
+}
+
 size_t fiber_control::get_worker_id() {
   fiber_control::tls* tls = get_tls_ptr();
   if (tls != NULL) return tls->workerid;
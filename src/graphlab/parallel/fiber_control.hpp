@@ -33,6 +33,7 @@
 #include <graphlab/util/inplace_lf_queue2.hpp>
 #include <graphlab/parallel/pthread_tools.hpp>
 #include <graphlab/parallel/atomic.hpp>
+#include <graphlab/parallel/fiber_stack_pool.hpp>
 namespace graphlab {
 
 /**
@@ -49,6 +50,9 @@ class fiber_control {
     fiber_control* parent;
     boost::context::fcontext_t* context;
     void* stack;
+    size_t stacksize;
+    size_t stack_pool; // the worker whose stack pool the stack is from
+    bool stack_mapped; // false if the stack pool fell back to malloc
     size_t id;
     affinity_type affinity;
     std::vector<unsigned char> affinity_array;
@@ -89,7 +93,7 @@ class fiber_control {
 
   // The scheduler is a simple queue. One for each worker
   struct thread_schedule {
-    thread_schedule():waiting(false) { }
+    thread_schedule():waiting(false), nsteals(0), nidle(0) { }
     mutex active_lock;
     conditional active_cond;
     volatile bool waiting;
@@ -100,6 +104,17 @@ class fiber_control {
 
     inplace_lf_queue2<fiber>* priority_queue;
     fiber* popped_priority_queue;
+
+    // stacks for the fibers launched from this worker
+    fiber_stack_pool stack_pool;
+
+    // Serializes the consumers of the two queues above: the worker
+    // itself and idle workers stealing from it.
+    simple_spinlock pop_lock;
+    // the number of fibers this worker stole from other workers
+    size_t nsteals;
+    // the number of times this worker found nothing to run and slept
+    size_t nidle;
   };
   std::vector<thread_schedule> schedule;
 
@@ -111,6 +126,10 @@ class fiber_control {
   void active_queue_insert_tail(size_t workerid, fiber* value);
   void active_queue_insert_tail(fiber* value);
   fiber* active_queue_remove(size_t workerid);
+  /// Takes a fiber which may run on workerid from another worker's queues
+  fiber* active_queue_steal(size_t workerid);
+  /// Wakes up a sleeping worker other than workerid allowed by affinity
+  void wake_idle_worker(size_t workerid, const affinity_type& affinity);
 
   // a thread local storage for the worker to point to a fiber
   static bool tls_created;
@@ -135,6 +154,9 @@ class fiber_control {
 
   /// Gets a fiber from the lock-free / popped pair
   fiber* try_pop_queue(inplace_lf_queue2<fiber>& lfqueue, fiber*& popped_queue);
+  /// Gets the next fiber from the lock-free / popped pair if it may run on workerid
+  fiber* try_steal_queue(inplace_lf_queue2<fiber>& lfqueue, fiber*& popped_queue,
+                         size_t workerid);
   /// The function that each worker thread starts off running
   void worker_init(size_t workerid);
 
@@ -191,6 +213,20 @@ class fiber_control {
   inline size_t total_threads_created() {
     return fiber_id_counter.value;
   }
+
+  /**
+   * Returns the total number of fibers which idle workers took from the
+   * queues of other workers. Only fibers whose affinity allows more
+   * than one worker can be stolen.
+   */
+  size_t total_steals();
+
+  /**
+   * Returns the total number of times a worker found no fiber to run,
+   * neither on its own queues nor on those of the other workers, and
+   * went to sleep.
+   */
+  size_t total_idle_waits();
   /**
    * Sets the TLS deletion function. The deletion function will be called
    * on every non-NULL TLS value.
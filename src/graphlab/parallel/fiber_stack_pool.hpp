@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+
+#ifndef GRAPHLAB_FIBER_STACK_POOL_HPP
+#define GRAPHLAB_FIBER_STACK_POOL_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <utility>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/parallel/atomic.hpp>
+#include <graphlab/logger/assertions.hpp>
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+namespace graphlab {
+
+/**
+ * A cache of fiber stacks. Every stack is a separate mmap'd region with
+ * a PROT_NONE guard page below it, so a fiber overflowing its stack
+ * faults instead of silently corrupting the heap. Physical memory is
+ * only committed for the pages a fiber actually touches.
+ *
+ * Released stacks are kept (up to max_cached of them) and handed out
+ * again most recently used first, so that launching and destroying
+ * fibers at a high rate neither calls the allocator nor the kernel.
+ * Of a cached stack larger than TRIM_BYTES only the top TRIM_BYTES
+ * (where a stack starts growing) stay committed.
+ */
+class fiber_stack_pool {
+ public:
+  /// Cached stacks keep at most this many bytes of physical memory
+  static const size_t TRIM_BYTES = 65536;
+
+  explicit fiber_stack_pool(size_t max_cached = 256)
+      : max_cached(max_cached), ncached(0) { }
+
+  /// Copies only the cache size, so pools can be held in a std::vector
+  fiber_stack_pool(const fiber_stack_pool& other)
+      : max_cached(other.max_cached), ncached(0) { }
+
+  ~fiber_stack_pool() {
+    for (size_t i = 0; i < free_stacks.size(); ++i) {
+      for (size_t j = 0; j < free_stacks[i].second.size(); ++j) {
+        unmap(free_stacks[i].second[j], free_stacks[i].first);
+      }
+    }
+  }
+
+  /**
+   * Returns the lowest address of a stack of at least stacksize
+   * bytes. Every guarded stack costs the process two memory maps, so
+   * at most an eighth of vm.max_map_count stacks are mapped at a time,
+   * leaving the rest for the allocator. Beyond that, as with hundreds
+   * of thousands of live fibers, the stack is malloc'd and mapped is
+   * set to false. The stack must be returned with release() with the
+   * same stacksize and mapped flag.
+   */
+  void* allocate(size_t stacksize, bool& mapped) {
+    const size_t size = round_to_pages(stacksize);
+    lock.lock();
+    std::vector<void*>& stacks = stacks_of_size(size);
+    if (!stacks.empty()) {
+      void* stack = stacks.back();
+      stacks.pop_back();
+      --ncached;
+      lock.unlock();
+      mapped = true;
+      return stack;
+    }
+    lock.unlock();
+    mapped = false;
+    if (num_mapped().inc() <= max_mapped()) {
+      const size_t guard = page_size();
+      char* region = (char*)mmap(NULL, guard + size, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                                 -1, 0);
+      // the stack grows downwards into the guard page
+      if (region != MAP_FAILED && mprotect(region, guard, PROT_NONE) == 0) {
+        mapped = true;
+        return region + guard;
+      }
+      if (region != MAP_FAILED) munmap(region, guard + size);
+    }
+    num_mapped().dec();
+    return malloc(stacksize);
+  }
+
+  /// Returns a stack obtained from allocate()
+  void release(void* stack, size_t stacksize, bool mapped) {
+    if (!mapped) {
+      free(stack);
+      return;
+    }
+    const size_t size = round_to_pages(stacksize);
+    if (size > TRIM_BYTES) {
+      madvise(stack, size - TRIM_BYTES, MADV_DONTNEED);
+    }
+    lock.lock();
+    if (ncached < max_cached) {
+      stacks_of_size(size).push_back(stack);
+      ++ncached;
+      stack = NULL;
+    }
+    lock.unlock();
+    if (stack != NULL) unmap(stack, size);
+  }
+
+  /// The number of stacks held for reuse
+  size_t num_cached() const {
+    return ncached;
+  }
+
+ private:
+  simple_spinlock lock;
+  size_t max_cached;
+  size_t ncached;
+  /// the free stacks of every stack size. There are usually only a few sizes
+  std::vector<std::pair<size_t, std::vector<void*> > > free_stacks;
+
+  static size_t page_size() {
+    static const size_t size = sysconf(_SC_PAGESIZE);
+    return size;
+  }
+
+  static size_t round_to_pages(size_t bytes) {
+    const size_t page = page_size();
+    return (bytes + page - 1) / page * page;
+  }
+
+  static void unmap(void* stack, size_t size) {
+    munmap((char*)stack - page_size(), size + page_size());
+    num_mapped().dec();
+  }
+
+  /// The number of mapped stacks of all pools
+  static atomic<size_t>& num_mapped() {
+    static atomic<size_t> count;
+    return count;
+  }
+
+  static size_t max_mapped() {
+    static size_t limit = 0;
+    if (limit == 0) {
+      size_t max_map_count = 65530;
+      FILE* f = fopen("/proc/sys/vm/max_map_count", "r");
+      if (f != NULL) {
+        unsigned long val = 0;
+        if (fscanf(f, "%lu", &val) == 1 && val > 0) max_map_count = val;
+        fclose(f);
+      }
+      limit = max_map_count / 8;
+    }
+    return limit;
+  }
+
+  std::vector<void*>& stacks_of_size(size_t size) {
+    for (size_t i = 0; i < free_stacks.size(); ++i) {
+      if (free_stacks[i].first == size) return free_stacks[i].second;
+    }
+    free_stacks.push_back(std::make_pair(size, std::vector<void*>()));
+    return free_stacks.back().second;
+  }
+}; // end of fiber_stack_pool
+
+} // end of namespace graphlab
+#endif
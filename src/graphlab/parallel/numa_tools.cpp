@@ -0,0 +1,163 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <algorithm>
+#ifdef __linux__
+#include <sched.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+#include <graphlab/parallel/numa_tools.hpp>
+#include <graphlab/logger/assertions.hpp>
+
+namespace graphlab {
+  namespace numa {
+
+    namespace {
+      /// The allowed cpus grouped by node and the number of nodes
+      struct topology {
+        std::vector<size_t> cpus;
+        std::vector<size_t> nodes;
+
+        topology() {
+#ifdef __linux__
+          const char* env = getenv("GRAPHLAB_NUMA");
+          if (env != NULL && atoi(env) == 0) return;
+          cpu_set_t allowed;
+          CPU_ZERO(&allowed);
+          if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+          // node of every allowed cpu from its nodeN entry in sysfs
+          std::map<size_t, std::vector<size_t> > node_cpus;
+          for (size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (!CPU_ISSET(cpu, &allowed)) continue;
+            char path[64];
+            sprintf(path, "/sys/devices/system/cpu/cpu%d", int(cpu));
+            DIR* dir = opendir(path);
+            if (dir == NULL) return;
+            long node = -1;
+            for (struct dirent* ent = readdir(dir); ent != NULL;
+                 ent = readdir(dir)) {
+              if (strncmp(ent->d_name, "node", 4) == 0) {
+                node = strtol(ent->d_name + 4, NULL, 10);
+                break;
+              }
+            }
+            closedir(dir);
+            if (node < 0) return;
+            node_cpus[node].push_back(cpu);
+          }
+          std::map<size_t, std::vector<size_t> >::const_iterator it;
+          for (it = node_cpus.begin(); it != node_cpus.end(); ++it) {
+            nodes.push_back(it->first);
+            cpus.insert(cpus.end(), it->second.begin(), it->second.end());
+          }
+          if (nodes.size() > 1) {
+            logstream(LOG_INFO) << "NUMA placement across " << nodes.size()
+                                << " nodes" << std::endl;
+          }
+#endif
+        }
+      };
+
+      const topology& get_topology() {
+        static topology topo;
+        return topo;
+      }
+
+      /// The rank of this process among the processes on its machine
+      size_t local_rank() {
+        const char* vars[] = {"OMPI_COMM_WORLD_LOCAL_RANK",
+                              "MV2_COMM_WORLD_LOCAL_RANK",
+                              "MPI_LOCALRANKID", "SLURM_LOCALID"};
+        for (size_t i = 0; i < sizeof(vars) / sizeof(vars[0]); ++i) {
+          const char* env = getenv(vars[i]);
+          if (env != NULL) return std::max(0, atoi(env));
+        }
+        return 0;
+      }
+    } // end of anonymous namespace
+
+
+    size_t num_nodes() {
+      return std::max<size_t>(1, get_topology().nodes.size());
+    } // end of num_nodes
+
+
+    const std::vector<size_t>& node_ordered_cpus() {
+      return get_topology().cpus;
+    } // end of node_ordered_cpus
+
+
+    void pin_worker(size_t i, size_t nworkers) {
+#ifdef __linux__
+      const char* env = getenv("GRAPHLAB_PIN_WORKERS");
+      if (env == NULL || atoi(env) == 0) return;
+      if (num_nodes() <= 1) return;
+      const std::vector<size_t>& cpus = node_ordered_cpus();
+      // leave the cpus of the other processes on this machine alone
+      static const size_t offset = local_rank();
+      cpu_set_t cpu_set;
+      CPU_ZERO(&cpu_set);
+      CPU_SET(cpus[(offset * nworkers + i) % cpus.size()], &cpu_set);
+      if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+        logstream(LOG_WARNING) << "Unable to pin worker " << i << std::endl;
+      }
+#endif
+    } // end of pin_worker
+
+
+    void interleave_memory(void* ptr, size_t len) {
+#if defined(__linux__) && defined(SYS_mbind)
+      if (num_nodes() <= 1) return;
+      // from numaif.h, which is part of libnuma
+      const int MPOL_INTERLEAVE_MODE = 3;
+      const unsigned MPOL_MF_MOVE_FLAG = 1 << 1;
+      const size_t MASK_BITS = 1024;
+      const size_t WORD_BITS = 8 * sizeof(unsigned long);
+      unsigned long nodemask[MASK_BITS / WORD_BITS];
+      memset(nodemask, 0, sizeof(nodemask));
+      const std::vector<size_t>& nodes = get_topology().nodes;
+      for (size_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i] < MASK_BITS) {
+          nodemask[nodes[i] / WORD_BITS] |= 1UL << (nodes[i] % WORD_BITS);
+        }
+      }
+      const size_t pagesize = sysconf(_SC_PAGESIZE);
+      const size_t begin = ((size_t)ptr + pagesize - 1) / pagesize * pagesize;
+      const size_t end = ((size_t)ptr + len) / pagesize * pagesize;
+      if (begin >= end) return;
+      // the kernel reads maxnode - 1 bits of the mask
+      if (syscall(SYS_mbind, begin, end - begin, MPOL_INTERLEAVE_MODE,
+                  nodemask, MASK_BITS + 1, MPOL_MF_MOVE_FLAG) != 0) {
+        logstream(LOG_WARNING) << "Unable to interleave " << end - begin
+                               << " bytes across NUMA nodes" << std::endl;
+      }
+#endif
+    } // end of interleave_memory
+
+  } // end of namespace numa
+} // end of namespace graphlab
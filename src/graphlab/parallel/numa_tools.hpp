@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+#ifndef GRAPHLAB_NUMA_TOOLS_HPP
+#define GRAPHLAB_NUMA_TOOLS_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace graphlab {
+  /**
+   * \internal \brief Placement of threads and memory on machines with
+   * several NUMA nodes (sockets).
+   *
+   * Only the nodes holding cpus this process may run on are used, so
+   * a process bound to a single socket (e.g. with numactl) is left
+   * alone. Everything is a no-op when there is only one such node, when
+   * the topology cannot be read (non linux systems), or when the
+   * environment variable GRAPHLAB_NUMA is set to 0.
+   */
+  namespace numa {
+
+    /**
+     * \internal
+     * \brief Returns the number of NUMA nodes with cpus this process
+     * may run on. Returns 1 if placement is disabled.
+     */
+    size_t num_nodes();
+
+    /**
+     * \internal
+     * \brief Returns the cpus this process may run on, ordered by NUMA
+     * node, so that consecutive entries share a socket.
+     */
+    const std::vector<size_t>& node_ordered_cpus();
+
+    /**
+     * \internal
+     * \brief Pins worker number i of a thread pool of nworkers threads
+     * to a single cpu, so that neighboring workers share a socket.
+     *
+     * Pinning is opt-in: it only happens if the environment variable
+     * GRAPHLAB_PIN_WORKERS is set to a nonzero value, and does nothing
+     * if num_nodes() is 1. Processes sharing a machine are told apart by
+     * the local rank the MPI launcher exports (OMPI_COMM_WORLD_LOCAL_RANK,
+     * MV2_COMM_WORLD_LOCAL_RANK, MPI_LOCALRANKID or SLURM_LOCALID), and
+     * process r pins its workers to
+     * node_ordered_cpus()[(r * nworkers + i) % ncpus].
+     */
+    void pin_worker(size_t i, size_t nworkers);
+
+    /**
+     * \internal
+     * \brief Interleaves the pages of [ptr, ptr + len) round robin
+     * across the NUMA nodes, migrating pages which were already touched.
+     * Only whole pages inside the range are affected. Does nothing if
+     * num_nodes() is 1.
+     */
+    void interleave_memory(void* ptr, size_t len);
+
+    /**
+     * \internal
+     * \brief Interleaves the storage of a vector. See interleave_memory().
+     */
+    template <typename T>
+    void interleave_vector(std::vector<T>& vec) {
+      if (!vec.empty()) interleave_memory(&vec[0], vec.size() * sizeof(T));
+    }
+
+  } // end of namespace numa
+} // end of namespace graphlab
+
+#endif
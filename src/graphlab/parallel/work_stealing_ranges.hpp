@@ -0,0 +1,155 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+
+#ifndef GRAPHLAB_PARALLEL_WORK_STEALING_RANGES_HPP
+#define GRAPHLAB_PARALLEL_WORK_STEALING_RANGES_HPP
+
+#include <vector>
+#include <stdint.h>
+#include <graphlab/parallel/atomic.hpp>
+#include <graphlab/parallel/atomic_ops.hpp>
+#include <graphlab/parallel/cache_line_pad.hpp>
+#include <graphlab/logger/assertions.hpp>
+
+namespace graphlab {
+
+  /**
+   * \ingroup util
+   * Distributes the chunks of an iteration space [0, n) between a fixed
+   * number of threads. The chunk boundaries are chosen by the caller,
+   * typically so that every chunk holds about the same amount of work.
+   *
+   * Every thread starts with a contiguous share of the chunks and takes
+   * them from the front. A thread which runs out steals the back half of
+   * the remaining chunks of another thread. The remaining range of each
+   * thread is packed into a single word and updated with compare and
+   * swap, so neither taking nor stealing a chunk locks.
+   *
+   * \code
+   * // single threaded
+   * ranges.reset(nthreads, bounds);
+   * // in every thread
+   * size_t begin, end;
+   * while (ranges.next(thread_id, begin, end)) { ... }
+   * \endcode
+   */
+  class work_stealing_ranges {
+   public:
+    work_stealing_ranges() { }
+
+    /**
+     * Starts a new iteration over the chunks [bounds[i], bounds[i+1]).
+     * bounds must be non decreasing with at most 2^32 chunks and is
+     * swapped out. Must not be called while threads take chunks.
+     */
+    void reset(size_t nthreads, std::vector<size_t>& bounds) {
+      ASSERT_GT(nthreads, 0);
+      ASSERT_GE(bounds.size(), 1);
+      chunk_bounds.swap(bounds);
+      const size_t nchunks = chunk_bounds.size() - 1;
+      ASSERT_LT(nchunks, size_t(1) << 32);
+      ranges.resize(nthreads);
+      for (size_t i = 0; i < nthreads; ++i) {
+        ranges[i].value.value = pack(i * nchunks / nthreads,
+                                     (i + 1) * nchunks / nthreads);
+      }
+      nsteals = 0;
+    }
+
+    /**
+     * Claims the next chunk [begin, end) for thread thread_id, stealing
+     * from the other threads once its own share is done. Returns false
+     * when no chunks are left.
+     */
+    bool next(size_t thread_id, size_t& begin, size_t& end) {
+      size_t chunk = 0;
+      if (!take(thread_id, chunk) && !steal(thread_id, chunk)) return false;
+      begin = chunk_bounds[chunk];
+      end = chunk_bounds[chunk + 1];
+      return true;
+    }
+
+    /// The number of chunks in the current iteration
+    size_t num_chunks() const {
+      return chunk_bounds.empty() ? 0 : chunk_bounds.size() - 1;
+    }
+
+    /// The number of successful steals since the last reset()
+    size_t num_steals() const { return nsteals.value; }
+
+   private:
+    static inline uint64_t pack(size_t first, size_t last) {
+      return (uint64_t(first) << 32) | uint64_t(last);
+    }
+
+    /// Takes the first chunk of the own range of thread_id
+    bool take(size_t thread_id, size_t& chunk) {
+      volatile uint64_t& range = ranges[thread_id].value.value;
+      while (1) {
+        const uint64_t cur = range;
+        const size_t first = cur >> 32, last = cur & 0xFFFFFFFF;
+        if (first >= last) return false;
+        if (atomic_compare_and_swap(range, cur, pack(first + 1, last))) {
+          chunk = first;
+          return true;
+        }
+      }
+    }
+
+    /**
+     * Takes the back half of the range of the next thread which has
+     * chunks left. The first stolen chunk is returned, the rest becomes
+     * the own range of thread_id. When the fiber workers are pinned in
+     * socket order (see numa::pin_worker()), the first victims tried
+     * usually run on the same socket.
+     */
+    bool steal(size_t thread_id, size_t& chunk) {
+      const size_t nthreads = ranges.size();
+      for (size_t i = 1; i < nthreads; ++i) {
+        volatile uint64_t& victim = ranges[(thread_id + i) % nthreads].value.value;
+        while (1) {
+          const uint64_t cur = victim;
+          const size_t first = cur >> 32, last = cur & 0xFFFFFFFF;
+          if (first >= last) break;
+          const size_t mid = first + (last - first) / 2;
+          if (atomic_compare_and_swap(victim, cur, pack(first, mid))) {
+            // nobody else writes the own range while it is empty
+            chunk = mid;
+            ranges[thread_id].value.value = pack(mid + 1, last);
+            nsteals.inc();
+            return true;
+          }
+        }
+      }
+      return false;
+    }
+
+    std::vector<size_t> chunk_bounds;
+    /// the remaining chunks [first, last) of every thread as first << 32 | last
+    std::vector<cache_line_pad<atomic<uint64_t> > > ranges;
+    atomic<size_t> nsteals;
+  }; // end of work_stealing_ranges
+
+} // end of namespace graphlab
+
+#endif
@@ -158,7 +158,7 @@ namespace graphlab {
       (*(send_buffers[index].oarc)) << value;
       ++send_buffers[index].numinserts;
 
-      if(send_buffers[index].oarc->off >= max_buffer_size) {
+      if(send_buffers[index].oarc->size() >= max_buffer_size) {
         oarchive* prevarc = swap_buffer(index);
         send_locks[index].unlock();
         // complete the send
@@ -42,6 +42,7 @@
 
 #include <graphlab/rpc/dc.hpp>
 #include <graphlab/rpc/dc_tcp_comm.hpp>
+#include <graphlab/rpc/dc_shm_comm.hpp>
 //#include <graphlab/rpc/dc_sctp_comm.hpp>
 #include <graphlab/rpc/dc_buffered_stream_send2.hpp>
 #include <graphlab/rpc/dc_stream_receive.hpp>
@@ -113,6 +114,10 @@ unsigned char distributed_control::get_sequentialization_key() {
   return (unsigned char)oldval;
 }
 
+dc_send_class distributed_control::set_send_class(dc_send_class newclass) {
+  return dc_impl::set_send_class_thread_local_buffer(newclass);
+}
+
 
 distributed_control::distributed_control() {
   dc_init_param initparam;
@@ -170,6 +175,8 @@ distributed_control::~distributed_control() {
   logstream(LOG_INFO) << "Shutting down distributed control " << std::endl;
   FREE_CALLBACK_EVENT(EVENT_NETWORK_BYTES);
   FREE_CALLBACK_EVENT(EVENT_RPC_CALLS);
+  FREE_CALLBACK_EVENT(EVENT_COMPRESSION_IN);
+  FREE_CALLBACK_EVENT(EVENT_COMPRESSION_OUT);
   // call all deletion callbacks
   for (size_t i = 0; i < deletion_callbacks.size(); ++i) {
     deletion_callbacks[i]();
@@ -202,6 +209,11 @@ distributed_control::~distributed_control() {
   logstream(LOG_INFO) << "Bytes Sent: " << bytessent << std::endl;
   logstream(LOG_INFO) << "Calls Sent: " << calls_sent() << std::endl;
   logstream(LOG_INFO) << "Network Sent: " << network_bytes_sent() << std::endl;
+  if (comm->compression_bytes_in() > 0) {
+    logstream(LOG_INFO) << "Compressed " << comm->compression_bytes_in()
+                        << " bytes to " << comm->compression_bytes_out()
+                        << std::endl;
+  }
   logstream(LOG_INFO) << "Bytes Received: " << bytesreceived << std::endl;
   logstream(LOG_INFO) << "Calls Received: " << calls_received() << std::endl;
 
@@ -534,9 +546,32 @@ void distributed_control::init(const std::vector<std::string> &machines,
 
   // parse the initstring
   std::map<std::string,std::string> options = parse_options(initstring);
+  char* compress = getenv("GRAPHLAB_COMPRESS");
+  if (compress != NULL && options.count("compress") == 0) {
+    options["compress"] = compress;
+  }
+  flush_policies[LATENCY_SEND].max_bytes = LATENCY_SEND_MAX_BYTES;
+  flush_policies[LATENCY_SEND].max_delay = LATENCY_SEND_MAX_DELAY;
+  flush_policies[BULK_SEND].max_bytes = BULK_SEND_MAX_BYTES;
+  flush_policies[BULK_SEND].max_delay = BULK_SEND_MAX_DELAY;
+  if (options.count("latency_max_bytes")) {
+    flush_policies[LATENCY_SEND].max_bytes = atoi(options["latency_max_bytes"].c_str());
+  }
+  if (options.count("latency_max_delay")) {
+    flush_policies[LATENCY_SEND].max_delay = atoi(options["latency_max_delay"].c_str());
+  }
+  if (options.count("bulk_max_bytes")) {
+    flush_policies[BULK_SEND].max_bytes = atoi(options["bulk_max_bytes"].c_str());
+  }
+  if (options.count("bulk_max_delay")) {
+    flush_policies[BULK_SEND].max_delay = atoi(options["bulk_max_delay"].c_str());
+  }
 
+  if (commtype == AUTO_COMM) commtype = select_comm_type(machines);
   if (commtype == TCP_COMM) {
     comm = new dc_impl::dc_tcp_comm();
+  } else if (commtype == SHM_COMM) {
+    comm = new dc_impl::dc_shm_comm();
   } else {
     ASSERT_MSG(false, "Unexpected value for comm type");
   }
@@ -628,6 +663,10 @@ void distributed_control::init(const std::vector<std::string> &machines,
       "MB", boost::bind(&distributed_control::network_megabytes_sent, this));
   ADD_CUMULATIVE_CALLBACK_EVENT(EVENT_RPC_CALLS, "RPC Calls",
       "Calls", boost::bind(&distributed_control::calls_sent, this));
+  ADD_CUMULATIVE_CALLBACK_EVENT(EVENT_COMPRESSION_IN, "Compression Input",
+      "MB", boost::bind(&distributed_control::compression_megabytes_in, this));
+  ADD_CUMULATIVE_CALLBACK_EVENT(EVENT_COMPRESSION_OUT, "Compression Output",
+      "MB", boost::bind(&distributed_control::compression_megabytes_out, this));
 }
 
 
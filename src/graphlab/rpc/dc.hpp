@@ -92,7 +92,25 @@ struct dc_init_param{
   /** Additional construction options of the form
     "key1=value1,key2=value2".
 
-    There are no available options at this time.
+    \li \b compress=1 Compresses the data sent to other machines.
+                       Setting the GRAPHLAB_COMPRESS environment variable
+                       to 1 does the same.
+    \li \b latency_max_bytes=NUMBER Messages sent with the LATENCY_SEND
+                       class are flushed once this many bytes are
+                       buffered for a machine. Defaults to
+                       LATENCY_SEND_MAX_BYTES.
+    \li \b latency_max_delay=NUMBER Messages sent with the LATENCY_SEND
+                       class are flushed once the oldest buffered message
+                       is this many microseconds old. 0 flushes every
+                       message. Defaults to LATENCY_SEND_MAX_DELAY.
+    \li \b bulk_max_bytes=NUMBER As latency_max_bytes, for the
+                       BULK_SEND class. Defaults to BULK_SEND_MAX_BYTES.
+    \li \b bulk_max_delay=NUMBER As latency_max_delay, for the
+                       BULK_SEND class. Defaults to BULK_SEND_MAX_DELAY.
+
+    The delays are checked as messages are written, so a message which
+    is not followed by another one waits for at most SEND_POLL_TIMEOUT
+    microseconds.
 
     Internal options which should not be used
     \li \b __socket__=NUMBER Forces TCP comm to use this socket number for its
@@ -114,8 +132,8 @@ struct dc_init_param{
    * \param numhandlerthreads Optional Argument. The number of handler
    *                          threads to create. Defaults to
    *                          \ref RPC_DEFAULT_NUMHANDLERTHREADS
-   * \param commtype The Communication type. The only accepted value now is
-   *                 TCP_COMM
+   * \param commtype The Communication type. One of TCP_COMM, SHM_COMM
+   *                 or AUTO_COMM
    */
   dc_init_param(size_t numhandlerthreads = RPC_DEFAULT_NUMHANDLERTHREADS,
                 dc_comm_type commtype = RPC_DEFAULT_COMMTYPE):
@@ -236,6 +254,9 @@ class distributed_control{
   std::vector<dc_impl::dc_receive*> receivers;
   std::vector<dc_impl::dc_send*> senders;
 
+  /// the flush policy of each dc_send_class
+  dc_flush_policy flush_policies[2];
+
   /// A thread group of function call handlers
   fiber_group fcallhandlers;
   std::vector<atomic<size_t> > fcall_handler_active;
@@ -302,6 +323,8 @@ class distributed_control{
 
   DECLARE_EVENT(EVENT_NETWORK_BYTES);
   DECLARE_EVENT(EVENT_RPC_CALLS);
+  DECLARE_EVENT(EVENT_COMPRESSION_IN);
+  DECLARE_EVENT(EVENT_COMPRESSION_OUT);
  public:
 
   /**
@@ -444,6 +467,35 @@ class distributed_control{
    */
   static unsigned char get_sequentialization_key();
 
+  /**
+  \brief Sets the class of the RPC messages sent by this thread, returning
+  the old value.
+
+  Messages of the BULK_SEND class (the default) are batched into large
+  buffers, which are sent once enough of them are full or when the sender
+  next polls the buffers. Messages of the LATENCY_SEND class are handed to
+  the sender early, as decided by the flush policy of the class (see the
+  latency_max_bytes and latency_max_delay options of dc_init_param).
+  Latency sensitive traffic such as lock requests should use it.
+
+  \code
+  oldval = distributed_control::set_send_class(LATENCY_SEND);
+  // ...
+  // ... do stuff
+  // ...
+  set_send_class(oldval);
+  \endcode
+
+  The class is <b>thread-local</b> thus setting it in one thread does not
+  affect the class in another thread.
+  */
+  static dc_send_class set_send_class(dc_send_class newclass);
+
+  /// \internal Returns the flush policy of a class of messages
+  inline const dc_flush_policy& get_flush_policy(dc_send_class sendclass) const {
+    return flush_policies[sendclass];
+  }
+
 
 
 
@@ -948,6 +1000,20 @@ class distributed_control{
     return double(comm->network_bytes_sent()) / (1024 * 1024);
   }
 
+  /** \brief Returns the number of megabytes passed to the compressor.
+   *  Always 0 unless the compress option is set.
+   */
+  inline double compression_megabytes_in() const {
+    return double(comm->compression_bytes_in()) / (1024 * 1024);
+  }
+
+  /** \brief Returns the number of megabytes the compressor produced,
+   *  including the block headers. Also see compression_megabytes_in()
+   */
+  inline double compression_megabytes_out() const {
+    return double(comm->compression_bytes_out()) / (1024 * 1024);
+  }
+
 
 
   /** \brief Returns the total number of bytes received excluding all headers
@@ -114,6 +114,8 @@ namespace dc_impl {
       sendlen += sendvec.iov_len;
       outdata.write(sendvec);
     }
+    // outdata frees them once they are sent
+    additional_flush_buffers.clear();
     lock.unlock();
     return sendlen;
   }
@@ -87,6 +87,9 @@ class dc_comm_base {
   
   virtual size_t network_bytes_sent() const = 0;
   virtual size_t network_bytes_received() const = 0;
+  /// The number of bytes passed to, and produced by, the compressor
+  virtual size_t compression_bytes_in() const = 0;
+  virtual size_t compression_bytes_out() const = 0;
   virtual size_t send_queue_length() const = 0;
 
 };
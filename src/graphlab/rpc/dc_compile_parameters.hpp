@@ -46,6 +46,16 @@
  */
 #define RECEIVE_BUFFER_SIZE 131072
 
+/**
+ * \ingroup RPC
+ * \def RECEIVE_COPY_THRESHOLD
+ * When at least this many bytes of an incomplete message have been
+ * received, the receiver waits for the rest of the message before
+ * handing the buffer to the RPC handlers, instead of copying the
+ * incomplete message into a new buffer.
+ */
+#define RECEIVE_COPY_THRESHOLD 8192
+
 /**************************************************************************/
 /*                                                                        */
 /*                      Send Buffer Behavior Control                      */
@@ -94,6 +104,62 @@
  */
 #define NUM_FULL_BUFFER_LIMIT 32 
 
+/**
+ * \ingroup RPC
+ * \def LATENCY_SEND_MAX_BYTES
+ * Default max_bytes of the flush policy of LATENCY_SEND messages.
+ */
+#define LATENCY_SEND_MAX_BYTES 0
+
+/**
+ * \ingroup RPC
+ * \def LATENCY_SEND_MAX_DELAY
+ * Default max_delay (in microseconds) of the flush policy of LATENCY_SEND
+ * messages. 0 flushes every message as soon as it is written.
+ */
+#define LATENCY_SEND_MAX_DELAY 0
+
+/**
+ * \ingroup RPC
+ * \def BULK_SEND_MAX_BYTES
+ * Default max_bytes of the flush policy of BULK_SEND messages.
+ */
+#define BULK_SEND_MAX_BYTES (FULL_BUFFER_SIZE_LIMIT * NUM_FULL_BUFFER_LIMIT)
+
+/**
+ * \ingroup RPC
+ * \def BULK_SEND_MAX_DELAY
+ * Default max_delay (in microseconds) of the flush policy of BULK_SEND
+ * messages. Delays of SEND_POLL_TIMEOUT or more are left to the sender,
+ * which polls the buffers that often anyway.
+ */
+#define BULK_SEND_MAX_DELAY SEND_POLL_TIMEOUT
+
+/**
+ * \ingroup RPC
+ * \def COMPRESS_BLOCK_SIZE
+ * When compression is on, outgoing data is compressed in blocks of at
+ * most this many bytes.
+ */
+#define COMPRESS_BLOCK_SIZE 65536
+
+/**
+ * \ingroup RPC
+ * \def SHM_RING_SIZE
+ * The size of the shared memory ring buffer in each direction between
+ * two processes on the same host. Must be a power of 2.
+ */
+#define SHM_RING_SIZE 4194304
+
+/**
+ * \ingroup RPC
+ * \def SHM_POLL_TIMEOUT
+ * The shared memory comm is woken up as data arrives, but polls the
+ * send queues every so often like the TCP sender. This is the number of
+ * microseconds between each poll.
+ */
+#define SHM_POLL_TIMEOUT 10000
+
 /**************************************************************************/
 /*                                                                        */
 /*                          RPC Handling Control                          */
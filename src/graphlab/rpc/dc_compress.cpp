@@ -0,0 +1,179 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+
+#include <cstring>
+#include <graphlab/rpc/dc_compress.hpp>
+
+namespace graphlab {
+namespace dc_impl {
+
+namespace {
+
+typedef unsigned char byte_type;
+
+const size_t MIN_MATCH = 4;
+// the last match must start this far from the end of the block
+const size_t MATCH_FIND_LIMIT = 12;
+// and the last bytes of the block are always literals
+const size_t LAST_LITERALS = 5;
+const size_t MAX_OFFSET = 65535;
+const size_t HASH_LOG = 13;
+
+inline uint32_t read32(const byte_type* p) {
+  uint32_t ret;
+  memcpy(&ret, p, sizeof(uint32_t));
+  return ret;
+}
+
+inline size_t hash32(const byte_type* p) {
+  return (read32(p) * 2654435761u) >> (32 - HASH_LOG);
+}
+
+// writes the remainder of a length which did not fit in its token nibble
+inline byte_type* write_length(byte_type* op, size_t len) {
+  for (; len >= 255; len -= 255) *op++ = 255;
+  *op++ = (byte_type)len;
+  return op;
+}
+
+// the most bytes a sequence with litlen literals and a match may take
+inline size_t sequence_bound(size_t litlen, size_t matchlen) {
+  return 1 + litlen / 255 + 1 + litlen + 2 + matchlen / 255 + 1;
+}
+
+// reads the remainder of a token length. Returns false past the end.
+inline bool read_length(const byte_type*& ip, const byte_type* iend,
+                        size_t& len) {
+  byte_type b;
+  do {
+    if (ip >= iend) return false;
+    b = *ip++;
+    len += b;
+  } while (b == 255);
+  return true;
+}
+
+} // anonymous namespace
+
+
+size_t compress_block(const char* src, size_t len, char* dst) {
+  if (len <= MATCH_FIND_LIMIT) return 0;
+  const byte_type* const base = (const byte_type*)src;
+  const byte_type* const iend = base + len;
+  const byte_type* const mflimit = iend - MATCH_FIND_LIMIT;
+  const byte_type* const matchlimit = iend - LAST_LITERALS;
+  byte_type* op = (byte_type*)dst;
+  byte_type* const oend = op + len;
+
+  // offsets into the block of the last position with every hash
+  uint32_t table[1 << HASH_LOG];
+  memset(table, 0, sizeof(table));
+
+  const byte_type* ip = base + 1;
+  const byte_type* anchor = base;
+  while (ip < mflimit) {
+    const size_t h = hash32(ip);
+    const byte_type* ref = base + table[h];
+    table[h] = uint32_t(ip - base);
+    if (ref >= ip || size_t(ip - ref) > MAX_OFFSET ||
+        read32(ref) != read32(ip)) {
+      // skip faster through data which does not match
+      ip += 1 + ((ip - anchor) >> 6);
+      continue;
+    }
+    // extend the match in both directions
+    while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+      --ip; --ref;
+    }
+    const byte_type* mp = ip + MIN_MATCH;
+    const byte_type* rp = ref + MIN_MATCH;
+    while (mp < matchlimit && *mp == *rp) {
+      ++mp; ++rp;
+    }
+    const size_t litlen = ip - anchor;
+    const size_t matchlen = (mp - ip) - MIN_MATCH;
+    if (op + sequence_bound(litlen, matchlen) > oend) return 0;
+    byte_type* token = op++;
+    *token = byte_type((litlen < 15 ? litlen : 15) << 4);
+    if (litlen >= 15) op = write_length(op, litlen - 15);
+    memcpy(op, anchor, litlen);
+    op += litlen;
+    const size_t offset = ip - ref;
+    *op++ = byte_type(offset & 0xff);
+    *op++ = byte_type(offset >> 8);
+    *token |= byte_type(matchlen < 15 ? matchlen : 15);
+    if (matchlen >= 15) op = write_length(op, matchlen - 15);
+    ip = mp;
+    anchor = ip;
+    if (ip < mflimit) table[hash32(ip - 2)] = uint32_t(ip - 2 - base);
+  }
+  // the rest is literals
+  const size_t litlen = iend - anchor;
+  if (op + 1 + litlen / 255 + 1 + litlen >= oend) return 0;
+  byte_type* token = op++;
+  *token = byte_type((litlen < 15 ? litlen : 15) << 4);
+  if (litlen >= 15) op = write_length(op, litlen - 15);
+  memcpy(op, anchor, litlen);
+  op += litlen;
+  return op - (byte_type*)dst;
+}
+
+
+bool decompress_block(const char* src, size_t srclen,
+                      char* dst, size_t dstlen) {
+  const byte_type* ip = (const byte_type*)src;
+  const byte_type* const iend = ip + srclen;
+  byte_type* op = (byte_type*)dst;
+  byte_type* const oend = op + dstlen;
+  while (ip < iend) {
+    const byte_type token = *ip++;
+    size_t litlen = token >> 4;
+    if (litlen == 15 && !read_length(ip, iend, litlen)) return false;
+    if (litlen > size_t(iend - ip) || litlen > size_t(oend - op)) return false;
+    memcpy(op, ip, litlen);
+    op += litlen;
+    ip += litlen;
+    // the last sequence has no match
+    if (ip == iend) break;
+    if (iend - ip < 2) return false;
+    const size_t offset = size_t(ip[0]) | (size_t(ip[1]) << 8);
+    ip += 2;
+    size_t matchlen = token & 15;
+    if (matchlen == 15 && !read_length(ip, iend, matchlen)) return false;
+    matchlen += MIN_MATCH;
+    if (offset == 0 || offset > size_t(op - (byte_type*)dst) ||
+        matchlen > size_t(oend - op)) return false;
+    const byte_type* ref = op - offset;
+    if (offset >= matchlen) {
+      memcpy(op, ref, matchlen);
+    } else {
+      // the match overlaps the bytes it produces
+      for (size_t i = 0; i < matchlen; ++i) op[i] = ref[i];
+    }
+    op += matchlen;
+  }
+  return op == oend;
+}
+
+} // namespace dc_impl
+} // namespace graphlab
@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+
+#ifndef GRAPHLAB_DC_COMPRESS_HPP
+#define GRAPHLAB_DC_COMPRESS_HPP
+#include <cstddef>
+#include <stdint.h>
+
+namespace graphlab {
+namespace dc_impl {
+
+/**
+ * \ingroup rpc
+ * \internal
+ * Every block of a compressed stream is preceded by this header.
+ * complen is 0 if the block did not shrink and is sent as is.
+ */
+struct compress_frame_header {
+  uint32_t rawlen;
+  uint32_t complen;
+};
+
+/**
+ * \ingroup rpc
+ * \internal
+ * Compresses len bytes of src into dst, which must have room for len
+ * bytes, using a byte oriented LZ77 block format (LZ4 style: a token
+ * of literal and match lengths, the literals and a 2 byte offset per
+ * sequence). Returns the compressed length, or 0 if the block would
+ * not become smaller.
+ */
+size_t compress_block(const char* src, size_t len, char* dst);
+
+/**
+ * \ingroup rpc
+ * \internal
+ * Decompresses the srclen bytes of a block written by compress_block
+ * into exactly dstlen bytes of dst. Returns false if the block is
+ * malformed.
+ */
+bool decompress_block(const char* src, size_t srclen,
+                      char* dst, size_t dstlen);
+
+} // namespace dc_impl
+} // namespace graphlab
+#endif
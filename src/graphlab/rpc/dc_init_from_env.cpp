@@ -80,7 +80,8 @@ bool init_param_from_env(dc_init_param& param) {
 
   // set defaults
   param.numhandlerthreads = RPC_DEFAULT_NUMHANDLERTHREADS;
-  param.commtype = RPC_DEFAULT_COMMTYPE;
+  // co-located processes may talk through shared memory
+  param.commtype = AUTO_COMM;
   return true;
 }
 
@@ -28,8 +28,9 @@ namespace graphlab {
   /**
    * \ingroup rpc 
    * initializes parameters from MPI. Returns true on success
-      MPI must be initialized before calling this function */
-  bool init_param_from_mpi(dc_init_param& param, dc_comm_type commtype = TCP_COMM);
+      MPI must be initialized before calling this function.
+      By default co-located processes talk through shared memory */
+  bool init_param_from_mpi(dc_init_param& param, dc_comm_type commtype = AUTO_COMM);
 }
 
 #endif // GRAPHLAB_DC_INIT_FROM_MPI_HPP
@@ -0,0 +1,319 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <set>
+#include <vector>
+#include <string>
+#include <map>
+
+#include <boost/bind.hpp>
+#include <graphlab/logger/logger.hpp>
+#include <graphlab/rpc/dc_shm_comm.hpp>
+#include <graphlab/util/timer.hpp>
+#include <graphlab/util/stl_util.hpp>
+
+namespace graphlab {
+
+namespace {
+  // the address part of [IP]:[portnumber]
+  std::string machine_address(const std::string& machine) {
+    return machine.substr(0, machine.find(":"));
+  }
+
+  // sleeps until *addr is no longer val, or for at most usec microseconds
+  void doorbell_wait(volatile int* addr, int val, size_t usec) {
+#ifdef __linux__
+    struct timespec timeout;
+    timeout.tv_sec = usec / 1000000;
+    timeout.tv_nsec = (usec % 1000000) * 1000;
+    syscall(SYS_futex, addr, FUTEX_WAIT, val, &timeout, NULL, 0);
+#else
+    if (*addr == val) usleep(std::min<size_t>(usec, 100));
+#endif
+  }
+
+  void doorbell_wake(volatile int* addr) {
+#ifdef __linux__
+    syscall(SYS_futex, addr, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+  }
+} // anonymous namespace
+
+
+dc_comm_type select_comm_type(const std::vector<std::string>& machines) {
+  char* shm = getenv("GRAPHLAB_SHM");
+  if (shm != NULL && atoi(shm) == 0) return TCP_COMM;
+  std::set<std::string> addresses;
+  for (size_t i = 0;i < machines.size(); ++i) {
+    if (!addresses.insert(machine_address(machines[i])).second) return SHM_COMM;
+  }
+  return TCP_COMM;
+}
+
+
+namespace dc_impl {
+
+  void dc_shm_comm::init(const std::vector<std::string> &machines,
+                         const std::map<std::string,std::string> &initopts,
+                         procid_t curmachineid,
+                         std::vector<dc_receive*> receiver_,
+                         std::vector<dc_send*> sender_) {
+    receiver = receiver_;
+    sender = sender_;
+    shm_buffered_len = 0;
+    shm_bytessent = 0;
+    shm_bytesreceived = 0;
+    done = false;
+
+    // create the segments we own before anyone can finish connecting,
+    // so they exist once the TCP comm is up
+    const std::string& me = machines[curmachineid];
+    bell_name = segment_name(me, "bell");
+    bell = (shm_doorbell*)map_segment(bell_name, sizeof(shm_doorbell), true);
+    bell->seq = 0;
+    bell->sleeping = 0;
+    channels.resize(machines.size(), NULL);
+    std::vector<dc_send*> tcp_sender = sender;
+    for (procid_t i = 0;i < machines.size(); ++i) {
+      if (machine_address(machines[i]) != machine_address(me)) continue;
+      channels[i] = new channel;
+      channels[i]->out = (shm_ring*)map_segment(segment_name(me, tostr(i)),
+                                                sizeof(shm_ring), true);
+      channels[i]->out->head = 0;
+      channels[i]->out->tail = 0;
+      channels[i]->in = NULL;
+      channels[i]->bell = NULL;
+      // nothing goes to this machine over TCP
+      tcp_sender[i] = NULL;
+    }
+    tcp.init(machines, initopts, curmachineid, receiver, tcp_sender);
+
+    size_t numlocal = 0;
+    for (procid_t i = 0;i < machines.size(); ++i) {
+      if (channels[i] == NULL) continue;
+      const std::string name = segment_name(machines[i], tostr(curmachineid));
+      channels[i]->in = (shm_ring*)map_segment(name, sizeof(shm_ring), false);
+      // the mapping stays valid. Do not leave the name behind
+      shm_unlink(name.c_str());
+      channels[i]->bell = (shm_doorbell*)map_segment(
+          segment_name(machines[i], "bell"), sizeof(shm_doorbell), false);
+      ++numlocal;
+    }
+    logstream(LOG_INFO) << "Proc " << procid() << " reaches " << numlocal
+                        << " machines through shared memory" << std::endl;
+    shmthread.launch(boost::bind(&dc_shm_comm::shm_loop, this));
+    is_closed = false;
+  }
+
+
+  std::string dc_shm_comm::segment_name(const std::string& owner,
+                                        const std::string& what) const {
+    // the owner is listening on its port, so it is unique on the host
+    std::string name = "/graphlab_shm_" + owner + "_" + what;
+    std::replace(name.begin() + 1, name.end(), ':', '_');
+    std::replace(name.begin() + 1, name.end(), '/', '_');
+    return name;
+  }
+
+
+  void* dc_shm_comm::map_segment(const std::string& name, size_t len,
+                                 bool create) {
+    int fd;
+    if (create) {
+      // clear out a segment left behind by a process which died
+      shm_unlink(name.c_str());
+      fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+      if (fd >= 0 && ftruncate(fd, len) != 0) {
+        logstream(LOG_FATAL) << "Unable to size shared memory segment "
+                             << name << ": " << strerror(errno) << std::endl;
+      }
+    } else {
+      fd = shm_open(name.c_str(), O_RDWR, 0600);
+    }
+    if (fd < 0) {
+      logstream(LOG_FATAL) << "Unable to open shared memory segment "
+                           << name << ": " << strerror(errno) << std::endl;
+    }
+    void* ptr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (ptr == MAP_FAILED) {
+      logstream(LOG_FATAL) << "Unable to map shared memory segment "
+                           << name << ": " << strerror(errno) << std::endl;
+    }
+    return ptr;
+  }
+
+
+  void dc_shm_comm::ring(shm_doorbell* doorbell) {
+    // the thread reads seq before it looks for work, so a change makes
+    // its wait return at once. Only a sleeping thread needs the syscall.
+    __sync_fetch_and_add(&(doorbell->seq), 1);
+    if (doorbell->sleeping) doorbell_wake(&(doorbell->seq));
+  }
+
+
+  void dc_shm_comm::trigger_send_timeout(procid_t target, bool urgent) {
+    if (channels[target] == NULL) {
+      tcp.trigger_send_timeout(target, urgent);
+    } else {
+      ring(bell);
+    }
+  }
+
+
+  bool dc_shm_comm::send_channel(procid_t target) {
+    channel& ch = *channels[target];
+    shm_buffered_len.inc(sender[target]->get_outgoing_data(ch.outvec));
+    shm_ring& ring = *ch.out;
+    bool progress = false;
+    while (!ch.outvec.empty()) {
+      const size_t tail = ring.tail;
+      const size_t space = SHM_RING_SIZE - (tail - ring.head);
+      if (space == 0) break;
+      const iovec& cur = ch.outvec.parallel_v[ch.outvec.head];
+      // up to the end of the ring
+      const size_t offset = tail & (SHM_RING_SIZE - 1);
+      const size_t len = std::min(std::min(cur.iov_len, space),
+                                  SHM_RING_SIZE - offset);
+      memcpy(ring.data + offset, cur.iov_base, len);
+      // the data must be visible before the tail moves past it
+      __sync_synchronize();
+      ring.tail = tail + len;
+      ch.outvec.sent(len);
+      shm_bytessent.inc(len);
+      progress = true;
+    }
+    if (progress) this->ring(ch.bell);
+    return progress;
+  }
+
+
+  bool dc_shm_comm::receive_channel(procid_t source) {
+    shm_ring& ring = *(channels[source]->in);
+    dc_receive* rcv = receiver[source];
+    bool progress = false;
+    while(1) {
+      const size_t head = ring.head;
+      const size_t avail = ring.tail - head;
+      if (avail == 0) break;
+      __sync_synchronize();
+      size_t buflength;
+      char* c = rcv->get_buffer(buflength);
+      const size_t offset = head & (SHM_RING_SIZE - 1);
+      const size_t len = std::min(std::min(avail, buflength),
+                                  SHM_RING_SIZE - offset);
+      memcpy(c, ring.data + offset, len);
+      // the copy must be done before the writer may reuse the space
+      __sync_synchronize();
+      ring.head = head + len;
+      shm_bytesreceived.inc(len);
+      rcv->advance_buffer(c, len, buflength);
+      progress = true;
+    }
+    // the writer may be waiting for room
+    if (progress) this->ring(channels[source]->bell);
+    return progress;
+  }
+
+
+  bool dc_shm_comm::has_incoming() const {
+    for (procid_t i = 0;i < channels.size(); ++i) {
+      if (channels[i] != NULL && channels[i]->in->tail != channels[i]->in->head) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+
+  void dc_shm_comm::shm_loop() {
+    logstream(LOG_INFO) << "Shared memory loop Started" << std::endl;
+    while(!done) {
+      // a ring from here on makes the wait below return at once
+      const int seq = bell->seq;
+      bool progress = false;
+      for (procid_t i = 0;i < channels.size(); ++i) {
+        if (channels[i] == NULL) continue;
+        progress |= send_channel(i);
+        progress |= receive_channel(i);
+      }
+      if (!progress) {
+        bell->sleeping = 1;
+        __sync_synchronize();
+        if (!done && !has_incoming()) {
+          doorbell_wait(&(bell->seq), seq, SHM_POLL_TIMEOUT);
+        }
+        bell->sleeping = 0;
+      }
+    }
+    // send what is left, for as long as the other side may be reading
+    timer ti;
+    bool pending = true;
+    while (pending && ti.current_time() < 1.0) {
+      pending = false;
+      for (procid_t i = 0;i < channels.size(); ++i) {
+        if (channels[i] == NULL) continue;
+        send_channel(i);
+        receive_channel(i);
+        pending |= !channels[i]->outvec.empty();
+      }
+    }
+    logstream(LOG_INFO) << "Shared memory loop Stopped" << std::endl;
+  }
+
+
+  void dc_shm_comm::close() {
+    if (is_closed) return;
+    done = true;
+    // wakes the thread whether or not it is sleeping
+    __sync_fetch_and_add(&(bell->seq), 1);
+    doorbell_wake(&(bell->seq));
+    shmthread.join();
+    tcp.close();
+    for (size_t i = 0;i < channels.size(); ++i) {
+      if (channels[i] == NULL) continue;
+      munmap(channels[i]->out, sizeof(shm_ring));
+      munmap(channels[i]->in, sizeof(shm_ring));
+      munmap(channels[i]->bell, sizeof(shm_doorbell));
+      delete channels[i];
+    }
+    channels.clear();
+    munmap(bell, sizeof(shm_doorbell));
+    shm_unlink(bell_name.c_str());
+    is_closed = true;
+  }
+
+} // namespace dc_impl
+} // namespace graphlab
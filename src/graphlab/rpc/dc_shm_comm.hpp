@@ -0,0 +1,208 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+
+#ifndef GRAPHLAB_DC_SHM_COMM_HPP
+#define GRAPHLAB_DC_SHM_COMM_HPP
+
+#include <vector>
+#include <string>
+#include <map>
+
+#include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/parallel/atomic.hpp>
+#include <graphlab/rpc/dc_types.hpp>
+#include <graphlab/rpc/dc_internal_types.hpp>
+#include <graphlab/rpc/dc_compile_parameters.hpp>
+#include <graphlab/rpc/dc_comm_base.hpp>
+#include <graphlab/rpc/dc_tcp_comm.hpp>
+#include <graphlab/rpc/circular_iovec_buffer.hpp>
+
+namespace graphlab {
+
+/**
+ * \ingroup rpc
+ * Returns SHM_COMM if two of the machines, given as [IP]:[portnumber],
+ * have the same address, and TCP_COMM otherwise. Setting the
+ * GRAPHLAB_SHM environment variable to 0 always selects TCP_COMM.
+ */
+dc_comm_type select_comm_type(const std::vector<std::string>& machines);
+
+namespace dc_impl {
+
+/**
+ \ingroup rpc
+ \internal
+Shared memory implementation of the communications subsystem.
+
+Machines with the same address as this one are sent data through a
+shared memory ring buffer per direction. All other machines are reached
+through a dc_tcp_comm. The TCP connections to co-located machines are
+still made, since they take part in the connection setup, but carry no
+data.
+
+Every ring is a POSIX shared memory segment with a single writer and a
+single reader, which only ever advance the tail and the head of the
+ring respectively. One thread moves the outgoing data of every
+co-located machine into the rings and the incoming data out of them.
+When there is nothing to do it sleeps on the doorbell of its process
+(a futex on Linux), which the other processes ring after writing to
+or reading from one of its rings. It also wakes up every
+SHM_POLL_TIMEOUT microseconds to look for new data to send.
+*/
+class dc_shm_comm:public dc_comm_base {
+ public:
+
+  inline dc_shm_comm() {
+    is_closed = true;
+  }
+
+  size_t capabilities() const {
+    return COMM_STREAM;
+  }
+
+  /**
+   Sets up the rings to the co-located machines and initializes the TCP
+   comm with the remaining ones. The parameters are as in
+   dc_tcp_comm::init()
+  */
+  void init(const std::vector<std::string> &machines,
+            const std::map<std::string,std::string> &initopts,
+            procid_t curmachineid,
+            std::vector<dc_receive*> receiver,
+            std::vector<dc_send*> senders);
+
+  /** shuts down the rings and the TCP comm */
+  void close();
+
+  ~dc_shm_comm() {
+    close();
+  }
+
+  inline procid_t numprocs() const {
+    return tcp.numprocs();
+  }
+
+  inline procid_t procid() const {
+    return tcp.procid();
+  }
+
+  inline size_t network_bytes_sent() const {
+    return tcp.network_bytes_sent() + shm_bytessent.value;
+  }
+
+  inline size_t network_bytes_received() const {
+    return tcp.network_bytes_received() + shm_bytesreceived.value;
+  }
+
+  inline size_t compression_bytes_in() const {
+    return tcp.compression_bytes_in();
+  }
+
+  inline size_t compression_bytes_out() const {
+    return tcp.compression_bytes_out();
+  }
+
+  inline size_t send_queue_length() const {
+    size_t a = shm_bytessent.value;
+    size_t b = shm_buffered_len.value;
+    return tcp.send_queue_length() + (b - a);
+  }
+
+  void trigger_send_timeout(procid_t target, bool urgent);
+
+  /// The ring buffer at the start of every shared memory segment
+  struct shm_ring {
+    /// The total number of bytes read. Only written by the reader
+    volatile size_t head;
+    char pad0[64 - sizeof(size_t)];
+    /// The total number of bytes written. Only written by the writer
+    volatile size_t tail;
+    char pad1[64 - sizeof(size_t)];
+    char data[SHM_RING_SIZE];
+  };
+
+  /// Wakes up the shared memory thread of a process
+  struct shm_doorbell {
+    /// incremented on every ring
+    volatile int seq;
+    /// set while the thread may be sleeping
+    volatile int sleeping;
+  };
+
+ private:
+
+  /// A co-located machine
+  struct channel {
+    shm_ring* out;  /// the ring to the machine
+    shm_ring* in;   /// the ring from the machine
+    shm_doorbell* bell; /// the doorbell of the machine
+    circular_iovec_buffer outvec; /// data which did not fit in the ring yet
+  };
+
+  dc_tcp_comm tcp;
+  bool is_closed;
+
+  std::vector<dc_receive*> receiver;
+  std::vector<dc_send*> sender;
+  /// channels[i] is NULL if machine i is reached over TCP
+  std::vector<channel*> channels;
+
+  /// My doorbell
+  shm_doorbell* bell;
+  std::string bell_name;
+
+  /**
+   * The name of a segment belonging to the machine owner, which is the
+   * writer of a ring
+   */
+  std::string segment_name(const std::string& owner,
+                           const std::string& what) const;
+
+  /// Maps a segment of len bytes, creating it if create is set
+  void* map_segment(const std::string& name, size_t len, bool create);
+
+  /// Wakes up the thread of the doorbell, or keeps it from sleeping
+  void ring(shm_doorbell* doorbell);
+
+  /// True if there is data in any incoming ring
+  bool has_incoming() const;
+
+  /// Moves outgoing data into the ring. Returns true on progress
+  bool send_channel(procid_t target);
+  /// Moves incoming data to the receiver. Returns true on progress
+  bool receive_channel(procid_t source);
+
+  thread shmthread;
+  void shm_loop();
+  /// set on close
+  volatile bool done;
+
+  // counters
+  atomic<size_t> shm_buffered_len;
+  atomic<size_t> shm_bytessent;
+  atomic<size_t> shm_bytesreceived;
+};
+
+} // namespace dc_impl
+} // namespace graphlab
+#endif
@@ -35,7 +35,8 @@ namespace dc_impl {
 
 
 char* dc_stream_receive::get_buffer(size_t& retbuflength) {
-  retbuflength = write_buffer_len - write_buffer_written;
+  size_t end = receive_limit > 0 ? receive_limit : write_buffer_len;
+  retbuflength = end - write_buffer_written;
   return writebuffer + write_buffer_written;
 }
 
@@ -62,7 +63,20 @@ char* dc_stream_receive::advance_buffer(char* c, size_t wrotelength,
       // allocate whatever it is going to take to hold next message
       // have we read the incomplete message's header?
       size_t incomplete_message_len = 0;
-      if (offset + sizeof(packet_hdr) <= write_buffer_written) incomplete_message_len = hdr->len;
+      bool header_read = offset + sizeof(packet_hdr) <= write_buffer_written;
+      if (header_read) incomplete_message_len = hdr->len;
+
+      // if much of the incomplete message is here already and the rest
+      // fits, receive the rest instead of copying it to the new buffer.
+      // The handlers then get the buffer as received.
+      size_t incomplete_message_end = offset + sizeof(packet_hdr) + incomplete_message_len;
+      if (header_read &&
+          write_buffer_written - offset >= RECEIVE_COPY_THRESHOLD &&
+          incomplete_message_end <= write_buffer_len) {
+        receive_limit = incomplete_message_end;
+        return get_buffer(retbuflength);
+      }
+      receive_limit = 0;
 
       size_t new_buflen = std::max<size_t>(sizeof(packet_hdr) + incomplete_message_len, RECEIVE_BUFFER_SIZE);
       char* new_writebuffer = (char*)malloc(new_buflen);
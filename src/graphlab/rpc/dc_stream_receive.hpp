@@ -51,7 +51,8 @@ class dc_stream_receive: public dc_receive{
  public:
   
   dc_stream_receive(distributed_control* dc, procid_t associated_proc): 
-                  writebuffer(NULL), write_buffer_written(0), dc(dc), 
+                  writebuffer(NULL), write_buffer_written(0),
+                  receive_limit(0), dc(dc),
                   associated_proc(associated_proc) { 
     writebuffer = (char*)malloc(RECEIVE_BUFFER_SIZE);
     write_buffer_len = RECEIVE_BUFFER_SIZE;
@@ -62,6 +63,11 @@ class dc_stream_receive: public dc_receive{
   char* writebuffer;
   size_t write_buffer_written;
   size_t write_buffer_len;
+  /**
+   * If not 0, reads stop at this offset into writebuffer, which is the
+   * end of an incomplete message
+   */
+  size_t receive_limit;
   
   /// pointer to the owner
   distributed_control* dc;
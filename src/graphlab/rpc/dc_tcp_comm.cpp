@@ -42,6 +42,8 @@
 #include <graphlab/logger/logger.hpp>
 #include <graphlab/rpc/dc_tcp_comm.hpp>
 #include <graphlab/rpc/dc_internal_types.hpp>
+#include <graphlab/rpc/dc_compile_parameters.hpp>
+#include <graphlab/rpc/dc_compress.hpp>
 #include <graphlab/rpc/get_current_process_hash.cpp>
 #define compile_barrier() asm volatile("": : :"memory")
 
@@ -71,6 +73,14 @@ namespace graphlab {
       receiver = receiver_;
       sender = sender_;
 
+      compress = false;
+      std::map<std::string, std::string>::const_iterator compress_opt =
+        initopts.find("compress");
+      if (compress_opt != initopts.end()) {
+        const std::string& value = compress_opt->second;
+        compress = (value == "1" || value == "true" || value == "yes");
+      }
+
       // insert machines into the address map
       all_addrs.resize(nprocs);
       portnums.resize(nprocs);
@@ -93,6 +103,11 @@ namespace graphlab {
         sock[i].data.msg_flags = 0;
         sock[i].data.msg_iovlen = 0;
         sock[i].data.msg_iov = NULL;
+        // there is nothing to gain from compressing the loopback
+        sock[i].compress_out = compress && i != curid;
+        sock[i].compress_in = false;
+        sock[i].inframes_len = 0;
+        if (sock[i].compress_out) sock[i].outblock.resize(COMPRESS_BLOCK_SIZE);
       }
 
       program_md5 = get_current_process_hash();
@@ -115,6 +130,8 @@ namespace graphlab {
       }
       network_bytessent = 0;
       buffered_len = 0;
+      compress_bytes_in = 0;
+      compress_bytes_out = 0;
       // if sock handle is set
       std::map<std::string, std::string>::const_iterator iter =
         initopts.find("__sockhandle__");
@@ -368,7 +385,7 @@ namespace graphlab {
 
 
     void dc_tcp_comm::new_socket(int newsock, sockaddr_in* otheraddr,
-                                 procid_t id) {
+                                 procid_t id, bool compressed) {
       // figure out the address of the incoming connection
       uint32_t addr = *reinterpret_cast<uint32_t*>(&(otheraddr->sin_addr));
       // locate the incoming address in the list
@@ -379,6 +396,13 @@ namespace graphlab {
       insock_lock.lock();
       ASSERT_EQ(sock[id].insock, -1);
       sock[id].insock = newsock;
+      sock[id].compress_in = compressed;
+      if (compressed) {
+        // room for at least one whole frame
+        sock[id].inframes.resize(2 * (sizeof(compress_frame_header) +
+                                      COMPRESS_BLOCK_SIZE));
+        sock[id].inblock.resize(COMPRESS_BLOCK_SIZE);
+      }
       insock_cond.signal();
       insock_lock.unlock();
       logstream(LOG_INFO) << "Proc " << procid() << " accepted connection "
@@ -456,6 +480,7 @@ namespace graphlab {
             initial_message msg; 
             msg.id = curid;
             memcpy(msg.md5, program_md5.c_str(), 32);
+            msg.compressed = sock[target].compress_out;
             sendtosock(newsock, reinterpret_cast<char*>(&msg), sizeof(initial_message));
             set_non_blocking(newsock);
             success = true;
@@ -539,7 +564,8 @@ namespace graphlab {
             }
             // register the new socket
             set_non_blocking(newsock);
-            new_socket(newsock, &their_addr, remote_message.id);
+            new_socket(newsock, &their_addr, remote_message.id,
+                       remote_message.compressed);
             ++numsocks_connected;
           }
         }
@@ -556,7 +582,10 @@ namespace graphlab {
     void on_receive_event(int fd, short ev, void* arg) {
       dc_tcp_comm::socket_info* sockinfo = (dc_tcp_comm::socket_info*)(arg);
       dc_tcp_comm* comm = sockinfo->owner;
-      if (ev & EV_READ) {
+      if ((ev & EV_READ) && sockinfo->compress_in) {
+        comm->receive_compressed(fd, *sockinfo);
+      }
+      else if (ev & EV_READ) {
         // get a direct pointer to my receiver
         dc_receive* receiver = comm->receiver[sockinfo->id];
 
@@ -587,6 +616,76 @@ namespace graphlab {
       }
     }
 
+    void dc_tcp_comm::receive_compressed(int fd, socket_info& sockinfo) {
+      dc_receive* rcv = receiver[sockinfo.id];
+      std::vector<char>& frames = sockinfo.inframes;
+      while(1) {
+        ssize_t msglen = recv(fd, &(frames[sockinfo.inframes_len]),
+                              frames.size() - sockinfo.inframes_len, 0);
+        if (msglen < 0) {
+          if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+          else {
+            logstream(LOG_FATAL) << "receive error: " << strerror(errno) << std::endl;
+            break;
+          }
+        }
+        else if (msglen == 0) {
+          // socket closed
+          break;
+        }
+        network_bytesreceived.inc(msglen);
+        sockinfo.inframes_len += msglen;
+        // decode every complete frame
+        size_t offset = 0;
+        while (offset + sizeof(compress_frame_header) <= sockinfo.inframes_len) {
+          compress_frame_header hdr;
+          memcpy(&hdr, &(frames[offset]), sizeof(compress_frame_header));
+          const size_t payload = hdr.complen > 0 ? hdr.complen : hdr.rawlen;
+          if (hdr.rawlen > COMPRESS_BLOCK_SIZE || payload > hdr.rawlen) {
+            logstream(LOG_FATAL) << "Corrupt compressed frame from "
+                                 << sockinfo.id << std::endl;
+          }
+          const size_t framelen = sizeof(compress_frame_header) + payload;
+          if (offset + framelen > sockinfo.inframes_len) break;
+          const char* data = &(frames[offset + sizeof(compress_frame_header)]);
+          size_t buflength;
+          char* c = rcv->get_buffer(buflength);
+          if (hdr.complen > 0 && buflength >= hdr.rawlen) {
+            // straight into the receive buffer
+            if (!decompress_block(data, hdr.complen, c, hdr.rawlen)) {
+              logstream(LOG_FATAL) << "Corrupt compressed frame from "
+                                   << sockinfo.id << std::endl;
+            }
+            rcv->advance_buffer(c, hdr.rawlen, buflength);
+          } else {
+            if (hdr.complen > 0) {
+              if (!decompress_block(data, hdr.complen,
+                                    &(sockinfo.inblock[0]), hdr.rawlen)) {
+                logstream(LOG_FATAL) << "Corrupt compressed frame from "
+                                     << sockinfo.id << std::endl;
+              }
+              data = &(sockinfo.inblock[0]);
+            }
+            size_t remaining = hdr.rawlen;
+            while (remaining > 0) {
+              const size_t len = std::min(remaining, buflength);
+              memcpy(c, data, len);
+              data += len;
+              remaining -= len;
+              c = rcv->advance_buffer(c, len, buflength);
+            }
+          }
+          offset += framelen;
+        }
+        // keep the incomplete frame
+        if (offset > 0) {
+          memmove(&(frames[0]), &(frames[offset]),
+                  sockinfo.inframes_len - offset);
+          sockinfo.inframes_len -= offset;
+        }
+      }
+    }
+
     void dc_tcp_comm::receive_loop(struct event_base* ev) {
       logstream(LOG_INFO) << "Receive loop Started" << std::endl;
       int ret = event_base_dispatch(ev);
@@ -600,7 +699,51 @@ namespace graphlab {
 
 
     void dc_tcp_comm::check_for_new_data(dc_tcp_comm::socket_info& sockinfo) {
-      buffered_len.inc(sender[sockinfo.id]->get_outgoing_data(sockinfo.outvec));
+      // the machine is reached some other way
+      if (sender[sockinfo.id] == NULL) return;
+      if (sockinfo.compress_out) {
+        if (sender[sockinfo.id]->get_outgoing_data(sockinfo.rawvec) > 0) {
+          buffered_len.inc(compress_new_data(sockinfo));
+        }
+      } else {
+        buffered_len.inc(sender[sockinfo.id]->get_outgoing_data(sockinfo.outvec));
+      }
+    }
+
+
+    size_t dc_tcp_comm::compress_new_data(dc_tcp_comm::socket_info& sockinfo) {
+      circular_iovec_buffer& raw = sockinfo.rawvec;
+      char* block = &(sockinfo.outblock[0]);
+      size_t written = 0;
+      while (!raw.empty()) {
+        // gather a block. sent() frees the buffers as they are used up
+        size_t len = 0;
+        while (!raw.empty() && len < COMPRESS_BLOCK_SIZE) {
+          const iovec& cur = raw.parallel_v[raw.head];
+          const size_t n = std::min<size_t>(cur.iov_len, COMPRESS_BLOCK_SIZE - len);
+          memcpy(block + len, cur.iov_base, n);
+          len += n;
+          raw.sent(n);
+        }
+        char* frame = (char*)malloc(sizeof(compress_frame_header) + len);
+        compress_frame_header hdr;
+        hdr.rawlen = len;
+        hdr.complen = compress_block(block, len,
+                                     frame + sizeof(compress_frame_header));
+        if (hdr.complen == 0) {
+          memcpy(frame + sizeof(compress_frame_header), block, len);
+        }
+        memcpy(frame, &hdr, sizeof(compress_frame_header));
+        iovec framevec;
+        framevec.iov_base = frame;
+        framevec.iov_len = sizeof(compress_frame_header) +
+                           (hdr.complen > 0 ? hdr.complen : len);
+        sockinfo.outvec.write(framevec);
+        compress_bytes_in.inc(len);
+        compress_bytes_out.inc(framevec.iov_len);
+        written += framevec.iov_len;
+      }
+      return written;
     }
 
 
@@ -57,6 +57,13 @@ void on_send_event(int fd, short ev, void* arg);
 TCP implementation of the communications subsystem.
 Provides a single object interface to sending/receiving data streams to
 a collection of machines.
+
+With the "compress" option, the stream on every connection to another
+machine is cut into blocks of up to COMPRESS_BLOCK_SIZE bytes which are
+compressed with compress_block() before they are sent. Each side
+announces in its connection handshake whether the stream it sends is
+compressed, so machines with and without the option can talk to each
+other.
 */
 class dc_tcp_comm:public dc_comm_base {
  public:
@@ -80,12 +87,15 @@ class dc_tcp_comm:public dc_comm_base {
    attached receiver
 
    machines: a vector of strings where each string is of the form [IP]:[portnumber]
-   initopts: unused
+   initopts: "compress" set to a true value (1, true, yes) compresses
+             outgoing data
    curmachineid: The ID of the current machine. machines[curmachineid] will be
                  the listening address of this machine
 
    recvcallback: A function pointer to the receiving function. This function must be thread-safe
    tag: An additional pointer passed to the receiving function.
+   senders: senders[i] may be NULL if nothing is sent to machine i
+            over TCP. The connection is still made.
   */
   void init(const std::vector<std::string> &machines,
             const std::map<std::string,std::string> &initopts,
@@ -134,6 +144,21 @@ class dc_tcp_comm:public dc_comm_base {
     return network_bytesreceived.value;
   }
 
+  /**
+   * Returns the number of bytes passed to the compressor
+   */
+  inline size_t compression_bytes_in() const {
+    return compress_bytes_in.value;
+  }
+
+  /**
+   * Returns the number of bytes the compressor produced, including the
+   * block headers
+   */
+  inline size_t compression_bytes_out() const {
+    return compress_bytes_out.value;
+  }
+
   inline size_t send_queue_length() const {
     size_t a = network_bytessent.value;
     size_t b = buffered_len.value;
@@ -156,7 +181,8 @@ class dc_tcp_comm:public dc_comm_base {
   void set_non_blocking(int fd);
 
   /// called when listener receives an incoming socket request
-  void new_socket(int newsock, sockaddr_in* otheraddr, procid_t remotemachineid);
+  void new_socket(int newsock, sockaddr_in* otheraddr, procid_t remotemachineid,
+                  bool compressed);
 
 
   /// The number of incoming connections established
@@ -178,6 +204,7 @@ class dc_tcp_comm:public dc_comm_base {
   procid_t curid;   /// if od the current processor
   procid_t nprocs;  /// number of processors
   bool is_closed;   /// whether this socket is closed
+  bool compress;    /// whether outgoing data is compressed
 
   std::string program_md5;  /// MD5 hash of current program
 
@@ -195,6 +222,7 @@ class dc_tcp_comm:public dc_comm_base {
   struct initial_message {
     procid_t id;
     char md5[32];
+    bool compressed; /// whether the stream on this connection is compressed
   };
 
 
@@ -212,6 +240,14 @@ class dc_tcp_comm:public dc_comm_base {
 
     circular_iovec_buffer outvec;  /// outgoing data
     struct msghdr data;
+
+    bool compress_out; /// whether outgoing data is compressed
+    bool compress_in;  /// whether incoming data is compressed
+    circular_iovec_buffer rawvec;  /// outgoing data waiting to be compressed
+    std::vector<char> outblock;    /// a block of outgoing data
+    std::vector<char> inframes;    /// received compressed frames
+    size_t inframes_len;           /// the number of bytes in inframes
+    std::vector<char> inblock;     /// a decompressed block
   };
 
   mutex insock_lock; /// locks the insock field in socket_info
@@ -233,6 +269,16 @@ class dc_tcp_comm:public dc_comm_base {
   void send_all(socket_info& sockinfo);
   bool send_till_block(socket_info& sockinfo);
   void check_for_new_data(socket_info& sockinfo);
+  /**
+   * Compresses everything in the rawvec of the sockinfo into frames in
+   * its outvec. Returns the number of bytes written to the outvec.
+   */
+  size_t compress_new_data(socket_info& sockinfo);
+  /**
+   * Reads compressed frames from the incoming socket until it would
+   * block and passes the decompressed data to the receiver.
+   */
+  void receive_compressed(int fd, socket_info& sockinfo);
   void construct_events();
 
 
@@ -240,6 +286,8 @@ class dc_tcp_comm:public dc_comm_base {
   // counters
   atomic<size_t> network_bytessent;
   atomic<size_t> network_bytesreceived;
+  atomic<size_t> compress_bytes_in;
+  atomic<size_t> compress_bytes_out;
 
   ////////////       Receiving Sockets      //////////////////////
   thread_group inthreads;
@@ -53,6 +53,21 @@ inline void write_thread_local_buffer(procid_t target,
   p->write(target, c, len, do_not_count_bytes_sent);
 }
 
+/**
+ * \internal
+ * Writes a message made of the segments of an oarchive in gather mode
+ * followed by c to the local send buffer
+ */
+inline void write_thread_local_buffer(procid_t target, 
+                                      const oarchive_gather& gather,
+                                      char* c,
+                                      size_t len,
+                                      bool do_not_count_bytes_sent) {
+  void* ptr = pthread_getspecific(thrlocal_send_buffer_key);
+  thread_local_buffer* p = (thread_local_buffer*)(ptr);
+  p->write(target, gather, c, len, do_not_count_bytes_sent);
+}
+
 
 
 /**
@@ -110,6 +125,21 @@ inline procid_t _get_procid() {
   return p->procid;
 }
 
+/**
+ * \internal
+ * Sets the class of the messages sent by this thread, returning the
+ * previous class.
+ */
+inline dc_send_class set_send_class_thread_local_buffer(dc_send_class newclass) {
+  void* ptr = pthread_getspecific(thrlocal_send_buffer_key);
+  thread_local_buffer* p = (thread_local_buffer*)(ptr);
+  if (p == NULL) {
+    p = new thread_local_buffer;
+    pthread_setspecific(thrlocal_send_buffer_key, (void*)p);
+  }
+  return p->set_send_class(newclass);
+}
+
 /**
  * Get the current sequentialization key.
  * This function really exists to split the dependency between this header and
@@ -36,7 +36,32 @@ namespace graphlab {
    */
   enum dc_comm_type {
     TCP_COMM,   ///< TCP/IP
-    SCTP_COMM   ///< SCTP (limited support)
+    SHM_COMM,   ///< Shared memory within a host, TCP/IP between hosts
+    SCTP_COMM,  ///< SCTP (limited support)
+    AUTO_COMM   ///< SHM_COMM if some processes share a host, TCP_COMM otherwise
+  };
+
+  /**
+   * \ingroup rpc
+   * The class of the RPC messages sent by a thread, which selects the
+   * flush policy they are sent with.
+   * See distributed_control::set_send_class()
+   */
+  enum dc_send_class {
+    BULK_SEND,    ///< Batched into large buffers for throughput
+    LATENCY_SEND  ///< Handed to the sender early. For lock and control messages
+  };
+
+  /**
+   * \ingroup rpc
+   * Decides when the messages of one dc_send_class buffered by a thread
+   * are flushed to the sender.
+   */
+  struct dc_flush_policy {
+    /// Flush once this many bytes are buffered for a machine
+    size_t max_bytes;
+    /// Flush once the oldest buffered message is this many microseconds old
+    size_t max_delay;
   };
 
 
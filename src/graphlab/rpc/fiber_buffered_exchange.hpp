@@ -186,7 +186,7 @@ namespace graphlab {
       ++send_buffers[wid][proc].numinserts;
 
 
-      if(send_buffers[wid][proc].oarc->off >= max_buffer_size) {
+      if(send_buffers[wid][proc].oarc->size() >= max_buffer_size) {
         flush_buffer(wid, proc);
       }
     } // end of send
@@ -136,6 +136,8 @@ class object_split_call {
     oarchive& arc = *ptr;
     arc.buf = (char*)malloc(INITIAL_BUFFER_SIZE); 
     arc.len = INITIAL_BUFFER_SIZE; 
+    // large messages are sent as a list of buffers rather than reallocated
+    arc.gather = new oarchive_gather;
     arc.advance(sizeof(packet_hdr));
     dispatch_type d = dc_impl::OBJECT_NONINTRUSIVE_DISPATCH2<distributed_control,T,F,size_t, wild_pointer>;
     arc << reinterpret_cast<size_t>(d);
@@ -150,6 +152,10 @@ class object_split_call {
     return ptr;
   }
   static void split_call_cancel(oarchive* oarc) {
+    for (size_t i = 0;i < oarc->gather->segments.size(); ++i) {
+      free(oarc->gather->segments[i].first);
+    }
+    delete oarc->gather;
     free(oarc->buf);
     delete oarc;
   }
@@ -163,17 +169,21 @@ class object_split_call {
  */
   static void split_call_end(dc_dist_object_base* rmi,
                              oarchive* oarc, dc_send* sender, procid_t target, unsigned char flags) {
+    // the header is at the start of the first buffer
+    oarchive_gather* gather = oarc->gather;
+    char* first = gather->segments.empty() ? oarc->buf : gather->segments[0].first;
     // header points to the location of the blob size argument
-    size_t blobsize_offset = *reinterpret_cast<size_t*>(oarc->buf);
-    (*reinterpret_cast<size_t*>(oarc->buf + blobsize_offset)) = oarc->off - blobsize_offset - sizeof(size_t);
+    size_t blobsize_offset = *reinterpret_cast<size_t*>(first);
+    (*reinterpret_cast<size_t*>(first + blobsize_offset)) = oarc->size() - blobsize_offset - sizeof(size_t);
     // write the packet header
-    packet_hdr* hdr = reinterpret_cast<packet_hdr*>(oarc->buf);
-    hdr->len = oarc->off - sizeof(packet_hdr);
+    packet_hdr* hdr = reinterpret_cast<packet_hdr*>(first);
+    hdr->len = oarc->size() - sizeof(packet_hdr);
     hdr->src = _get_procid();
     hdr->packet_type_mask = flags;
     hdr->sequentialization_key = _get_sequentialization_key();
     size_t len = hdr->len;
-    write_thread_local_buffer(target, oarc->buf, oarc->off, flags & CONTROL_PACKET);
+    write_thread_local_buffer(target, *gather, oarc->buf, oarc->off, flags & CONTROL_PACKET);
+    delete gather;
     if ((flags & CONTROL_PACKET) == 0) {
       rmi->inc_bytes_sent(target, len);
     }
@@ -1,8 +1,26 @@
 #include <graphlab/rpc/thread_local_send_buffer.hpp>
 #include <graphlab/rpc/dc.hpp>
+#include <graphlab/util/timer.hpp>
 namespace graphlab {
 namespace dc_impl {
 
+namespace {
+  // appends a buffer to the chain of n buffer_elems from first to last
+  void append_buffer(buffer_elem*& first, buffer_elem*& last, size_t& n,
+                     char* ptr, size_t len) {
+    buffer_elem* elem = new buffer_elem;
+    ASSERT_NE(ptr, NULL);
+    elem->buf = ptr;
+    elem->len = len;
+    elem->next = NULL;
+    if (last == NULL) first = elem;
+    else last->next = elem;
+    last = elem;
+    ++n;
+  }
+} // anonymous namespace
+
+
 thread_local_buffer::thread_local_buffer() {
   // allocate the buffers
   dc = distributed_control::get_instance();
@@ -15,6 +33,8 @@ thread_local_buffer::thread_local_buffer() {
   current_archive.resize(nprocs); 
 
   archive_locks.resize(nprocs);
+  archive_start_time.resize(nprocs, 0);
+  send_class = BULK_SEND;
 
   bytes_sent.resize(nprocs, 0);
   dc->register_send_buffer(this);
@@ -50,7 +70,7 @@ void thread_local_buffer::push_flush() {
     if (bufs.first != NULL) {
       while(bufs.first != bufs.second) {
         buffer_elem* prev = bufs.first;
-        dc->write_to_buffer(i, bufs.first->buf, bufs.second->len);
+        dc->write_to_buffer(i, bufs.first->buf, bufs.first->len);
         buffer_elem** next = &bufs.first->next;
         volatile buffer_elem** n = (volatile buffer_elem**)(next);
         while(__unlikely__((*n) == NULL)) {
@@ -108,12 +128,33 @@ void thread_local_buffer::add_to_queue(procid_t target, char* ptr, size_t len) {
   }
 }
 
+void thread_local_buffer::add_to_queue(procid_t target, buffer_elem* first,
+                                       buffer_elem* last, size_t n) {
+  outbuf[target]->enqueue_chain(first, last, n);
+  if (outbuf[target]->approx_size() > NUM_FULL_BUFFER_LIMIT) {
+    pull_flush_soon(target);
+  }
+}
+
 void thread_local_buffer::release(procid_t target, bool do_not_count_bytes_sent) {
   if (!do_not_count_bytes_sent) {
     bytes_sent[target] += current_archive[target].off - prev_acquire_archive_size - sizeof(packet_hdr);
     inc_calls_sent(target);
   }
 
+  // decide whether the policy of this message class wants a flush.
+  // The full buffers waiting in outbuf count as FULL_BUFFER_SIZE_LIMIT each
+  const dc_flush_policy& policy = dc->get_flush_policy(send_class);
+  bool flush = policy.max_delay == 0 ||
+      current_archive[target].off +
+      outbuf[target]->approx_size() * FULL_BUFFER_SIZE_LIMIT >= policy.max_bytes;
+  if (!flush && policy.max_delay < SEND_POLL_TIMEOUT) {
+    // longer delays are covered by the sender polling the buffers
+    size_t now = timer::usec_of_day();
+    if (prev_acquire_archive_size == 0) archive_start_time[target] = now;
+    else flush = now - archive_start_time[target] >= policy.max_delay;
+  }
+
   if (current_archive[target].off >= FULL_BUFFER_SIZE_LIMIT) {
     // shift the buffer into outbuf
     char* ptr = current_archive[target].buf;
@@ -127,27 +168,49 @@ void thread_local_buffer::release(procid_t target, bool do_not_count_bytes_sent)
   } else {
     archive_locks[target].unlock();
   }
+  if (flush) pull_flush_soon(target);
+}
+
+
+dc_send_class thread_local_buffer::set_send_class(dc_send_class newclass) {
+  dc_send_class oldclass = send_class;
+  send_class = newclass;
+  return oldclass;
 }
 
 
 void thread_local_buffer::write(procid_t target, char* c, size_t len, 
                                 bool do_not_count_bytes_sent) {
+  write(target, oarchive_gather(), c, len, do_not_count_bytes_sent);
+}
+
+
+void thread_local_buffer::write(procid_t target, const oarchive_gather& gather,
+                                char* c, size_t len,
+                                bool do_not_count_bytes_sent) {
   if (!do_not_count_bytes_sent) {
-    bytes_sent[target] += len;
+    bytes_sent[target] += gather.length + len;
     inc_calls_sent(target);
   }
-  // make sure that messsages sent before this write are sent before this write
+  // chain the messages written before this one, the segments and c, and
+  // queue them as one unit. The sender extracts all of them or none.
+  buffer_elem* first = NULL;
+  buffer_elem* last = NULL;
+  size_t n = 0;
+  archive_locks[target].lock();
   if (current_archive[target].off) {
-    archive_locks[target].lock();
-
-    if (current_archive[target].off) {
-      add_to_queue(target, current_archive[target].buf, current_archive[target].off);
-    }
-    current_archive[target].buf = NULL; 
+    append_buffer(first, last, n, current_archive[target].buf,
+                  current_archive[target].off);
+    current_archive[target].buf = NULL;
     current_archive[target].off = 0;
-    archive_locks[target].unlock();
   }
-  add_to_queue(target, c, len);
+  for (size_t i = 0;i < gather.segments.size(); ++i) {
+    append_buffer(first, last, n, gather.segments[i].first,
+                  gather.segments[i].second);
+  }
+  append_buffer(first, last, n, c, len);
+  add_to_queue(target, first, last, n);
+  archive_locks[target].unlock();
 }
 
 
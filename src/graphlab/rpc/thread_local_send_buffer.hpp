@@ -19,6 +19,11 @@ struct thread_local_buffer {
   std::vector<mutex> archive_locks;
   std::vector<oarchive> current_archive;
   size_t prev_acquire_archive_size;
+  /// When the first message in current_archive was written (usec_of_day)
+  std::vector<size_t> archive_start_time;
+
+  /// The class of the messages this thread sends
+  dc_send_class send_class;
 
   procid_t procid;
   distributed_control* dc;
@@ -43,6 +48,21 @@ struct thread_local_buffer {
 
   void write(procid_t target, char* c, size_t len, bool do_not_count_bytes_sent);
 
+  /**
+   * Must be called from within the thread owning this buffer.
+   * As write(), for a message made of the segments of an oarchive in
+   * gather mode followed by c. Takes over all the buffers.
+   */
+  void write(procid_t target, const oarchive_gather& gather,
+             char* c, size_t len, bool do_not_count_bytes_sent);
+
+  /**
+   * Must be called from within the thread owning this buffer.
+   * Sets the class of the messages sent from now on, returning the
+   * previous class.
+   */
+  dc_send_class set_send_class(dc_send_class newclass);
+
   /**
    * Must be called from within the thread owning this buffer.
    * Flushes the buffer to the sender. This should really only be used
@@ -92,6 +112,10 @@ struct thread_local_buffer {
   void inc_calls_sent(procid_t target);
 
   void add_to_queue(procid_t target, char* ptr, size_t len);
+
+  /// Queues the n buffers from first to last, linked by next, as one unit
+  void add_to_queue(procid_t target, buffer_elem* first, buffer_elem* last,
+                    size_t n);
 };
 }
 }
@@ -0,0 +1,258 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <graphlab/scheduler/bucket_scheduler.hpp>
+#include <graphlab/macros_def.hpp>
+namespace graphlab {
+
+void bucket_scheduler::set_options(const graphlab_options& opts) {
+  nbags = opts.get_ncpus();
+  std::vector<std::string> keys = opts.get_scheduler_args().get_option_keys();
+  foreach(std::string opt, keys) {
+    if (opt == "delta") {
+      opts.get_scheduler_args().get_option("delta", delta);
+      if (!(delta > 0)) {
+        logstream(LOG_FATAL) << "delta must be positive" << std::endl;
+      }
+    } else {
+      logstream(LOG_FATAL) << "Unexpected Scheduler Option: " << opt << std::endl;
+    }
+  }
+}
+
+// Initializes the internal datastructures
+void bucket_scheduler::initialize_data_structures() {
+  bags.resize(NUM_BUCKETS * nbags);
+  vertex_is_scheduled.resize(num_vertices);
+  vertex_priority.resize(num_vertices);
+}
+
+bucket_scheduler::bucket_scheduler(size_t num_vertices,
+                                   const graphlab_options& opts):
+    overflow_first(std::numeric_limits<int64_t>::max()),
+    current(0), delta(1.0), num_vertices(num_vertices) {
+  ASSERT_GE(opts.get_ncpus(), 1);
+  set_options(opts);
+  initialize_data_structures();
+}
+
+
+void bucket_scheduler::set_num_vertices(const lvid_type numv) {
+  num_vertices = numv;
+  vertex_is_scheduled.resize(numv);
+  vertex_priority.resize(numv);
+}
+
+
+int64_t bucket_scheduler::bucket_of(double priority) const {
+  // keep infinite priorities well inside the range of the window arithmetic
+  const double limit = double(int64_t(1) << 60);
+  const double b = std::floor(-priority / delta);
+  if (b != b) return 0;
+  return int64_t(std::max(-limit, std::min(limit, b)));
+}
+
+
+void bucket_scheduler::push(const entry_type& entry) {
+  while (1) {
+    const int64_t first = current;
+    if (entry.second < first + int64_t(NUM_BUCKETS)) {
+      // earlier buckets are run with the current one
+      const size_t slot = size_t(std::max(entry.second, first)) % NUM_BUCKETS;
+      // skip bags another thread is working on, but do not spin forever
+      size_t j = random::fast_uniform(size_t(0), nbags - 1);
+      bag_type* bag = NULL;
+      bool locked = false;
+      for (size_t i = 0; i < nbags && !locked; ++i, j = (j + 1) % nbags) {
+        bag = &bags[slot * nbags + j].value;
+        locked = bag->lock.try_lock();
+      }
+      if (!locked) bag->lock.lock();
+      bag->entries.push_back(entry);
+      bag->size = bag->entries.size();
+      bag->lock.unlock();
+      return;
+    }
+    bag_type& bag = overflow.value;
+    bag.lock.lock();
+    // the window may have moved, and spilled the overflow, since
+    // current was read
+    if (entry.second >= current + int64_t(NUM_BUCKETS)) {
+      bag.entries.push_back(entry);
+      bag.size = bag.entries.size();
+      overflow_first = std::min(int64_t(overflow_first), entry.second);
+      bag.lock.unlock();
+      return;
+    }
+    bag.lock.unlock();
+  }
+}
+
+
+void bucket_scheduler::spill_overflow() {
+  const int64_t end = current + int64_t(NUM_BUCKETS);
+  if (overflow_first >= end) return;
+  bag_type& bag = overflow.value;
+  bag.lock.lock();
+  size_t nkeep = 0;
+  int64_t first = std::numeric_limits<int64_t>::max();
+  for (size_t i = 0; i < bag.entries.size(); ++i) {
+    const entry_type entry = bag.entries[i];
+    // drop the entries of vertices which already ran
+    if (entry.first >= num_vertices ||
+        !vertex_is_scheduled.get(entry.first)) continue;
+    if (entry.second < end) {
+      push(entry);
+    } else {
+      bag.entries[nkeep++] = entry;
+      first = std::min(first, entry.second);
+    }
+  }
+  bag.entries.resize(nkeep);
+  bag.size = nkeep;
+  overflow_first = first;
+  bag.lock.unlock();
+}
+
+
+void bucket_scheduler::schedule(const lvid_type vid, double priority) {
+  if (vid >= num_vertices) return;
+  const int64_t bucket = bucket_of(priority);
+  if (!vertex_is_scheduled.set_bit(vid)) {
+    vertex_priority[vid] = priority;
+    push(entry_type(vid, bucket));
+  } else if (priority > vertex_priority[vid]) {
+    // only a move to an earlier bucket needs a second entry
+    const int64_t old_bucket = bucket_of(vertex_priority[vid]);
+    vertex_priority[vid] = priority;
+    if (bucket < old_bucket) push(entry_type(vid, bucket));
+  }
+}
+
+
+bool bucket_scheduler::pop_bucket(size_t slot, size_t cpuid,
+                                  lvid_type& ret_vid) {
+  for (size_t i = 0; i < nbags; ++i) {
+    bag_type& bag = bags[slot * nbags + (cpuid + i) % nbags].value;
+    if (bag.size == 0) continue;
+    bool good = false;
+    bag.lock.lock();
+    while (!bag.entries.empty()) {
+      ret_vid = bag.entries.back().first;
+      bag.entries.pop_back();
+      // the other entry of a promoted vertex fails to clear the bit
+      if (ret_vid < num_vertices && vertex_is_scheduled.clear_bit(ret_vid)) {
+        good = true;
+        break;
+      }
+    }
+    bag.size = bag.entries.size();
+    bag.lock.unlock();
+    if (good) return true;
+  }
+  return false;
+}
+
+
+bool bucket_scheduler::advance(int64_t from) {
+  advance_lock.lock();
+  if (current != from) {
+    advance_lock.unlock();
+    return true;
+  }
+  // the next nonempty bucket of the window. The overflow only holds
+  // buckets beyond the window.
+  for (int64_t b = from + 1; b < from + int64_t(NUM_BUCKETS); ++b) {
+    const size_t slot = size_t(b) % NUM_BUCKETS;
+    for (size_t j = 0; j < nbags; ++j) {
+      if (bags[slot * nbags + j].value.size > 0) {
+        current = b;
+        spill_overflow();
+        advance_lock.unlock();
+        return true;
+      }
+    }
+  }
+  // the window is empty. Restart it at the first bucket of the overflow
+  bag_type& bag = overflow.value;
+  bag.lock.lock();
+  int64_t first = 0;
+  bool found = false;
+  foreach(const entry_type& entry, bag.entries) {
+    if (entry.first < num_vertices && vertex_is_scheduled.get(entry.first)) {
+      first = found ? std::min(first, entry.second) : entry.second;
+      found = true;
+    }
+  }
+  bag.lock.unlock();
+  if (found) {
+    current = std::max(first, from);
+    spill_overflow();
+  }
+  advance_lock.unlock();
+  return found;
+}
+
+
+/** Get the next element in the queue */
+sched_status::status_enum bucket_scheduler::get_next(const size_t cpuid,
+                                                     lvid_type& ret_vid) {
+  while (1) {
+    const int64_t first = current;
+    if (pop_bucket(size_t(first) % NUM_BUCKETS, cpuid, ret_vid)) {
+      return sched_status::NEW_TASK;
+    }
+    if (!advance(first)) break;
+  }
+  // entries pushed into a slot just as the window moved past it
+  for (size_t slot = 0; slot < NUM_BUCKETS; ++slot) {
+    if (pop_bucket(slot, cpuid, ret_vid)) return sched_status::NEW_TASK;
+  }
+  return sched_status::EMPTY;
+} // end of get_next_task
+
+
+bool bucket_scheduler::empty() {
+  for (size_t i = 0; i <= bags.size(); ++i) {
+    bag_type& bag = (i < bags.size()) ? bags[i].value : overflow.value;
+    if (bag.size == 0) continue;
+    // entries of vertices which already ran do not count as work
+    bag.lock.lock();
+    size_t nkeep = 0;
+    for (size_t j = 0; j < bag.entries.size(); ++j) {
+      const lvid_type vid = bag.entries[j].first;
+      if (vid < num_vertices && vertex_is_scheduled.get(vid)) {
+        bag.entries[nkeep++] = bag.entries[j];
+      }
+    }
+    bag.entries.resize(nkeep);
+    bag.size = nkeep;
+    bag.lock.unlock();
+    if (nkeep > 0) return false;
+  }
+  return true;
+}
+
+}
@@ -0,0 +1,158 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+
+#ifndef GRAPHLAB_BUCKET_SCHEDULER_HPP
+#define GRAPHLAB_BUCKET_SCHEDULER_HPP
+
+#include <vector>
+#include <utility>
+#include <stdint.h>
+
+#include <graphlab/graph/graph_basic_types.hpp>
+#include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/parallel/cache_line_pad.hpp>
+
+#include <graphlab/util/random.hpp>
+#include <graphlab/scheduler/ischeduler.hpp>
+#include <graphlab/util/dense_bitset.hpp>
+
+#include <graphlab/options/graphlab_options.hpp>
+
+namespace graphlab {
+
+  /**
+   * \ingroup group_schedulers
+   *
+   * This class defines a delta-stepping scheduler. A vertex scheduled
+   * with priority p goes into bucket floor(-p / delta), and the buckets
+   * are run in increasing order. Within a bucket the order is
+   * arbitrary. This suits programs whose priorities are monotone, such
+   * as the negated tentative distance of shortest paths: a bucket costs
+   * no more than a push and a pop on an unordered bag, instead of a
+   * heap operation per signal.
+   *
+   * A window of NUM_BUCKETS buckets starting at the current one is held
+   * in a ring. Every bucket is made of one bag per thread, each with its
+   * own lock. Vertices beyond the window wait in an overflow bag, and
+   * are spilled into their buckets as soon as the window moves far
+   * enough to reach them. Vertices scheduled into a bucket before the
+   * current one are run with the current bucket.
+   *
+   * Raising the priority of a scheduled vertex into an earlier bucket
+   * adds a second entry. Whichever entry is popped first runs the
+   * vertex and the other one is dropped.
+   */
+  class bucket_scheduler : public ischeduler {
+
+  public:
+    /// The number of buckets held in the ring
+    static const size_t NUM_BUCKETS = 256;
+
+    /// A bag entry: the vertex and the bucket it was scheduled into
+    typedef std::pair<lvid_type, int64_t> entry_type;
+
+  private:
+
+    struct bag_type {
+      simple_spinlock lock;
+      // the number of entries. Read without the lock.
+      volatile size_t size;
+      std::vector<entry_type> entries;
+      bag_type() : size(0) { }
+    };
+
+    // a bitset denoting if a vertex is scheduled
+    dense_bitset vertex_is_scheduled;
+    // the priority of every scheduled vertex
+    std::vector<double> vertex_priority;
+    // NUM_BUCKETS * nbags bags. Bag j of bucket b is
+    // bags[(b % NUM_BUCKETS) * nbags + j]
+    std::vector<cache_line_pad<bag_type> > bags;
+    // the vertices in buckets beyond the window
+    cache_line_pad<bag_type> overflow;
+    // the first bucket in the overflow bag. Written under its lock.
+    volatile int64_t overflow_first;
+    // serializes moving the window forward
+    mutex advance_lock;
+    // the first bucket of the window
+    volatile int64_t current;
+
+    // the number of bags per bucket
+    size_t nbags;
+    // the width of a bucket
+    double delta;
+    // the number of vertices in the graph
+    size_t num_vertices;
+
+    void set_options(const graphlab_options& opts);
+
+    // Initializes the internal datastructures
+    void initialize_data_structures();
+
+    // The bucket of a priority
+    int64_t bucket_of(double priority) const;
+
+    // Adds the entry to its bucket, or to the overflow bag
+    void push(const entry_type& entry);
+
+    /**
+     * Moves the overflow entries which the window reaches into their
+     * buckets. Called with advance_lock held after moving the window.
+     */
+    void spill_overflow();
+
+    // Pops a scheduled vertex from the bags of the bucket at ring slot
+    bool pop_bucket(size_t slot, size_t cpuid, lvid_type& ret_vid);
+
+    /**
+     * Moves the window to the next nonempty bucket after bucket
+     * from. Returns false if there is nothing left to run.
+     */
+    bool advance(int64_t from);
+
+  public:
+
+    bucket_scheduler(size_t num_vertices, const graphlab_options& opts);
+
+    void set_num_vertices(const lvid_type numv);
+
+    void schedule(const lvid_type vid, double priority = 1);
+
+    /** Get the next element in the queue */
+    sched_status::status_enum get_next(const size_t cpuid,
+                                       lvid_type& ret_vid);
+
+    bool empty();
+
+    static void print_options_help(std::ostream& out) {
+      out << "\t delta = [double, the priority range of a bucket. "
+          << "Default = 1]\n";
+    }
+
+
+  };
+
+
+} // end of namespace graphlab
+
+#endif
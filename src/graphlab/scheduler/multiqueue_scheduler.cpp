@@ -0,0 +1,177 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+
+#include <graphlab/scheduler/multiqueue_scheduler.hpp>
+#include <graphlab/macros_def.hpp>
+namespace graphlab {
+
+void multiqueue_scheduler::set_options(const graphlab_options& opts) {
+  ncpus = opts.get_ncpus();
+  std::vector<std::string> keys = opts.get_scheduler_args().get_option_keys();
+  foreach(std::string opt, keys) {
+    if (opt == "multi") {
+      opts.get_scheduler_args().get_option("multi", multi);
+    } else if (opt == "min_priority") {
+      opts.get_scheduler_args().get_option("min_priority", min_priority);
+    }  else {
+      logstream(LOG_FATAL) << "Unexpected Scheduler Option: " << opt << std::endl;
+    }
+  }
+}
+
+// Initializes the internal datastructures
+void multiqueue_scheduler::initialize_data_structures() {
+  // two choices need at least two heaps
+  heaps.resize(std::max(multi * ncpus, size_t(2)));
+  vertex_is_scheduled.resize(num_vertices);
+  vertex_priority.resize(num_vertices);
+}
+
+multiqueue_scheduler::multiqueue_scheduler(size_t num_vertices,
+                                           const graphlab_options& opts):
+    multi(2),
+    min_priority(-std::numeric_limits<double>::max()),
+    num_vertices(num_vertices) {
+  ASSERT_GE(opts.get_ncpus(), 1);
+  set_options(opts);
+  initialize_data_structures();
+}
+
+
+void multiqueue_scheduler::set_num_vertices(const lvid_type numv) {
+  num_vertices = numv;
+  vertex_is_scheduled.resize(numv);
+  vertex_priority.resize(numv);
+}
+
+
+void multiqueue_scheduler::push(const entry_type& entry) {
+  // skip heaps another thread is working on, but do not spin forever
+  size_t idx = random::fast_uniform(size_t(0), heaps.size() - 1);
+  bool locked = heaps[idx].value.lock.try_lock();
+  for (size_t i = 0; i < heaps.size() && !locked; ++i) {
+    idx = random::fast_uniform(size_t(0), heaps.size() - 1);
+    locked = heaps[idx].value.lock.try_lock();
+  }
+  heap_type& heap = heaps[idx].value;
+  if (!locked) heap.lock.lock();
+  heap.entries.push_back(entry);
+  std::push_heap(heap.entries.begin(), heap.entries.end());
+  heap.top = heap.entries.front().first;
+  heap.lock.unlock();
+}
+
+
+void multiqueue_scheduler::schedule(const lvid_type vid, double priority) {
+  if (vid >= num_vertices) return;
+  if (!vertex_is_scheduled.set_bit(vid)) {
+    vertex_priority[vid] = priority;
+    push(entry_type(priority, vid));
+  } else if (priority > vertex_priority[vid]) {
+    // lazy decrease-key: the old entry goes stale and is dropped on pop.
+    // Racing updates may lose a promotion, which only affects the order.
+    vertex_priority[vid] = priority;
+    push(entry_type(priority, vid));
+  }
+}
+
+
+bool multiqueue_scheduler::is_current(const entry_type& entry) const {
+  // the priority of a scheduled vertex only changes after pushing an
+  // entry with the new priority, so at most the newest entry matches
+  return entry.second < num_vertices &&
+      vertex_is_scheduled.get(entry.second) &&
+      vertex_priority[entry.second] == entry.first;
+}
+
+
+bool multiqueue_scheduler::pop_locked(heap_type& heap, lvid_type& ret_vid) {
+  bool good = false;
+  while (!heap.entries.empty() && heap.entries.front().first >= min_priority) {
+    std::pop_heap(heap.entries.begin(), heap.entries.end());
+    const entry_type entry = heap.entries.back();
+    heap.entries.pop_back();
+    ret_vid = entry.second;
+    // stale entries of vertices which already ran fail to clear the bit
+    if (is_current(entry) && vertex_is_scheduled.clear_bit(ret_vid)) {
+      good = true;
+      break;
+    }
+  }
+  heap.top = heap.entries.empty() ?
+      -std::numeric_limits<double>::infinity() : heap.entries.front().first;
+  return good;
+}
+
+
+/** Get the next element in the queue */
+sched_status::status_enum multiqueue_scheduler::get_next(const size_t cpuid,
+                                                         lvid_type& ret_vid) {
+  // two random choices while they find work
+  const size_t nheaps = heaps.size();
+  for (size_t attempt = 0; attempt < nheaps; ++attempt) {
+    const size_t i = random::fast_uniform(size_t(0), nheaps - 1);
+    size_t j = random::fast_uniform(size_t(0), nheaps - 2);
+    if (j >= i) ++j;
+    const size_t idx = (heaps[i].value.top >= heaps[j].value.top) ? i : j;
+    heap_type& heap = heaps[idx].value;
+    // both look empty. Fall through to the scan below
+    if (heap.top < min_priority) break;
+    if (!heap.lock.try_lock()) continue;
+    const bool good = pop_locked(heap, ret_vid);
+    heap.lock.unlock();
+    if (good) return sched_status::NEW_TASK;
+  }
+  // scan all heaps before reporting that there is nothing to do
+  const size_t initial_idx = random::fast_uniform(size_t(0), nheaps - 1);
+  for (size_t i = 0; i < nheaps; ++i) {
+    heap_type& heap = heaps[(initial_idx + i) % nheaps].value;
+    if (heap.top < min_priority) continue;
+    heap.lock.lock();
+    const bool good = pop_locked(heap, ret_vid);
+    heap.lock.unlock();
+    if (good) return sched_status::NEW_TASK;
+  }
+  return sched_status::EMPTY;
+} // end of get_next_task
+
+
+bool multiqueue_scheduler::empty() {
+  for (size_t i = 0;i < heaps.size(); ++i) {
+    heap_type& heap = heaps[i].value;
+    if (heap.top < min_priority) continue;
+    // stale entries do not count as work
+    heap.lock.lock();
+    while (!heap.entries.empty() && !is_current(heap.entries.front())) {
+      std::pop_heap(heap.entries.begin(), heap.entries.end());
+      heap.entries.pop_back();
+    }
+    heap.top = heap.entries.empty() ?
+        -std::numeric_limits<double>::infinity() : heap.entries.front().first;
+    heap.lock.unlock();
+    if (heap.top >= min_priority) return false;
+  }
+  return true;
+}
+
+}
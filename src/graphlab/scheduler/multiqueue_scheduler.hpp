@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+
+#ifndef GRAPHLAB_MULTIQUEUE_SCHEDULER_HPP
+#define GRAPHLAB_MULTIQUEUE_SCHEDULER_HPP
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <utility>
+
+#include <graphlab/graph/graph_basic_types.hpp>
+#include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/parallel/cache_line_pad.hpp>
+
+#include <graphlab/util/random.hpp>
+#include <graphlab/scheduler/ischeduler.hpp>
+#include <graphlab/util/dense_bitset.hpp>
+
+#include <graphlab/options/graphlab_options.hpp>
+
+namespace graphlab {
+
+  /**
+   * \ingroup group_schedulers
+   *
+   * This class defines a relaxed concurrent priority scheduler (a
+   * MultiQueue). Tasks are pushed into one of multi * ncpus binary
+   * heaps chosen at random. A thread pops from the better of two random
+   * heaps, comparing their top priorities without locking. Heaps are
+   * only ever try-locked on the fast path, so threads do not wait for
+   * each other, and the tasks returned are close to the globally
+   * highest priority ones.
+   *
+   * Rescheduling an already scheduled vertex with a higher priority
+   * does not update the heaps in place. A second entry is pushed and
+   * the stale one is dropped when popped (lazy decrease-key). The
+   * current priority of every scheduled vertex is kept in a per vertex
+   * array and only the entry holding it is run.
+   */
+  class multiqueue_scheduler : public ischeduler {
+
+  public:
+
+    /// A heap entry: the priority and the vertex
+    typedef std::pair<double, lvid_type> entry_type;
+
+  private:
+
+    struct heap_type {
+      simple_spinlock lock;
+      // the top priority, -inf when empty. Read without the lock.
+      volatile double top;
+      std::vector<entry_type> entries;
+      heap_type() : top(-std::numeric_limits<double>::infinity()) { }
+    };
+
+    // a bitset denoting if a vertex is scheduled
+    dense_bitset vertex_is_scheduled;
+    // the priority of every scheduled vertex
+    std::vector<double> vertex_priority;
+    // the heaps, padded to a cache line each
+    std::vector<cache_line_pad<heap_type> > heaps;
+
+    // the number of CPUs
+    size_t ncpus;
+    // The heap to CPU ratio
+    size_t multi;
+    double min_priority;
+    // the number of vertices in the graph
+    size_t num_vertices;
+
+    void set_options(const graphlab_options& opts);
+
+    // Initializes the internal datastructures
+    void initialize_data_structures();
+
+    // Pushes an entry into a random heap which is not locked
+    void push(const entry_type& entry);
+
+    // True if the entry holds the current priority of a scheduled vertex
+    bool is_current(const entry_type& entry) const;
+
+    // Pops the best scheduled vertex of a locked heap
+    bool pop_locked(heap_type& heap, lvid_type& ret_vid);
+  public:
+
+    multiqueue_scheduler(size_t num_vertices, const graphlab_options& opts);
+
+    void set_num_vertices(const lvid_type numv);
+
+    void schedule(const lvid_type vid, double priority = 1);
+
+    /** Get the next element in the queue */
+    sched_status::status_enum get_next(const size_t cpuid,
+                                       lvid_type& ret_vid);
+
+    bool empty();
+
+    static void print_options_help(std::ostream& out) {
+      out << "\t multi = [number of heaps per thread. Default = 2].\n"
+          << "min_priority = [double, minimum priority required to receive \n"
+          << "\t a message, default = -inf]\n";
+    }
+
+
+  };
+
+
+} // end of namespace graphlab
+
+#endif
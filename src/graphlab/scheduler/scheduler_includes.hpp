@@ -22,9 +22,11 @@
 #ifndef GRAPHLAB_SCHEDULER_INCLUDES_HPP
 #define GRAPHLAB_SCHEDULER_INCLUDES_HPP
 
+#include <graphlab/scheduler/bucket_scheduler.hpp>
 #include <graphlab/scheduler/fifo_scheduler.hpp>
 #include <graphlab/scheduler/get_message_priority.hpp>
 #include <graphlab/scheduler/ischeduler.hpp>
+#include <graphlab/scheduler/multiqueue_scheduler.hpp>
  #include <graphlab/scheduler/priority_scheduler.hpp>
 #include <graphlab/scheduler/queued_fifo_scheduler.hpp>
 #include <graphlab/scheduler/scheduler_factory.hpp>
@@ -43,12 +43,23 @@
     "This scheduler maintains a shared FIFO queue of FIFO queues. "     \
     "Each thread maintains its own smaller in and out queues. When a "  \
     "threads out queue is too large (greater than \"queuesize\") then " \
-    "the thread puts its out queue at the end of the master queue."))   
+    "the thread puts its out queue at the end of the master queue."))   \
+  (("multiqueue", multiqueue_scheduler,                                 \
+    "Relaxed concurrent priority queue. Threads pop from the better "   \
+    "of two random heaps, so the order is only approximately by "       \
+    "priority, but it scales much better than \"priority\"."))          \
+  (("buckets", bucket_scheduler,                                        \
+    "Delta-stepping scheduler. Vertices are grouped into buckets of "   \
+    "width \"delta\" by priority and the buckets are run in order, "    \
+    "highest priority first. Suited to monotone priorities such as "    \
+    "shortest path distances."))
 
 #include <graphlab/scheduler/fifo_scheduler.hpp>
 #include <graphlab/scheduler/sweep_scheduler.hpp>
 #include <graphlab/scheduler/priority_scheduler.hpp>
 #include <graphlab/scheduler/queued_fifo_scheduler.hpp>
+#include <graphlab/scheduler/multiqueue_scheduler.hpp>
+#include <graphlab/scheduler/bucket_scheduler.hpp>
 
 
 namespace graphlab {
@@ -32,6 +32,8 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <utility>
 #include <graphlab/logger/assertions.hpp>
 #include <graphlab/serialization/is_pod.hpp>
 #include <graphlab/serialization/has_save.hpp>
@@ -83,25 +85,63 @@ namespace graphlab {
    * To use this class, include
    * graphlab/serialization/serialization_includes.hpp
    */
+  /**
+   * \ingroup group_serialization
+   * The filled buffers of an oarchive in gather mode. See
+   * oarchive::gather
+   */
+  struct oarchive_gather {
+    /// The malloc'ed buffers and their lengths, in order
+    std::vector<std::pair<char*, size_t> > segments;
+    /// The total length of the segments
+    size_t length;
+    oarchive_gather(): length(0) { }
+  };
+
   class oarchive{
   public:
     std::ostream* out;
     char* buf;
     size_t off;
     size_t len;
+    /**
+     * If not NULL, the archive is in gather mode. Instead of growing buf
+     * by reallocating it, which copies everything written so far, a
+     * full buf is moved to the segments and a new one, twice as large,
+     * allocated. Every byte is then copied
+     * into the archive once, and the output is the segments followed by
+     * buf, which can be sent with a single gather write. Only
+     * \ref graphlab::oarchive::size counts the bytes in the segments.
+     * The owner of the archive frees the segments.
+     */
+    oarchive_gather* gather;
+
     /// constructor. Takes a generic std::ostream object
     inline oarchive(std::ostream& outstream)
-      : out(&outstream),buf(NULL),off(0),len(0) {}
+      : out(&outstream),buf(NULL),off(0),len(0),gather(NULL) {}
 
     inline oarchive(void)
-      : out(NULL),buf(NULL),off(0),len(0) {}
+      : out(NULL),buf(NULL),off(0),len(0),gather(NULL) {}
 
     inline void expand_buf(size_t s) {
         if (__unlikely__(off + s > len)) {
-          len = 2 * (s + len);
-          buf = (char*)realloc(buf, len);
+          if (gather != NULL && off > 0) {
+            gather->segments.push_back(std::make_pair(buf, off));
+            gather->length += off;
+            len = 2 * (s + len);
+            buf = (char*)malloc(len);
+            off = 0;
+          } else {
+            len = 2 * (s + len);
+            buf = (char*)realloc(buf, len);
+          }
         }
      }
+
+    /// The number of bytes written to a buffer backed archive
+    inline size_t size() const {
+      return gather == NULL ? off : gather->length + off;
+    }
     /** Directly writes "s" bytes from the memory location
      * pointed to by "c" into the stream.
      */
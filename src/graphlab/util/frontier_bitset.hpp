@@ -0,0 +1,232 @@
+/**  
+ * Copyright (c) 2009 Carnegie Mellon University. 
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+
+
+#ifndef GRAPHLAB_FRONTIER_BITSET_HPP
+#define GRAPHLAB_FRONTIER_BITSET_HPP
+
+#include <vector>
+#include <algorithm>
+#include <graphlab/util/dense_bitset.hpp>
+#include <graphlab/parallel/atomic.hpp>
+#include <graphlab/parallel/cache_line_pad.hpp>
+#include <graphlab/parallel/pthread_tools.hpp>
+
+namespace graphlab {
+
+  /**  \ingroup util
+   * An atomic bitset over [0, size()) which also keeps the positions of
+   * the set bits in an unordered list while few bits are set.
+   *
+   * Setting a bit appends its position to the list. Once the list would
+   * take more memory than the bitset itself (more than
+   * size() / (8 * sizeof(IndexType)) positions) it is abandoned and the
+   * set becomes "dense". Iteration (through prepare() and next_block())
+   * and clear() cost O(number of set bits) for a sparse set and
+   * O(size() / word size) for a dense one.
+   *
+   * Bits may be set and cleared concurrently. Bits set after prepare()
+   * are not guaranteed to be returned by next_block() until the next
+   * prepare().
+   *
+   * The number of set bits is kept in one counter per thread, each on
+   * its own cache line, so that threads activating vertices do not
+   * contend on a shared counter. count() sums them and is exact once
+   * the threads setting and clearing bits have reached a barrier.
+   */
+  template <typename IndexType>
+  class frontier_bitset {
+  public:
+    frontier_bitset() :
+      nset(std::max<size_t>(thread::cpu_count(), 1)),
+      nprepared(0), prepared_sparse(false) { }
+
+    /// Resizes to n bits, keeping existing bits. The set becomes dense.
+    void resize(size_t n) {
+      bits.resize(n);
+      list.resize(n / (8 * sizeof(IndexType)) + 1);
+      nlist = list.size() + 1;
+      reset_count(bits.popcount());
+      nprepared = 0; prepared_sparse = false;
+    }
+
+    /// Clears all bits. The set becomes sparse.
+    void clear() {
+      if (is_sparse()) {
+        for (size_t i = 0; i < nlist.value; ++i) bits.clear_bit_unsync(list[i]);
+      } else {
+        bits.clear();
+      }
+      nlist = 0;
+      reset_count(0);
+      nprepared = 0; prepared_sparse = false;
+    }
+
+    /// Sets all bits. The set becomes dense.
+    void fill() {
+      bits.fill();
+      nlist = list.size() + 1;
+      reset_count(size());
+    }
+
+    inline size_t size() const { return bits.size(); }
+
+    inline bool get(size_t b) const { return bits.get(b); }
+
+    //! Atomically sets the bit at position b to true returning the old value
+    inline bool set_bit(size_t b) {
+      if (bits.set_bit(b)) return true;
+      local_count().inc();
+      // once dense the list is no longer written, so leave its counter
+      // alone rather than bouncing its cache line between threads
+      if (is_sparse()) {
+        const size_t idx = nlist.inc_ret_last();
+        if (idx < list.size()) list[idx] = IndexType(b);
+      }
+      return false;
+    }
+
+    //! Atomically sets the bit at b to false returning the old value
+    inline bool clear_bit(size_t b) {
+      // the position stays in the list and is skipped by next_block()
+      if (!bits.clear_bit(b)) return false;
+      local_count().dec();
+      return true;
+    }
+
+    /**
+     * Returns the number of set bits. Only exact when no bits are being
+     * set or cleared concurrently.
+     */
+    size_t count() const {
+      // a thread may clear bits counted by another thread, so single
+      // counters can wrap around but their sum cannot
+      size_t total = 0;
+      for (size_t i = 0; i < nset.size(); ++i) total += nset[i].value.value;
+      return total;
+    }
+
+    /// Returns true while the set bits are tracked in the list
+    inline bool is_sparse() const { return nlist.value <= list.size(); }
+
+    /**
+     * Must be called by a single thread before iterating with
+     * next_block(). Sorts the list of a sparse set for locality and
+     * drops duplicates left by clear_bit() followed by set_bit().
+     * The mode is fixed until the next prepare() even if concurrent
+     * set_bit() calls make the set dense in the meantime.
+     */
+    void prepare() {
+      prepared_sparse = is_sparse();
+      if (prepared_sparse) {
+        typename std::vector<IndexType>::iterator end = list.begin() + nlist.value;
+        std::sort(list.begin(), end);
+        nlist = std::unique(list.begin(), end) - list.begin();
+        nprepared = nlist.value;
+      } else {
+        nprepared = size();
+      }
+    }
+
+    /**
+     * Claims the next block of up to 64 positions from the shared
+     * counter, which must be zero at the start of the iteration, and
+     * fills out with the positions in the block whose bits are set.
+     * Returns false once the set is exhausted. Safe to call from
+     * several threads sharing the same counter.
+     */
+    bool next_block(atomic<size_t>& counter, std::vector<IndexType>& out) {
+      const size_t WORD_SIZE = 8 * sizeof(size_t);
+      const size_t block_start = counter.inc_ret_last(WORD_SIZE);
+      get_block(block_start, block_start + WORD_SIZE, out);
+      return block_start < nprepared;
+    }
+
+    /**
+     * The number of slots iterated over since the last prepare(): list
+     * positions for a sparse set, bits for a dense one. Callers which
+     * split the iteration themselves use slots [0, num_slots()) with
+     * slot_index() and get_block().
+     */
+    inline size_t num_slots() const { return nprepared; }
+
+    /// True if the slots are list positions, false if they are bits
+    inline bool slots_are_sparse() const { return prepared_sparse; }
+
+    /// The bit position iterated at slot i, which may be cleared.
+    inline IndexType slot_index(size_t i) const {
+      return prepared_sparse ? list[i] : IndexType(i);
+    }
+
+    /// Fills out with the positions of the set bits at slots [begin, end)
+    void get_block(size_t begin, size_t end, std::vector<IndexType>& out) {
+      const size_t WORD_SIZE = 8 * sizeof(size_t);
+      out.clear();
+      end = std::min(end, nprepared);
+      if (prepared_sparse) {
+        for (size_t i = begin; i < end; ++i) {
+          if (bits.get(list[i])) out.push_back(list[i]);
+        }
+        return;
+      }
+      for (size_t b = begin; b < end; b = b - b % WORD_SIZE + WORD_SIZE) {
+        const size_t word_start = b - b % WORD_SIZE;
+        size_t word = bits.containing_word(b) & (~size_t(0) << (b - word_start));
+        if (end - word_start < WORD_SIZE) {
+          word &= (size_t(1) << (end - word_start)) - 1;
+        }
+        while (word != 0) {
+          const size_t offset = __builtin_ctzl(word);
+          word &= word - 1;
+          out.push_back(IndexType(word_start + offset));
+        }
+      }
+    }
+
+  private:
+    dense_bitset bits;
+    /// positions of the set bits while sparse
+    std::vector<IndexType> list;
+    /// number of positions appended to the list. Larger than the
+    /// list once the set is dense.
+    atomic<size_t> nlist;
+    /// number of set bits, split over the threads
+    std::vector<cache_line_pad<atomic<size_t> > > nset;
+    /// number of positions (sparse) or bits (dense) to iterate over
+    size_t nprepared;
+    /// whether nprepared counts list positions
+    bool prepared_sparse;
+
+    inline atomic<size_t>& local_count() {
+      return nset[thread::thread_id() % nset.size()].value;
+    }
+
+    void reset_count(size_t n) {
+      for (size_t i = 0; i < nset.size(); ++i) nset[i].value = 0;
+      nset[0].value = n;
+    }
+  }; // end of frontier_bitset
+
+} // end of namespace graphlab
+
+#endif
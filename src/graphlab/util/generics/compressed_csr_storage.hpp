@@ -0,0 +1,216 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+#ifndef GRAPHLAB_COMPRESSED_CSR_STORAGE
+#define GRAPHLAB_COMPRESSED_CSR_STORAGE
+
+#include <vector>
+
+#include <graphlab/logger/assertions.hpp>
+#include <graphlab/serialization/iarchive.hpp>
+#include <graphlab/serialization/oarchive.hpp>
+#include <graphlab/util/mapped_image.hpp>
+
+namespace graphlab {
+  /// The position of a sequential decode of one compressed_csr_storage list
+  template <typename idtype, typename sizetype>
+  struct compressed_csr_cursor {
+    const unsigned char* pos;
+    idtype id;
+    sizetype aux;
+  };
+
+  /**
+   * A read-only version of csr_storage for lists of integer ids, such
+   * as adjacency lists.
+   *
+   * The ids of each key must be sorted. They are stored as byte
+   * aligned varints (7 bits per byte, the high bit marks a following
+   * byte): every id as the zigzag encoded difference to the previous id
+   * of the list, or to the key for the first one. If WithAux is set
+   * every id is followed by one more unsigned varint value, typically a
+   * small offset.
+   *
+   * The lists can only be decoded sequentially through a cursor:
+   * \code
+   * typename storage_type::cursor c;
+   * storage.start(key, c);
+   * for (size_t i = 0; i < storage.degree(key); ++i) {
+   *   storage.next(c);
+   *   // use c.id and c.aux
+   * }
+   * \endcode
+   */
+  template <typename idtype, bool WithAux, typename sizetype=size_t>
+  class compressed_csr_storage {
+   public:
+     typedef compressed_csr_cursor<idtype, sizetype> cursor;
+
+   public:
+     compressed_csr_storage() : nvalues(0) { }
+
+     /**
+      * Encodes the lists given in the layout of csr_storage: the ids of
+      * key i are ids[index[i]] to ids[index[i+1]] (or the end of ids
+      * for the last key). If WithAux is set aux must hold one value per
+      * id.
+      */
+     void init(const std::vector<sizetype>& index,
+               const std::vector<idtype>& ids,
+               const std::vector<sizetype>& aux = std::vector<sizetype>()) {
+       ASSERT_TRUE(!WithAux || aux.size() == ids.size());
+       clear();
+       value_ptrs = index;
+       nvalues = ids.size();
+       byte_ptrs.resize(index.size());
+       bytes.reserve(ids.size() * (WithAux ? 3 : 2));
+       for (size_t key = 0; key < num_keys(); ++key) {
+         byte_ptrs[key] = bytes.size();
+         idtype prev = idtype(key);
+         for (size_t i = begin_index(key); i < end_index(key); ++i) {
+           if (i > begin_index(key)) ASSERT_LE(prev, ids[i]);
+           encode(zigzag(int64_t(ids[i]) - int64_t(prev)));
+           if (WithAux) encode(aux[i]);
+           prev = ids[i];
+         }
+       }
+       std::vector<unsigned char>(bytes).swap(bytes);
+     }
+
+     /// Number of keys in the storage.
+     inline size_t num_keys() const { return value_ptrs.size(); }
+
+     /// Number of values in the storage.
+     inline size_t num_values() const { return nvalues; }
+
+     /// Position of the first value of key among all values
+     inline sizetype begin_index(size_t id) const {
+       return id < num_keys() ? value_ptrs[id] : sizetype(nvalues);
+     }
+
+     /// Position of the ending+1 value of key among all values
+     inline sizetype end_index(size_t id) const {
+       return (id+1) < num_keys() ? value_ptrs[id+1] : sizetype(nvalues);
+     }
+
+     /// Number of values with key == id
+     inline size_t degree(size_t id) const {
+       return end_index(id) - begin_index(id);
+     }
+
+     /// Positions the cursor before the first value of key == id
+     inline void start(size_t id, cursor& c) const {
+       c.pos = bytes.empty() ? NULL :
+           &bytes[0] + (id < num_keys() ? byte_ptrs[id] : bytes.size());
+       c.id = idtype(id);
+       c.aux = 0;
+     }
+
+     /**
+      * Decodes the next value of the list. Must not be called more
+      * often than degree() times after start().
+      */
+     inline void next(cursor& c) const {
+       const uint64_t delta = decode(c.pos);
+       // undo the zigzag encoding
+       c.id = idtype(int64_t(c.id) + (int64_t(delta >> 1) ^ -int64_t(delta & 1)));
+       if (WithAux) c.aux = sizetype(decode(c.pos));
+     }
+
+     void swap(compressed_csr_storage& other) {
+       value_ptrs.swap(other.value_ptrs);
+       byte_ptrs.swap(other.byte_ptrs);
+       bytes.swap(other.bytes);
+       std::swap(nvalues, other.nvalues);
+     }
+
+     void clear() {
+       std::vector<sizetype>().swap(value_ptrs);
+       std::vector<size_t>().swap(byte_ptrs);
+       std::vector<unsigned char>().swap(bytes);
+       nvalues = 0;
+     }
+
+     void load(iarchive& iarc) {
+       clear();
+       iarc >> value_ptrs >> byte_ptrs >> bytes >> nvalues;
+     }
+
+     void save(oarchive& oarc) const {
+       oarc << value_ptrs << byte_ptrs << bytes << nvalues;
+     }
+
+     /// Append the index, byte offsets and encoded lists as raw image sections
+     void save_image(mapped_image_writer& img) const {
+       img.write_section(value_ptrs);
+       img.write_section(byte_ptrs);
+       img.write_section(bytes);
+       img.write_section(&nvalues, 1);
+     }
+
+     /// Bulk copy the storage out of a mapped image
+     bool load_image(mapped_image_reader& img) {
+       clear();
+       const size_t* n = NULL; size_t count = 0;
+       if (!(img.next_section(value_ptrs) && img.next_section(byte_ptrs) &&
+             img.next_section(bytes) && img.next_section(n, count) &&
+             count == 1)) return false;
+       nvalues = *n;
+       return true;
+     }
+
+     size_t estimate_sizeof() const {
+       return sizeof(*this) + sizeof(sizetype) * value_ptrs.capacity() +
+           sizeof(size_t) * byte_ptrs.capacity() + bytes.capacity();
+     }
+
+   private:
+     static inline uint64_t zigzag(int64_t v) {
+       return (uint64_t(v) << 1) ^ uint64_t(v >> 63);
+     }
+
+     inline void encode(uint64_t v) {
+       while (v >= 0x80) {
+         bytes.push_back((unsigned char)(v | 0x80));
+         v >>= 7;
+       }
+       bytes.push_back((unsigned char)v);
+     }
+
+     static inline uint64_t decode(const unsigned char*& p) {
+       uint64_t v = *p & 0x7f;
+       // most lists have small gaps which fit in one byte
+       if (__builtin_expect(*p++ < 0x80, 1)) return v;
+       size_t shift = 7;
+       do {
+         v |= uint64_t(*p & 0x7f) << shift;
+         shift += 7;
+       } while (*p++ >= 0x80);
+       return v;
+     }
+
+     std::vector<sizetype> value_ptrs;
+     std::vector<size_t> byte_ptrs;
+     std::vector<unsigned char> bytes;
+     size_t nvalues;
+  }; // end of class
+} // end of graphlab
+#endif
@@ -28,6 +28,7 @@
 #include <graphlab/util/generics/counting_sort.hpp>
 #include <graphlab/serialization/iarchive.hpp>
 #include <graphlab/serialization/oarchive.hpp>
+#include <graphlab/util/mapped_image.hpp>
 
 namespace graphlab {
   /**
@@ -179,6 +180,18 @@ namespace graphlab {
             << values;
      }
 
+     /// Append the index and the values as two raw image sections
+     void save_image(mapped_image_writer& img) const {
+       img.write_section(value_ptrs);
+       img.write_section(values);
+     }
+
+     /// Bulk copy the index and the values out of a mapped image
+     bool load_image(mapped_image_reader& img) {
+       clear();
+       return img.next_section(value_ptrs) && img.next_section(values);
+     }
+
      size_t estimate_sizeof() const {
        return sizeof(value_ptrs) + sizeof(values) + sizeof(sizetype)*value_ptrs.capacity() + sizeof(valuetype) * values.capacity();
      }
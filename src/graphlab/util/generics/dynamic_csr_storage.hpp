@@ -31,6 +31,7 @@
 
 #include <graphlab/serialization/iarchive.hpp>
 #include <graphlab/serialization/oarchive.hpp>
+#include <graphlab/util/mapped_image.hpp>
 
 #include <boost/iterator/permutation_iterator.hpp>
 
@@ -223,6 +224,39 @@ namespace graphlab {
        oarc << valueptr_vec << out;
      }
 
+     /// Append the packed index and the values as two raw image sections
+     void save_image(mapped_image_writer& img) const {
+       std::vector<sizetype> valueptr_vec(num_keys(), 0);
+       for (size_t i = 1;i < num_keys(); ++i) {
+         const_iterator begin_iter = begin(i - 1);
+         const_iterator end_iter = end(i - 1);
+         sizetype length = begin_iter.pdistance_to(end_iter);
+         valueptr_vec[i] = valueptr_vec[i - 1] + length;
+       }
+       img.write_section(valueptr_vec);
+       std::vector<valuetype> out;
+       std::copy(values.begin(), values.end(), std::inserter(out, out.end()));
+       img.write_section(out);
+     }
+
+     /**
+      * Fill the storage from the index and value sections of a mapped
+      * image. The values are packed into the blocks straight from the
+      * mapping, skipping the intermediate vectors used by load().
+      */
+     bool load_image(mapped_image_reader& img) {
+       clear();
+       const sizetype* ptrs = NULL; size_t nkeys = 0;
+       const valuetype* vals = NULL; size_t nvals = 0;
+       if (!img.next_section(ptrs, nkeys) || !img.next_section(vals, nvals)) {
+         return false;
+       }
+       if (nkeys > 0 && ptrs[nkeys - 1] > nvals) return false;
+       values.assign(vals, vals + nvals);
+       sizevec2ptrvec(ptrs, nkeys, value_ptrs);
+       return true;
+     }
+
      ////////////////////// Internal APIs /////////////////
    public:
      /**
@@ -305,14 +339,19 @@ namespace graphlab {
      // Assuming all blocks are fully packed.
      void sizevec2ptrvec (const std::vector<sizetype>& ptrs,
                           std::vector<iterator>& out) {
+       sizevec2ptrvec(ptrs.empty() ? NULL : &ptrs[0], ptrs.size(), out);
+     }
+
+     void sizevec2ptrvec (const sizetype* ptrs, size_t nptrs,
+                          std::vector<iterator>& out) {
        ASSERT_EQ(out.size(), 0);
-       out.reserve(ptrs.size());
+       out.reserve(nptrs);
 
        // for efficiency, we advance pointers based on the previous value
        // because block_linked_list is mostly forward_traversal.
        iterator it = values.begin();
        sizetype prev = 0;
-       for (size_t i = 0; i < ptrs.size(); ++i) {
+       for (size_t i = 0; i < nptrs; ++i) {
          sizetype cur = ptrs[i];
          it += (cur-prev);
          out.push_back(it);
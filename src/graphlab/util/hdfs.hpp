@@ -129,6 +129,13 @@ namespace graphlab {
       return files;
     } // end of list_files
 
+    /** Renames src to dst, replacing dst if it exists */
+    inline bool rename(const std::string& src, const std::string& dst) {
+      if(hdfsExists(filesystem, dst.c_str()) == 0)
+        hdfsDelete(filesystem, dst.c_str());
+      return hdfsRename(filesystem, src.c_str(), dst.c_str()) == 0;
+    } // end of rename
+
     inline static bool has_hadoop() { return true; }
     
     static hdfs& get_hdfs();
@@ -186,6 +193,12 @@ namespace graphlab {
       return std::vector<std::string>();;
     } // end of list_files
 
+    inline bool rename(const std::string& src, const std::string& dst) {
+      logstream(LOG_FATAL) << "Libhdfs is not installed on this system." 
+                           << std::endl;
+      return false;
+    } // end of rename
+
     // No hadoop available
     inline static bool has_hadoop() { return false; }
     
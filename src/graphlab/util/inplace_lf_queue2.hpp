@@ -67,6 +67,20 @@ class inplace_lf_queue2 {
      asm volatile ("" : : : "memory");
    }
 
+   /**
+    * Enqueues the n elements from first to last, already linked through
+    * their next pointers, as one unit. A concurrent dequeue_all()
+    * returns either all of them or none.
+    */
+   void enqueue_chain(T* first, T* last, size_t n) {
+     (*get_next_ptr(last)) = NULL;
+     T* prev = last;
+     atomic_exchange(tail, prev);
+     (*get_next_ptr(prev)) = first;
+     numel.inc(n);
+     asm volatile ("" : : : "memory");
+   }
+
    size_t approx_size() {
     return numel;
    }
@@ -0,0 +1,146 @@
+/**  
+ * Copyright (c) 2009 Carnegie Mellon University. 
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+
+
+#ifndef GRAPHLAB_UTIL_INTEGER_TOKENIZER_HPP
+#define GRAPHLAB_UTIL_INTEGER_TOKENIZER_HPP
+
+#include <stdint.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <graphlab/util/branch_hints.hpp>
+
+namespace graphlab {
+
+  /**
+   * \internal
+   * Allocation free tokenizer for lines of unsigned decimal integers
+   * as found in edge lists. The cursor is advanced in place over a
+   * [begin, end) character range, so no temporary strings or streams
+   * are created.
+   *
+   * The end of each run of digits is located 32 (AVX2) and 16 (SSE2)
+   * bytes at a time while enough input remains, falling back to a
+   * scalar loop for the tail and on other architectures.
+   */
+  namespace integer_tokenizer {
+
+    /// Returns true if c is a whitespace character
+    inline bool is_space(char c) {
+      return c == ' ' || c == '\t' || c == '\r' || c == '\n' ||
+             c == '\v' || c == '\f';
+    }
+
+    /// Returns true if c is a decimal digit
+    inline bool is_digit(char c) {
+      return (unsigned char)(c - '0') < 10;
+    }
+
+    /// Returns a pointer to the first non-digit in [p, end)
+    inline const char* scan_digits(const char* p, const char* end) {
+#if defined(__AVX2__) || defined(__SSE2__)
+      // Digits are mapped to the 10 smallest signed bytes by
+      // c - '0' + 0x80, so one signed compare classifies a whole vector.
+      const char bias = char(0x80 - '0');
+      const char limit = char(0x80 + 10);
+#endif
+#if defined(__AVX2__)
+      const __m256i vbias32 = _mm256_set1_epi8(bias);
+      const __m256i vlimit32 = _mm256_set1_epi8(limit);
+      while (end - p >= 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i shifted = _mm256_add_epi8(chunk, vbias32);
+        uint32_t digits = (uint32_t)_mm256_movemask_epi8(
+            _mm256_cmpgt_epi8(vlimit32, shifted));
+        if (digits != 0xFFFFFFFFu) return p + __builtin_ctz(~digits);
+        p += 32;
+      }
+#endif
+#if defined(__SSE2__)
+      // also handles the short tails left by the AVX2 loop
+      const __m128i vbias16 = _mm_set1_epi8(bias);
+      const __m128i vlimit16 = _mm_set1_epi8(limit);
+      while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i shifted = _mm_add_epi8(chunk, vbias16);
+        uint32_t digits = (uint32_t)_mm_movemask_epi8(
+            _mm_cmplt_epi8(shifted, vlimit16));
+        if (digits != 0xFFFFu) return p + __builtin_ctz(~digits);
+        p += 16;
+      }
+#endif
+      while (p < end && is_digit(*p)) ++p;
+      return p;
+    }
+
+    /**
+     * Skips whitespace, and also commas if allow_comma is set.
+     * Returns false if the end of the range is reached.
+     */
+    inline bool skip_separators(const char*& p, const char* end,
+                                bool allow_comma = false) {
+      while (p < end && (is_space(*p) || (allow_comma && *p == ','))) ++p;
+      return p < end;
+    }
+
+    /**
+     * Parses the unsigned integer at p after skipping separators and
+     * advances p past it. Returns false, leaving value untouched, if the
+     * next token does not start with a digit or does not fit in 64 bits.
+     */
+    template <typename T>
+    inline bool next_uint(const char*& p, const char* end, T& value,
+                          bool allow_comma = false) {
+      if (!skip_separators(p, end, allow_comma) || !is_digit(*p)) return false;
+      const char* digits_end = scan_digits(p, end);
+      // 19 digits always fit in 64 bits
+      if (__unlikely__(digits_end - p > 19)) {
+        const char* q = p;
+        while (q < digits_end && *q == '0') ++q;
+        if (digits_end - q > 20) return false;
+        uint64_t v = 0;
+        for (; q < digits_end; ++q) {
+          const uint64_t digit = *q - '0';
+          if (v > (uint64_t(-1) - digit) / 10) return false;
+          v = v * 10 + digit;
+        }
+        value = (T)v;
+        p = digits_end;
+        return true;
+      }
+      uint64_t v = 0;
+      for (; p < digits_end; ++p) v = v * 10 + (*p - '0');
+      value = (T)v;
+      return true;
+    }
+
+  } // namespace integer_tokenizer
+} // namespace graphlab
+
+#endif
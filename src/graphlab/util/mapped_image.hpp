@@ -0,0 +1,297 @@
+/**  
+ * Copyright (c) 2009 Carnegie Mellon University. 
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+
+
+#ifndef GRAPHLAB_MAPPED_IMAGE_HPP
+#define GRAPHLAB_MAPPED_IMAGE_HPP
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include <graphlab/logger/logger.hpp>
+#include <graphlab/logger/assertions.hpp>
+
+namespace graphlab {
+
+  /**
+   * \internal
+   * Layout of a mapped image file. The file begins with a single
+   * header page holding a table of sections, followed by the
+   * section payloads. Every section starts on a page boundary and
+   * stores a raw array of fixed size elements, so that a reader can
+   * mmap() the file and address the arrays directly without any
+   * parsing.
+   */
+  struct mapped_image_header {
+    enum {
+      PAGE_SIZE = 4096,
+      MAX_SCALARS = 16,
+      MAX_SECTIONS = 64,
+      /**
+       * Bumped whenever the sections written by any of the graph
+       * structures change. Version 2 adds the compressed edge lists
+       * of local_graph.
+       */
+      VERSION = 2
+    };
+    struct section {
+      uint64_t offset;
+      uint64_t count;
+      uint64_t elem_size;
+    };
+    char magic[8];
+    uint32_t version;
+    uint32_t nsections;
+    uint64_t file_size;
+    uint64_t scalars[MAX_SCALARS];
+    section sections[MAX_SECTIONS];
+
+    static const char* magic_string() { return "GLIMAGE"; }
+  };
+
+
+  /**
+   * \internal
+   * Writes a mapped image file. Sections are appended in order with
+   * write_section() (or begin_section()/append()/end_section() when the
+   * array is produced incrementally) and must be read back in the same
+   * order by mapped_image_reader. close() must be called to commit
+   * the header.
+   */
+  class mapped_image_writer {
+  public:
+    explicit mapped_image_writer(const std::string& fname) :
+      fname(fname), in_section(false), failed(false) {
+      memset(&header, 0, sizeof(header));
+      memcpy(header.magic, mapped_image_header::magic_string(), 8);
+      header.version = mapped_image_header::VERSION;
+      fout.open(fname.c_str(), std::ios_base::out | std::ios_base::binary |
+                               std::ios_base::trunc);
+      // reserve the header page
+      pad_to_page(0);
+    }
+
+    bool good() const { return !failed && fout.good(); }
+
+    void set_scalar(size_t i, uint64_t value) {
+      ASSERT_LT(i, (size_t)mapped_image_header::MAX_SCALARS);
+      header.scalars[i] = value;
+    }
+
+    /// Starts a new section of elements of size elem_size
+    void begin_section(size_t elem_size) {
+      ASSERT_FALSE(in_section);
+      if (header.nsections >= (uint32_t)mapped_image_header::MAX_SECTIONS) {
+        logstream(LOG_ERROR) << "Too many sections in image " << fname
+                             << std::endl;
+        failed = true;
+        return;
+      }
+      in_section = true;
+      mapped_image_header::section& sec = header.sections[header.nsections];
+      sec.offset = position;
+      sec.count = 0;
+      sec.elem_size = elem_size;
+    }
+
+    /// Appends n elements to the current section
+    template <typename T>
+    void append(const T* data, size_t n) {
+      ASSERT_TRUE(in_section);
+      if (failed) return;
+      mapped_image_header::section& sec = header.sections[header.nsections];
+      ASSERT_EQ(sec.elem_size, sizeof(T));
+      if (n > 0) {
+        fout.write(reinterpret_cast<const char*>(data), sizeof(T) * n);
+        position += sizeof(T) * n;
+      }
+      sec.count += n;
+    }
+
+    void end_section() {
+      ASSERT_TRUE(in_section);
+      in_section = false;
+      if (failed) return;
+      ++header.nsections;
+      pad_to_page(position);
+    }
+
+    template <typename T>
+    void write_section(const T* data, size_t n) {
+      begin_section(sizeof(T));
+      append(data, n);
+      end_section();
+    }
+
+    template <typename T>
+    void write_section(const std::vector<T>& vec) {
+      write_section(vec.empty() ? NULL : &vec[0], vec.size());
+    }
+
+    /// Writes the header and closes the file. Returns true on success.
+    bool close() {
+      ASSERT_FALSE(in_section);
+      header.file_size = position;
+      fout.seekp(0);
+      fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      fout.close();
+      if (failed || fout.fail()) {
+        logstream(LOG_ERROR) << "Error writing image " << fname << std::endl;
+        return false;
+      }
+      return true;
+    }
+
+  private:
+    void pad_to_page(uint64_t pos) {
+      uint64_t aligned = (pos + mapped_image_header::PAGE_SIZE - 1) /
+          mapped_image_header::PAGE_SIZE * mapped_image_header::PAGE_SIZE;
+      if (aligned == pos && pos != 0) return;
+      if (aligned == 0) aligned = mapped_image_header::PAGE_SIZE;
+      std::vector<char> zeros(aligned - pos, 0);
+      fout.write(&zeros[0], zeros.size());
+      position = aligned;
+    }
+
+    std::string fname;
+    std::ofstream fout;
+    mapped_image_header header;
+    uint64_t position;
+    bool in_section;
+    bool failed;
+  }; // end of mapped_image_writer
+
+
+
+  /**
+   * \internal
+   * Maps a file written by mapped_image_writer read-only into memory.
+   * Sections are consumed in the order they were written with
+   * next_section(), which returns a pointer directly into the mapping.
+   * The pointers are valid until the reader is destroyed.
+   */
+  class mapped_image_reader {
+  public:
+    explicit mapped_image_reader(const std::string& fname) :
+      fname(fname), base(NULL), length(0), header(NULL), cursor(0) {
+      int fd = ::open(fname.c_str(), O_RDONLY);
+      if (fd < 0) {
+        logstream(LOG_ERROR) << "Error opening image " << fname << std::endl;
+        return;
+      }
+      struct stat st;
+      if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(mapped_image_header)) {
+        length = st.st_size;
+        void* ptr = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED) {
+          logstream(LOG_ERROR) << "Unable to mmap image " << fname << std::endl;
+          length = 0;
+        } else {
+          base = reinterpret_cast<const char*>(ptr);
+          // the sections are consumed front to back exactly once
+          madvise(ptr, length, MADV_SEQUENTIAL);
+        }
+      }
+      ::close(fd);
+      if (base == NULL) return;
+      header = reinterpret_cast<const mapped_image_header*>(base);
+      if (memcmp(header->magic, mapped_image_header::magic_string(), 8) != 0 ||
+          header->file_size > length ||
+          header->nsections > (uint32_t)mapped_image_header::MAX_SECTIONS) {
+        logstream(LOG_ERROR) << "Invalid image header in " << fname << std::endl;
+        header = NULL;
+      } else if (header->version != (uint32_t)mapped_image_header::VERSION) {
+        logstream(LOG_ERROR) << "Image " << fname << " has version "
+                             << header->version << ", expected version "
+                             << mapped_image_header::VERSION
+                             << ". Save the graph again." << std::endl;
+        header = NULL;
+      }
+    }
+
+    ~mapped_image_reader() {
+      if (base != NULL) munmap(const_cast<char*>(base), length);
+    }
+
+    bool good() const { return header != NULL; }
+
+    uint64_t scalar(size_t i) const {
+      ASSERT_TRUE(good());
+      ASSERT_LT(i, (size_t)mapped_image_header::MAX_SCALARS);
+      return header->scalars[i];
+    }
+
+    /**
+     * Returns the next section as an array of T. Returns false if
+     * there are no more sections, or if the element size or the
+     * bounds of the section do not match.
+     */
+    template <typename T>
+    bool next_section(const T*& data, size_t& count) {
+      if (!good() || cursor >= header->nsections) return false;
+      const mapped_image_header::section& sec = header->sections[cursor];
+      if (sec.elem_size != sizeof(T) ||
+          sec.offset + sec.count * sec.elem_size > header->file_size) {
+        logstream(LOG_ERROR) << "Section " << cursor << " of " << fname
+                             << " does not match the expected layout"
+                             << std::endl;
+        return false;
+      }
+      ++cursor;
+      data = reinterpret_cast<const T*>(base + sec.offset);
+      count = sec.count;
+      return true;
+    }
+
+    /// Reads the next section into a vector with a single bulk copy
+    template <typename T>
+    bool next_section(std::vector<T>& vec) {
+      const T* data = NULL; size_t count = 0;
+      if (!next_section(data, count)) return false;
+      vec.assign(data, data + count);
+      return true;
+    }
+
+  private:
+    std::string fname;
+    const char* base;
+    size_t length;
+    const mapped_image_header* header;
+    size_t cursor;
+
+    // not copyable
+    mapped_image_reader(const mapped_image_reader&);
+    mapped_image_reader& operator=(const mapped_image_reader&);
+  }; // end of mapped_image_reader
+
+} // end of namespace graphlab
+
+#endif
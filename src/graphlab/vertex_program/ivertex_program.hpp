@@ -725,6 +725,85 @@ namespace graphlab {
       logstream(LOG_FATAL) << "Scatter not implemented!" << std::endl;
     };
 
+    /**
+     * \brief Returns true if the scatter phase of this vertex program
+     * may also be run "bottom-up" (pull) by the synchronous engine.
+     *
+     * In the bottom-up direction the engine visits every vertex
+     * (rather than every scattering vertex), walks its pull_edges()
+     * and invokes scatter() for each adjacent vertex which is
+     * scattering along that edge. Every edge is still scattered
+     * exactly once, so a vertex program whose scatter only updates the
+     * edge and signals the endpoints of the edge behaves identically
+     * in both directions. See the \c direction option of
+     * graphlab::synchronous_engine.
+     *
+     * The default implementation returns false.
+     */
+    virtual bool supports_pull() const {
+      return false;
+    }
+
+    /**
+     * \brief Returns the set of edges along which a vertex pulls
+     * scatters from its neighbors when the scatter phase runs
+     * bottom-up. Only used if supports_pull() returns true.
+     *
+     * Unlike the other functions this is invoked on a default
+     * constructed vertex program for every vertex, including vertices
+     * which are not active. It must return the reverse of the
+     * scatter_edges() of any neighbor which could scatter into this
+     * vertex: IN_EDGES to receive scatters along OUT_EDGES, OUT_EDGES
+     * to receive scatters along IN_EDGES and ALL_EDGES for both.
+     * Returning NO_EDGES skips a vertex which can not be updated
+     * anymore, which together with pull_complete() is what makes the
+     * bottom-up direction cheap for BFS like programs. The "auto"
+     * direction of the synchronous engine weighs the edges of the
+     * vertices which still pull against the edges of the scattering
+     * vertices.
+     *
+     * \param [in,out] context The context is used to interact with
+     * the engine
+     *
+     * \param [in] vertex The vertex pulling from its neighbors.
+     *
+     * \return One of graphlab::NO_EDGES, graphlab::IN_EDGES,
+     * graphlab::OUT_EDGES, or graphlab::ALL_EDGES.
+     */
+    virtual edge_dir_type pull_edges(icontext_type& context,
+                                     const vertex_type& vertex) const {
+      return NO_EDGES;
+    }
+
+    /**
+     * \brief Returns true if a vertex which has been signaled while
+     * pulling does not need any further scatters in the current
+     * iteration. Only used if supports_pull() returns true.
+     *
+     * When the scatter phase runs bottom-up the engine calls this,
+     * on a default constructed vertex program, every time a pulled
+     * scatter has left a message for the vertex, and stops walking the
+     * remaining pull_edges() of the vertex once it returns true. For
+     * instance in a breadth first search the first message a vertex
+     * receives is already the final one.
+     *
+     * The default implementation returns false, so every pull edge is
+     * visited.
+     *
+     * \param [in,out] context The context is used to interact with
+     * the engine
+     *
+     * \param [in] vertex The vertex pulling from its neighbors.
+     *
+     * \param [in] message The sum of the messages the vertex received
+     * so far in this scatter phase.
+     */
+    virtual bool pull_complete(icontext_type& context,
+                               const vertex_type& vertex,
+                               const message_type& message) const {
+      return false;
+    }
+
 
     /** 
      * \internal
@@ -310,9 +310,59 @@ void test_aggregator(graphlab::distributed_control& dc,
 
 
 
+// A skewed workload: a few vertices hold their worker busy for a while,
+// so the fibers queued behind them must be stolen by the idle workers.
+class skewed_program :
+  public graphlab::ivertex_program<graph_type, int>,
+  public graphlab::IS_POD_TYPE {
+public:
+  edge_dir_type
+  gather_edges(icontext_type& context, const vertex_type& vertex) const {
+    return graphlab::NO_EDGES;
+  }
+  void apply(icontext_type& context, vertex_type& vertex,
+             const gather_type& total) {
+    if (vertex.id() % 16 == 0) {
+      graphlab::timer ti;
+      while (ti.current_time() < 0.002);
+    }
+  }
+  edge_dir_type
+  scatter_edges(icontext_type& context, const vertex_type& vertex) const {
+    return graphlab::NO_EDGES;
+  }
+}; // end of skewed_program
+
+void test_fiber_stealing(graphlab::distributed_control& dc,
+                         graphlab::command_line_options& clopts,
+                         graph_type& graph) {
+  std::cout << "Constructing an engine for a skewed workload" << std::endl;
+  typedef graphlab::async_consistent_engine<skewed_program> engine_type;
+  graphlab::graphlab_options opts = clopts;
+  opts.set_ncpus(4);
+  opts.get_engine_args().set_option("nfibers", 16);
+  engine_type engine(dc, graph, opts);
+  graphlab::fiber_control& fc = graphlab::fiber_control::get_instance();
+  size_t steals = fc.total_steals();
+  engine.signal_all();
+  std::cout << "Running!" << std::endl;
+  engine.start();
+  steals = fc.total_steals() - steals;
+  dc.all_reduce(steals);
+  std::cout << "Fiber steals: " << steals << std::endl;
+  ASSERT_GT(steals, 0);
+  std::cout << "Finished" << std::endl;
+}
+
+
+
+
 int main(int argc, char** argv) {
 
   global_logger().set_log_level(LOG_INFO);
+  // enough fiber workers to steal between, even on small machines
+  graphlab::fiber_control::instance_set_parameters(
+      std::max<size_t>(4, graphlab::thread::cpu_count()), 0);
   ///! Initialize control plain using mpi
   graphlab::mpi_tools::init(argc, argv);
   graphlab::dc_init_param rpc_parameters;
@@ -328,6 +378,7 @@ int main(int argc, char** argv) {
   test_in_neighbors(dc, clopts, graph);
   test_out_neighbors(dc, clopts, graph);
   test_all_neighbors(dc, clopts, graph);
+  test_fiber_stealing(dc, clopts, graph);
   test_aggregator(dc, clopts, graph);
   graphlab::mpi_tools::finalize();
 } // end of main
@@ -0,0 +1,104 @@
+/*  
+ * Copyright (c) 2009 Carnegie Mellon University. 
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include <graphlab/rpc/dc_compress.hpp>
+#include <graphlab/serialization/serialization_includes.hpp>
+using namespace graphlab;
+
+class CompressTestSuite : public CxxTest::TestSuite {
+public:
+  // compresses and decompresses the block. Returns the compressed length
+  size_t round_trip(const std::vector<char>& block) {
+    std::vector<char> comp(block.size() + 1);
+    size_t complen = dc_impl::compress_block(&block[0], block.size(), &comp[0]);
+    TS_ASSERT(complen < block.size());
+    if (complen > 0) {
+      std::vector<char> out(block.size() + 1);
+      TS_ASSERT(dc_impl::decompress_block(&comp[0], complen,
+                                          &out[0], block.size()));
+      TS_ASSERT(memcmp(&block[0], &out[0], block.size()) == 0);
+    }
+    return complen;
+  }
+
+  void test_sorted_ids(void) {
+    // what an exchange of sorted vertex ids and values looks like
+    std::stringstream strm;
+    oarchive oarc(strm);
+    for (size_t i = 0; i < 8000; ++i) {
+      oarc << size_t(3 * i) << float(i % 7);
+    }
+    strm.flush();
+    std::string s = strm.str();
+    std::vector<char> block(s.begin(), s.end());
+    const size_t complen = round_trip(block);
+    TS_ASSERT(complen > 0);
+  }
+
+  void test_runs(void) {
+    // long matches which overlap their own output
+    std::vector<char> block(65536, 'a');
+    for (size_t i = 0; i < block.size(); i += 1000) block[i] = 'b';
+    TS_ASSERT(round_trip(block) > 0);
+  }
+
+  void test_random(void) {
+    std::vector<char> block(65536);
+    srand(1);
+    for (size_t i = 0; i < block.size(); ++i) block[i] = char(rand());
+    // does not shrink and is left alone
+    TS_ASSERT_EQUALS(round_trip(block), 0);
+  }
+
+  void test_small(void) {
+    for (size_t len = 1; len < 64; ++len) {
+      std::vector<char> block(len, 'x');
+      round_trip(block);
+    }
+  }
+
+  void test_malformed(void) {
+    std::vector<char> block(4096);
+    for (size_t i = 0; i < block.size(); ++i) block[i] = char(i % 10);
+    std::vector<char> comp(block.size());
+    size_t complen = dc_impl::compress_block(&block[0], block.size(), &comp[0]);
+    TS_ASSERT(complen > 0);
+    std::vector<char> out(block.size());
+    // truncated input and a wrong output length are both caught
+    TS_ASSERT(!dc_impl::decompress_block(&comp[0], complen - 1,
+                                         &out[0], block.size()));
+    TS_ASSERT(!dc_impl::decompress_block(&comp[0], complen,
+                                         &out[0], block.size() - 1));
+    // garbage never writes past the output
+    srand(2);
+    for (size_t trial = 0; trial < 1000; ++trial) {
+      for (size_t i = 0; i < complen; ++i) comp[i] = char(rand());
+      dc_impl::decompress_block(&comp[0], complen, &out[0], out.size());
+    }
+  }
+};
@@ -0,0 +1,136 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+
+/*
+ * Several threads send split calls, many larger than one archive buffer,
+ * to the same machine while also sending small calls. Every split call
+ * must arrive whole and exactly once.
+ */
+
+#include <iostream>
+#include <vector>
+#include <boost/bind.hpp>
+#include <graphlab/rpc/dc.hpp>
+#include <graphlab/rpc/dc_dist_object.hpp>
+#include <graphlab/util/mpi_tools.hpp>
+#include <graphlab/rpc/dc_init_from_mpi.hpp>
+#include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/parallel/atomic.hpp>
+using namespace graphlab;
+
+const size_t NTHREADS = 4;
+const size_t NCALLS = 50;
+
+
+class split_call_test {
+ public:
+  dc_dist_object<split_call_test> rmi;
+  atomic<size_t> nreceived;
+  atomic<size_t> nsmall;
+  atomic<size_t> nbad;
+  mutex lock;
+  /// the number of times every call of every thread of every machine arrived
+  std::vector<size_t> arrivals;
+
+  split_call_test(distributed_control &dc):
+      rmi(dc, this), arrivals(dc.numprocs() * NTHREADS * NCALLS, 0) {
+    dc.barrier();
+  }
+
+  static size_t value(procid_t proc, size_t thread, size_t call, size_t i) {
+    return proc * 1000003 + thread * 10007 + call * 101 + i;
+  }
+
+  // from 1 to about 160K values, so most calls span several buffers
+  static size_t num_values(size_t call) {
+    return 1 + (call * 7919) % 20000 * (call % 3 == 0 ? 8 : 1);
+  }
+
+  void small_call(size_t) {
+    nsmall.inc();
+  }
+
+  void receive(size_t len, wild_pointer w) {
+    iarchive iarc(reinterpret_cast<const char*>(w.ptr), len);
+    procid_t proc; size_t thread, call, n;
+    iarc >> proc >> thread >> call >> n;
+    bool good = proc < rmi.numprocs() && thread < NTHREADS &&
+        call < NCALLS && n == num_values(call);
+    for (size_t i = 0; i < n && good; ++i) {
+      size_t v; iarc >> v;
+      good = (v == value(proc, thread, call, i));
+    }
+    if (good) {
+      lock.lock();
+      good = ++arrivals[(proc * NTHREADS + thread) * NCALLS + call] == 1;
+      lock.unlock();
+    }
+    if (!good) nbad.inc();
+    nreceived.inc();
+  }
+
+  void send(size_t thread) {
+    const procid_t target = (rmi.procid() + 1) % rmi.numprocs();
+    for (size_t call = 0; call < NCALLS; ++call) {
+      // leave a small call in the thread's buffer before the split call
+      rmi.remote_call(target, &split_call_test::small_call, call);
+      oarchive* oarc = rmi.split_call_begin(&split_call_test::receive);
+      const size_t n = num_values(call);
+      (*oarc) << rmi.procid() << thread << call << n;
+      for (size_t i = 0; i < n; ++i) {
+        (*oarc) << value(rmi.procid(), thread, call, i);
+      }
+      rmi.split_call_end(target, oarc);
+    }
+  }
+
+  void run() {
+    thread_group group;
+    for (size_t i = 0; i < NTHREADS; ++i) {
+      group.launch(boost::bind(&split_call_test::send, this, i));
+    }
+    group.join();
+    rmi.full_barrier();
+  }
+};
+
+
+int main(int argc, char ** argv) {
+  mpi_tools::init(argc, argv);
+  global_logger().set_log_level(LOG_INFO);
+
+  dc_init_param param;
+  if (init_param_from_mpi(param) == false) {
+    return 0;
+  }
+  distributed_control dc(param);
+  split_call_test test(dc);
+  test.run();
+  std::cout << "Received " << test.nreceived.value << " split calls and "
+            << test.nsmall.value << " small calls" << std::endl;
+  ASSERT_EQ(test.nreceived.value, NTHREADS * NCALLS);
+  ASSERT_EQ(test.nsmall.value, NTHREADS * NCALLS);
+  ASSERT_EQ(test.nbad.value, 0);
+  std::cout << "Done" << std::endl;
+  mpi_tools::finalize();
+}
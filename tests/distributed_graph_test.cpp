@@ -21,6 +21,8 @@
  */
 
 // standard C++ headers
+#include <cstddef>
+#include <fstream>
 #include <iostream>
 #include <vector>
 #include <cxxtest/TestSuite.h>
@@ -124,6 +126,110 @@ class distributed_graph_test  {
      dc->cout() << "\n+ Pass test: graph save load binary. :) \n";
    }
 
+   /**
+    * Test save load of the memory mapped graph image
+    */
+   void test_save_load_mmap() {
+     graphlab::distributed_graph<vertex_data, edge_data> g(*dc);
+     for (size_t i = 0; i < 100; ++i) {
+       g.add_edge(i, (i+1), edge_data(i, i+1));
+       g.add_edge(i, (i+7) % 100, edge_data(i, (i+7) % 100));
+     }
+     g.finalize();
+     test_save_load_impl(g, true);
+     dc->cout() << "\n+ Pass test: graph save load mmap image. :) \n";
+   }
+
+   /**
+    * Test save load of incremental binary snapshots
+    */
+   void test_save_load_delta() {
+     typedef graphlab::distributed_graph<vertex_data, edge_data> graph_type;
+     graph_type g(*dc);
+     for (size_t i = 0; i < 100; ++i) {
+       g.add_edge(i, (i+1), edge_data(i, i+1));
+     }
+     g.finalize();
+
+     using namespace boost::filesystem;
+     path ph = unique_path();
+     if (create_directory(ph)) {
+       path prefix = ph;
+       prefix /= "test";
+       ASSERT_TRUE(g.save_binary_base(prefix.string()));
+       // change every third vertex and every fifth edge in two deltas
+       for (size_t d = 1; d <= 2; ++d) {
+         graphlab::dense_bitset dirty_vertices(g.num_local_vertices());
+         graphlab::dense_bitset dirty_edges(g.num_local_edges());
+         for (size_t i = 0; i < g.num_local_vertices(); ++i) {
+           if (g.global_vid(i) % 3 == 0) {
+             g.l_vertex(i).data().value = g.global_vid(i) * 10 + d;
+             dirty_vertices.set_bit(i);
+           }
+           foreach(graph_type::local_edge_type e, g.l_vertex(i).out_edges()) {
+             if (e.source().global_id() % 5 == 0) {
+               e.data().to = d;
+               dirty_edges.set_bit(e.id());
+             }
+           }
+         }
+         ASSERT_TRUE(g.save_binary_delta(prefix.string(),
+                                         dirty_vertices, dirty_edges));
+       }
+
+       graph_type g2(*dc);
+       ASSERT_TRUE(g2.load_binary_incremental(prefix.string()));
+       ASSERT_EQ(g.num_vertices(), g2.num_vertices());
+       for (size_t i = 0; i < g.num_local_vertices(); ++i) {
+         ASSERT_TRUE(g.l_vertex(i).data() == g2.l_vertex(i).data());
+         ASSERT_EQ(g.l_out_edges(i).size(), g2.l_out_edges(i).size());
+         for (size_t j = 0; j < g.l_out_edges(i).size(); ++j) {
+           ASSERT_TRUE(g.l_out_edges(i)[j].data() == g2.l_out_edges(i)[j].data());
+         }
+       }
+
+       // a truncated delta is not replayed, and no temporary file is left
+       std::vector<size_t> values(g.num_local_vertices());
+       for (size_t i = 0; i < g.num_local_vertices(); ++i) {
+         values[i] = g.l_vertex(i).data().value;
+       }
+       {
+         graphlab::dense_bitset dirty_vertices(g.num_local_vertices());
+         graphlab::dense_bitset dirty_edges(g.num_local_edges());
+         for (size_t i = 0; i < g.num_local_vertices(); ++i) {
+           g.l_vertex(i).data().value = 1;
+           dirty_vertices.set_bit(i);
+         }
+         ASSERT_TRUE(g.save_binary_delta(prefix.string(),
+                                         dirty_vertices, dirty_edges));
+         std::string fname = prefix.string() + graphlab::tostr(dc->procid())
+                             + ".delta3.bin";
+         ASSERT_FALSE(exists(fname + ".tmp"));
+         resize_file(fname, file_size(fname) / 2);
+       }
+       graph_type g4(*dc);
+       ASSERT_TRUE(g4.load_binary_incremental(prefix.string()));
+       for (size_t i = 0; i < g.num_local_vertices(); ++i) {
+         ASSERT_EQ(g4.l_vertex(i).data().value, values[i]);
+       }
+
+       // a new base must not pick up the deltas of the previous chain
+       for (size_t i = 0; i < g.num_local_vertices(); ++i) {
+         g.l_vertex(i).data().value = 7;
+       }
+       ASSERT_TRUE(g.save_binary_base(prefix.string()));
+       graph_type g3(*dc);
+       ASSERT_TRUE(g3.load_binary_incremental(prefix.string()));
+       for (size_t i = 0; i < g.num_local_vertices(); ++i) {
+         ASSERT_TRUE(g.l_vertex(i).data() == g3.l_vertex(i).data());
+       }
+       remove_all(ph);
+     } else {
+       dc->cout() << "Unable to create tmp directory:" << ph.string() << std::endl;
+     }
+     dc->cout() << "\n+ Pass test: graph save load binary delta. :) \n";
+   }
+
  private: 
    template<typename Graph>
        void test_add_vertex_impl(Graph& g, size_t nverts) {
@@ -201,7 +307,7 @@ class distributed_graph_test  {
        }
 
    template<typename Graph>
-       void test_save_load_impl(Graph& g) {
+       void test_save_load_impl(Graph& g, bool use_mmap = false) {
          typedef typename Graph::local_edge_type local_edge_type;
 
          using namespace boost::filesystem;
@@ -210,10 +316,30 @@ class distributed_graph_test  {
            path prefix = ph;
            prefix /= "test"; 
            dc->cout() << "Save to path: " << prefix.string() << std::endl;
-           g.save_binary(prefix.string());
-
            Graph g2(*dc);
-           g2.load_binary(prefix.string());
+           if (use_mmap) {
+             ASSERT_TRUE(g.save_binary_mmap(prefix.string()));
+             ASSERT_TRUE(g2.load_binary_mmap(prefix.string()));
+             // global ids must resolve to the same local vertices
+             for (size_t i = 0; i < g.num_local_vertices(); ++i) {
+               ASSERT_EQ(g2.local_vid(g.global_vid(i)), i);
+             }
+             // an image with a different layout version is rejected
+             {
+               std::string fname = prefix.string() +
+                                   graphlab::tostr(dc->procid()) + ".img";
+               std::fstream f(fname.c_str(), std::ios_base::in |
+                              std::ios_base::out | std::ios_base::binary);
+               uint32_t version = graphlab::mapped_image_header::VERSION - 1;
+               f.seekp(offsetof(graphlab::mapped_image_header, version));
+               f.write(reinterpret_cast<char*>(&version), sizeof(version));
+             }
+             Graph g3(*dc);
+             ASSERT_FALSE(g3.load_binary_mmap(prefix.string()));
+           } else {
+             g.save_binary(prefix.string());
+             g2.load_binary(prefix.string());
+           }
            ASSERT_EQ(g.num_vertices(), g2.num_vertices());
            ASSERT_EQ(g.num_edges(), g2.num_edges());
 
@@ -506,6 +632,8 @@ int main(int argc, char** argv) {
   testsuit.test_add_edge();
   testsuit.test_dynamic_add_edge();
   testsuit.test_save_load();
+  testsuit.test_save_load_delta();
+  testsuit.test_save_load_mmap();
 
   delete(dc);
   graphlab::mpi_tools::finalize();
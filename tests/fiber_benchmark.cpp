@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+/**
+ * Measures the launch and teardown latency of fibers and how fast idle
+ * workers steal fibers queued on a single worker.
+ *
+ * usage: fiber_benchmark [nfibers]
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <graphlab/parallel/fiber_group.hpp>
+#include <graphlab/util/timer.hpp>
+
+
+using namespace graphlab;
+
+void nopfn() { }
+
+// launch and destroy nfibers fibers which do nothing, batch fibers at a
+// time. With small batches the stacks are reused from the pool of
+// fiber_control, large batches map new stacks.
+void launch_latency(size_t nfibers, size_t batch) {
+  timer ti; ti.start();
+  for (size_t i = 0;i < nfibers; i += batch) {
+    fiber_group group;
+    for (size_t j = 0;j < batch; ++j) group.launch(nopfn);
+    group.join();
+  }
+  std::cout << "Launch+teardown in batches of " << batch << ": "
+            << 1000000 * ti.current_time() / nfibers << " us per fiber\n";
+}
+
+fiber_group spinners;
+
+void spinfn() {
+  timer ti; ti.start();
+  while(ti.current_time() < 0.001);
+}
+
+// all spinners are queued on the worker running this fiber. Idle
+// workers steal them.
+void spawnerfn() {
+  for (int i = 0;i < 2000; ++i) spinners.launch(spinfn);
+}
+
+void steal_balance() {
+  fiber_control& fc = fiber_control::get_instance();
+  const size_t steals = fc.total_steals();
+  const size_t idle = fc.total_idle_waits();
+  timer ti; ti.start();
+  fiber_group spawner;
+  spawner.launch(spawnerfn);
+  spawner.join();
+  spinners.join();
+  std::cout << "2000 1ms fibers from one worker in " << ti.current_time()
+            << "s. Steals: " << fc.total_steals() - steals
+            << " Idle waits: " << fc.total_idle_waits() - idle << "\n";
+}
+
+int main(int argc, char** argv) {
+  const size_t nfibers = argc > 1 ? atol(argv[1]) : 100000;
+  steal_balance();
+  launch_latency(nfibers, nfibers);
+  launch_latency(nfibers, 100);
+  launch_latency(nfibers, 100);
+  return 0;
+}
@@ -1,5 +1,9 @@
+#include <algorithm>
 #include <iostream>
+#include <vector>
+#include <boost/bind.hpp>
 #include <graphlab/parallel/fiber_group.hpp>
+#include <graphlab/logger/assertions.hpp>
 #include <graphlab/util/timer.hpp>
 using namespace graphlab;
 int numticks = 0;
@@ -24,7 +28,65 @@ void threadfn2() {
   }
 }
 
+void countfn(std::vector<size_t>* runs, size_t i) {
+  __sync_fetch_and_add(&(*runs)[i], 1);
+}
+
+// launches nfibers fibers, batch fibers at a time, and checks that every
+// one of them ran exactly once. Small batches reuse the pooled stacks of
+// fiber_control, large batches map new stacks.
+void test_launch(size_t nfibers, size_t batch) {
+  std::vector<size_t> runs(nfibers, 0);
+  for (size_t i = 0;i < nfibers; i += batch) {
+    fiber_group group;
+    for (size_t j = i;j < std::min(i + batch, nfibers); ++j) {
+      group.launch(boost::bind(countfn, &runs, j));
+    }
+    group.join();
+  }
+  for (size_t i = 0;i < nfibers; ++i) ASSERT_EQ(runs[i], 1);
+  std::cout << "Launched " << nfibers << " fibers in batches of "
+            << batch << "\n";
+}
+
+fiber_group spinners;
+
+void spinfn(std::vector<size_t>* runs_per_worker) {
+  __sync_fetch_and_add(&(*runs_per_worker)[fiber_control::get_worker_id()], 1);
+  timer ti; ti.start();
+  while(ti.current_time() < 0.001);
+}
+
+// all spinners are queued on the worker running this fiber. Idle
+// workers steal them.
+void spawnerfn(std::vector<size_t>* runs_per_worker) {
+  for (int i = 0;i < 2000; ++i) {
+    spinners.launch(boost::bind(spinfn, runs_per_worker));
+  }
+}
+
+// checks that fibers launched from one worker are spread over all of them
+void test_steal_balance() {
+  std::vector<size_t> runs_per_worker(
+      fiber_control::get_instance().num_workers(), 0);
+  fiber_group spawner;
+  spawner.launch(boost::bind(spawnerfn, &runs_per_worker));
+  spawner.join();
+  spinners.join();
+  size_t total = 0;
+  for (size_t i = 0;i < runs_per_worker.size(); ++i) {
+    ASSERT_GT(runs_per_worker[i], 0);
+    total += runs_per_worker[i];
+  }
+  ASSERT_EQ(total, 2000);
+  std::cout << "2000 fibers from one worker ran on all "
+            << runs_per_worker.size() << " workers\n";
+}
+
 int main(int argc, char** argv) {
+  test_steal_balance();
+  test_launch(100000, 100000);
+  test_launch(100000, 100);
   timer ti; ti.start();
   fiber_group group;
   fiber_group group2;
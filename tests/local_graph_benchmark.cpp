@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+/**
+ * Compares the memory per edge and the gather throughput of the plain
+ * and the compressed edge layout of local_graph on a large low degree
+ * graph.
+ *
+ * usage: local_graph_benchmark [nverts] [nedges]
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <graphlab/graph/local_graph.hpp>
+#include <graphlab/util/random.hpp>
+#include <graphlab/util/timer.hpp>
+#include <graphlab/macros_def.hpp>
+
+
+using namespace graphlab;
+
+typedef local_graph<double, float> graph_type;
+
+
+void benchmark_layout(bool compressed, size_t nverts, size_t nedges) {
+  graph_type g;
+  g.set_compressed(compressed);
+  g.resize(nverts);
+  random::seed(0);
+  for (size_t i = 0; i < nedges; ++i) {
+    // half of the edges between nearby vertices
+    const lvid_type src = random::fast_uniform<size_t>(0, nverts - 1);
+    const lvid_type dst = (i % 2) ?
+        random::fast_uniform<size_t>(0, nverts - 1) :
+        (src + random::fast_uniform<size_t>(1, 1000)) % nverts;
+    if (src != dst) g.add_edge(src, dst, 1.0);
+  }
+  g.finalize();
+  for (size_t i = 0; i < nverts; ++i) g.vertex_data(i) = i % 7;
+  const size_t data_size = nverts * sizeof(double) +
+      g.num_edges() * sizeof(float);
+  const size_t total_size = g.estimate_sizeof();
+
+  const size_t rounds = 5;
+  double total = 0;
+  timer ti;
+  for (size_t r = 0; r < rounds; ++r) {
+    for (lvid_type v = 0; v < nverts; ++v) {
+      foreach(const graph_type::edge_type& e, g.in_edges(v)) {
+        total += e.source().data() * e.data();
+      }
+    }
+  }
+  const double in_time = ti.current_time();
+  ti.start();
+  for (size_t r = 0; r < rounds; ++r) {
+    for (lvid_type v = 0; v < nverts; ++v) {
+      foreach(const graph_type::edge_type& e, g.out_edges(v)) {
+        total += e.target().data() * e.data();
+      }
+    }
+  }
+  const double out_time = ti.current_time();
+
+  const double nedges_run = double(rounds) * g.num_edges();
+  std::cout << (compressed ? "compressed" : "plain     ")
+            << " layout: structure "
+            << double(total_size - data_size) / g.num_edges()
+            << " bytes/edge, total "
+            << double(total_size) / g.num_edges()
+            << " bytes/edge, in-edge gather "
+            << nedges_run / in_time / 1e6 << " M edges/s, out-edge gather "
+            << nedges_run / out_time / 1e6 << " M edges/s"
+            << " (checksum " << total << ")" << std::endl;
+}
+
+
+int main(int argc, char** argv) {
+  const size_t nverts = argc > 1 ? atol(argv[1]) : 1000000;
+  const size_t nedges = argc > 2 ? atol(argv[2]) : 10000000;
+  benchmark_layout(false, nverts, nedges);
+  benchmark_layout(true, nverts, nedges);
+  return 0;
+}
+
+#include <graphlab/macros_undef.hpp>
@@ -131,7 +131,108 @@ public:
     std::cout << "\n+ Pass test: grid dynamic graph test. :) \n";
   }
 
+  void test_compressed_graph() {
+    graphlab::local_graph<vertex_data, edge_data> g;
+    g.set_compressed(true);
+    test_add_edge_impl(g, 100);
+    test_add_edge_impl(g, 10000);
+    test_add_edge_impl(g, 100000);
+    check_random_access(g);
+    test_powerlaw_graph_impl(g, 100);
+    test_powerlaw_graph_impl(g, 10000);
+    check_random_access(g);
+    test_grid_graph_impl(g);
+    g.clear();
+    test_sparse_graph_impl(g);
+    ASSERT_TRUE(g.is_compressed());
+    std::cout << "\n+ Pass test: compressed graph. :) \n";
+  }
+
+  void test_reorder_vertices() {
+    graphlab::local_graph<vertex_data, edge_data> g;
+    test_reorder_vertices_impl(g, graphlab::VERTEX_ORDER_DEGREE);
+    test_reorder_vertices_impl(g, graphlab::VERTEX_ORDER_BFS);
+    std::cout << "\n+ Pass test: reorder vertices. :) \n";
+
+    graphlab::dynamic_local_graph<vertex_data, edge_data> g2;
+    test_reorder_vertices_impl(g2, graphlab::VERTEX_ORDER_DEGREE);
+    test_reorder_vertices_impl(g2, graphlab::VERTEX_ORDER_BFS);
+    std::cout << "\n+ Pass test: reorder dynamic graph vertices. :) \n";
+  }
+
 private: 
+  /**
+   * Check that random access into the edge lists agrees with
+   * sequential iteration.
+   */
+  template<typename Graph>
+  void check_random_access(Graph& g) {
+    typedef typename Graph::edge_list_type edge_list_type;
+    typedef typename Graph::edge_type edge_type;
+    for (size_t i = 0; i < g.num_vertices(); ++i) {
+      for (size_t dir = 0; dir < 2; ++dir) {
+        const edge_list_type ls = dir ? g.in_edges(i) : g.out_edges(i);
+        std::vector<size_t> ids, sources, targets;
+        foreach(const edge_type& e, ls) {
+          ids.push_back(e.id());
+          sources.push_back(e.source().id());
+          targets.push_back(e.target().id());
+        }
+        ASSERT_EQ(ids.size(), ls.size());
+        for (size_t j = ids.size(); j > 0; --j) {
+          ASSERT_EQ(ls[j - 1].id(), ids[j - 1]);
+          ASSERT_EQ(ls[j - 1].source().id(), sources[j - 1]);
+          ASSERT_EQ(ls[j - 1].target().id(), targets[j - 1]);
+        }
+      }
+    }
+  }
+
+  /**
+   * Reorders a random graph whose vertex and edge data hold the
+   * original ids and checks that everything moved consistently.
+   */
+  template<typename Graph>
+  void test_reorder_vertices_impl(Graph& g, graphlab::vertex_order_type order) {
+    typedef typename Graph::edge_type edge_type;
+    const size_t nverts = 1000;
+    g.clear();
+    g.resize(nverts);
+    for (size_t i = 0; i < nverts; ++i) g.add_vertex(i, vertex_data(i));
+    for (size_t i = 0; i < 5 * nverts; ++i) {
+      const size_t src = graphlab::random::fast_uniform<size_t>(0, nverts - 1);
+      // a few hubs with many in edges
+      const size_t dst = (i % 3) ? (src + 1 + i % 7) % nverts
+          : graphlab::random::fast_uniform<size_t>(0, 9);
+      if (src != dst) g.add_edge(src, dst, edge_data(src, dst));
+    }
+    std::vector<graphlab::lvid_type> new_lvid;
+    g.reorder_vertices(order, new_lvid);
+    g.finalize();
+    ASSERT_EQ(new_lvid.size(), nverts);
+    std::vector<bool> seen(nverts, false);
+    for (size_t i = 0; i < nverts; ++i) {
+      ASSERT_LT(new_lvid[i], nverts);
+      ASSERT_FALSE(seen[new_lvid[i]]);
+      seen[new_lvid[i]] = true;
+      ASSERT_EQ(g.vertex_data(new_lvid[i]).value, i);
+    }
+    size_t nseen = 0;
+    for (size_t v = 0; v < nverts; ++v) {
+      const size_t old_id = g.vertex_data(v).value;
+      foreach(const edge_type& e, g.out_edges(v)) {
+        ASSERT_EQ(size_t(e.data().from), old_id);
+        ASSERT_EQ(new_lvid[e.data().to], e.target().id());
+        ++nseen;
+      }
+      if (order == graphlab::VERTEX_ORDER_DEGREE && v > 0) {
+        ASSERT_GE(g.num_in_edges(v - 1) + g.num_out_edges(v - 1),
+                  g.num_in_edges(v) + g.num_out_edges(v));
+      }
+    }
+    ASSERT_EQ(nseen, g.num_edges());
+  }
+
   template<typename Graph>
   void test_add_vertex_impl(Graph& g, size_t nverts) {
     g.clear();
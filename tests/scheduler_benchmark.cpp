@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+/**
+ * Measures the task throughput of the priority schedulers.
+ *
+ * usage: scheduler_benchmark [nthreads]
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <boost/bind.hpp>
+#include <graphlab/scheduler/scheduler_includes.hpp>
+#include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/util/timer.hpp>
+#include <graphlab/util/random.hpp>
+
+
+using namespace graphlab;
+
+/*
+ * Vertex program like load: every task schedules two random vertices
+ * with a random priority.
+ */
+template <typename SchedulerType>
+void benchmark_thread(SchedulerType& sched, size_t numv, size_t ntasks,
+                      size_t threadid) {
+  lvid_type v;
+  for (size_t i = 0; i < ntasks; ++i) {
+    if (sched.get_next(threadid, v) == sched_status::NEW_TASK) {
+      sched.schedule(random::fast_uniform(size_t(0), numv - 1),
+                     random::fast_uniform(0.0, 1.0));
+      sched.schedule(random::fast_uniform(size_t(0), numv - 1),
+                     random::fast_uniform(0.0, 1.0));
+    }
+  }
+}
+
+
+template <typename SchedulerType>
+void benchmark_scheduler(const std::string& name, size_t ncpus) {
+  const size_t numv = 100000;
+  const size_t ntasks = 1000000;
+  graphlab_options opts;
+  opts.set_ncpus(ncpus);
+  SchedulerType sched(numv, opts);
+  for (size_t i = 0; i < numv; ++i) {
+    sched.schedule(i, random::fast_uniform(0.0, 1.0));
+  }
+  timer ti;
+  thread_group group;
+  for (size_t i = 0;i < ncpus;++i) {
+    group.launch(boost::bind(benchmark_thread<SchedulerType>,
+                             boost::ref(sched), numv, ntasks, i));
+  }
+  group.join();
+  const double runtime = ti.current_time();
+  std::cout << name << ": " << ncpus * ntasks / runtime / 1e6
+            << "M tasks/s with " << ncpus << " threads" << std::endl;
+}
+
+
+int main(int argc, char** argv) {
+  const size_t ncpus = argc > 1 ? atol(argv[1]) : 4;
+  benchmark_scheduler<priority_scheduler>("priority", ncpus);
+  benchmark_scheduler<multiqueue_scheduler>("multiqueue", ncpus);
+  return 0;
+}
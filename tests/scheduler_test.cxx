@@ -23,33 +23,18 @@
 
 #include <fstream>
 #include <vector>
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <boost/bind.hpp>
 #include <graphlab/scheduler/scheduler_includes.hpp>
-#include <graphlab/rpc/async_consensus.hpp>
+#include <graphlab/parallel/pthread_tools.hpp>
 #include <graphlab/parallel/atomic.hpp>
 #include <cxxtest/TestSuite.h>
 
 
 using namespace graphlab;
 
-distributed_control dc;
-
-struct message_type {
-  int value;
-  double pr;
-
-  explicit message_type(int value = 0, double pr = 0):value(value),pr(pr) { }
-  
-  double priority() const {
-    return pr;
-  }
-  message_type& operator+=(const message_type& other) {
-    value += other.value;
-    pr = other.value;
-    return *this;
-  }
-};
-
-
 const size_t NCPUS = 4;
 const size_t NUM_VERTICES = 101;
 std::vector<atomic<int> > correctness_counter;
@@ -61,82 +46,72 @@ void test_scheduler_basic_functionality_single_threaded() {
   opts.set_ncpus(NCPUS);
   SchedulerType sched(NUM_VERTICES, opts);
   const size_t target_value = 100;
-  
-  // inject a sequence of messages which will sum to 100 per vertex
+
+  // schedule every vertex many times. It must run exactly once.
   for (size_t c = 0;c < target_value; ++c) {
     for (size_t i = 0; i < NUM_VERTICES; ++i) {
-      sched.schedule(i, message_type(1, 1.0));
+      sched.schedule(i, 1.0 + c);
     }
   }
   correctness_counter.clear();
   correctness_counter.resize(NUM_VERTICES, atomic<int>(0));
-  sched.start();
-  
+
   // pull stuff out
-  bool allcpus_done = false; 
+  bool allcpus_done = false;
   while(!allcpus_done) {
     allcpus_done = true;
     for (size_t i = 0; i < NCPUS; ++i) {
-      vertex_id_type v; message_type m;
-      sched_status::status_enum ret = sched.get_next(i, v, m);
+      lvid_type v;
+      sched_status::status_enum ret = sched.get_next(i, v);
       if (ret == sched_status::NEW_TASK) {
         allcpus_done = false;
-        correctness_counter[v].inc(m.value);
+        correctness_counter[v].inc();
       }
     }
   }
 
   // check the counters
   for(size_t i = 0; i < NUM_VERTICES; ++i) {
-    TS_ASSERT_EQUALS(correctness_counter[i].value, (int)target_value);
+    TS_ASSERT_EQUALS(correctness_counter[i].value, 1);
   }
+  TS_ASSERT(sched.empty());
 }
 
 
-
-
-
+/*
+ * Every thread runs what it can get and then schedules every vertex
+ * again, schedule_count times. A vertex runs at most once per schedule
+ * call and is left scheduled only when its last schedule call
+ * happened after its last run.
+ */
 template <typename SchedulerType>
-void test_basic_functionality_thread(SchedulerType& sched, 
-                                     async_consensus& consensus, 
+void test_basic_functionality_thread(SchedulerType& sched,
                                      size_t schedule_count,
                                      size_t threadid) {
-  size_t c = 0;
-  vertex_id_type v; message_type m;
-  while(1) {
-    // process as many tasks as I can
-    while(1) {
-      sched_status::status_enum ret = sched.get_next(threadid, v, m);
-      if (ret == sched_status::NEW_TASK) {
-        correctness_counter[v].inc(m.value);
-      }
-      else {
-        break;
-      }
+  lvid_type v;
+  for (size_t c = 0; c < schedule_count; ++c) {
+    while (sched.get_next(threadid, v) == sched_status::NEW_TASK) {
+      correctness_counter[v].inc();
     }
-    
-    // schedule 1 cycle. If I schedule stuff I go back to processing tasks
-    if (c < schedule_count) {
-      for (size_t i = 0; i < NUM_VERTICES; ++i) {
-        sched.schedule(i, message_type(1, 1.0));
-        consensus.cancel();
-      }
-      ++c;
-      continue;
-    }
-    
-    // nothing to schedule, nothing to run. try to quit
-    consensus.begin_done_critical_section(threadid);
-    sched_status::status_enum ret = sched.get_next(threadid, v, m);
-    if (ret == sched_status::NEW_TASK) {
-      // there is task. cancel, process it, and look back
-      consensus.cancel_critical_section(threadid);
-      correctness_counter[v].inc(m.value);
+    for (size_t i = 0; i < NUM_VERTICES; ++i) {
+      sched.schedule(i, 1.0);
     }
-    else {
-      // no more tasks try to finish up
-      bool ret = consensus.end_done_critical_section(threadid);
-      if (ret) break;
+  }
+}
+
+
+// Runs everything left once all threads are done
+template <typename SchedulerType>
+void drain_scheduler(SchedulerType& sched) {
+  bool allcpus_done = false;
+  while(!allcpus_done) {
+    allcpus_done = true;
+    for (size_t i = 0; i < NCPUS; ++i) {
+      lvid_type v;
+      if (sched.get_next(i, v) == sched_status::NEW_TASK) {
+        allcpus_done = false;
+        correctness_counter[v].inc();
+      }
     }
   }
 }
@@ -147,149 +122,191 @@ void test_scheduler_basic_functionality_parallel() {
   graphlab_options opts;
   opts.set_ncpus(NCPUS);
   SchedulerType sched(NUM_VERTICES, opts);
-  async_consensus consensus(dc, NCPUS);
-  
-  const size_t schedule_count = 10000;
-  const size_t target_value = schedule_count * NCPUS + 1;
+
+  const size_t schedule_count = 1000;
+  const size_t maximum_value = schedule_count * NCPUS + 1;
 
   correctness_counter.clear();
   correctness_counter.resize(NUM_VERTICES, atomic<int>(0));
 
-  // inject a sequence of messages which will sum to 100 per vertex
   for (size_t i = 0; i < NUM_VERTICES; ++i) {
-    sched.schedule(i, message_type(1, 1.0));
+    sched.schedule(i, 1.0);
   }
-  sched.start();
-  
+
   thread_group group;
   for (size_t i = 0;i < NCPUS;++i) {
     group.launch(boost::bind(test_basic_functionality_thread<SchedulerType>,
-                             boost::ref(sched), boost::ref(consensus), schedule_count, i));
+                             boost::ref(sched), schedule_count, i));
   }
-
   group.join();
+  drain_scheduler(sched);
+
   // check the counters
   for(size_t i = 0; i < NUM_VERTICES; ++i) {
-    TS_ASSERT_EQUALS(correctness_counter[i].value, (int)target_value);
+    TS_ASSERT_LESS_THAN_EQUALS(1, correctness_counter[i].value);
+    TS_ASSERT_LESS_THAN_EQUALS(correctness_counter[i].value, (int)maximum_value);
   }
+  TS_ASSERT(sched.empty());
 }
 
 
-
-
-
-
-
 /*
- * Like test_basic_functionality_thread, but only increments the 
- * correctness_counter by 1, and checks to make sure the priority is at least
- * 100.0
+ * Every vertex starts with a priority above min_priority and is then
+ * rescheduled below it, so it must run exactly once.
  */
-template <typename SchedulerType>
-void test_scheduler_min_priority_thread(SchedulerType& sched, 
-                                        async_consensus& consensus, 
-                                        size_t schedule_count,
-                                        size_t threadid) {
-  size_t c = 0;
-  vertex_id_type v; message_type m;
-  while(1) {
-    // process as many tasks as I can
-    while(1) {
-      sched_status::status_enum ret = sched.get_next(threadid, v, m);
-      if (ret == sched_status::NEW_TASK) {
-        TS_ASSERT_LESS_THAN_EQUALS(100.0, m.priority());
-        correctness_counter[v].inc(1);
-      }
-      else {
-        break;
-      }
-    }
-    
-    // schedule 1 cycle. If I schedule stuff I go back to processing tasks
-    if (c < schedule_count) {
-      for (size_t i = 0; i < NUM_VERTICES; ++i) {
-        sched.schedule(i, message_type(1, 1.0));
-        consensus.cancel();
-      }
-      ++c;
-      continue;
-    }
-    
-    // nothing to schedule, nothing to run. try to quit
-    consensus.begin_done_critical_section(threadid);
-    sched_status::status_enum ret = sched.get_next(threadid, v, m);
-    if (ret == sched_status::NEW_TASK) {
-      TS_ASSERT_LESS_THAN_EQUALS(100.0, m.priority());
-      // there is task. cancel, process it, and look back
-      consensus.cancel_critical_section(threadid);
-      correctness_counter[v].inc(1);
-    }
-    else {
-      // no more tasks try to finish up
-      bool ret = consensus.end_done_critical_section(threadid);
-      if (ret) break;
-    }
-  }
-}
-
-
 template <typename SchedulerType>
 void test_scheduler_min_priority_parallel() {
   graphlab_options opts;
   opts.set_ncpus(NCPUS);
   opts.get_scheduler_args().set_option("min_priority", 100.0);
-  
+
   SchedulerType sched(NUM_VERTICES, opts);
-  async_consensus consensus(dc, NCPUS);
-  
-  const size_t schedule_count = 10000;
-  const size_t maximum_value = (size_t)((schedule_count * NCPUS + 101.0) / 100.0);
 
   correctness_counter.clear();
   correctness_counter.resize(NUM_VERTICES, atomic<int>(0));
 
-  // inject a sequence of messages which will sum to 100 per vertex
   for (size_t i = 0; i < NUM_VERTICES; ++i) {
-    sched.schedule(i, message_type(1, 101.0));
+    sched.schedule(i, 101.0);
   }
-  sched.start();
-  
+
   thread_group group;
   for (size_t i = 0;i < NCPUS;++i) {
-    group.launch(boost::bind(test_scheduler_min_priority_thread<SchedulerType>,
-                             boost::ref(sched), boost::ref(consensus), schedule_count, i));
+    group.launch(boost::bind(test_basic_functionality_thread<SchedulerType>,
+                             boost::ref(sched), 1000, i));
   }
-
   group.join();
-  // check the counters
+  drain_scheduler(sched);
+
   for(size_t i = 0; i < NUM_VERTICES; ++i) {
-    TS_ASSERT_LESS_THAN_EQUALS(correctness_counter[i].value, (int)maximum_value);
+    TS_ASSERT_EQUALS(correctness_counter[i].value, 1);
+  }
+  TS_ASSERT(sched.empty());
+}
+
+
+/*
+ * Raising the priority of a scheduled vertex must let it run even if it
+ * was scheduled below min_priority, and must not run it twice.
+ */
+template <typename SchedulerType>
+void test_scheduler_promote() {
+  graphlab_options opts;
+  opts.set_ncpus(NCPUS);
+  opts.get_scheduler_args().set_option("min_priority", 100.0);
+  SchedulerType sched(NUM_VERTICES, opts);
+  for (size_t i = 0; i < NUM_VERTICES; ++i) {
+    sched.schedule(i, 1.0);
+  }
+  TS_ASSERT(sched.empty());
+  for (size_t i = 0; i < NUM_VERTICES; i += 2) {
+    sched.schedule(i, 200.0);
+    sched.schedule(i, 150.0);
+  }
+  correctness_counter.clear();
+  correctness_counter.resize(NUM_VERTICES, atomic<int>(0));
+  drain_scheduler(sched);
+  for(size_t i = 0; i < NUM_VERTICES; ++i) {
+    TS_ASSERT_EQUALS(correctness_counter[i].value, i % 2 == 0 ? 1 : 0);
   }
 }
 
-class SerializeTestSuite : public CxxTest::TestSuite {
+
+/*
+ * Vertices scheduled with distinct negated distances must come out in
+ * order of distance, including those beyond the window of buckets and
+ * those moved to an earlier bucket.
+ */
+void test_bucket_scheduler_order() {
+  const size_t numv = 1000;
+  graphlab_options opts;
+  opts.set_ncpus(NCPUS);
+  opts.get_scheduler_args().set_option("delta", 1.0);
+  bucket_scheduler sched(numv, opts);
+  std::vector<double> distance(numv);
+  for (size_t i = 0; i < numv; ++i) {
+    distance[i] = (i * 7919) % numv;
+    sched.schedule(i, -distance[i]);
+  }
+  // move the farthest vertex to the front, and a weaker signal is ignored
+  const lvid_type farthest =
+      std::max_element(distance.begin(), distance.end()) - distance.begin();
+  distance[farthest] = 0.5;
+  sched.schedule(farthest, -0.5);
+  sched.schedule(farthest, -5000.0);
+
+  std::vector<size_t> runs(numv, 0);
+  double last = -1;
+  lvid_type v;
+  while (sched.get_next(0, v) == sched_status::NEW_TASK) {
+    TS_ASSERT_LESS_THAN_EQUALS(std::floor(last), distance[v]);
+    last = distance[v];
+    ++runs[v];
+  }
+  for (size_t i = 0; i < numv; ++i) TS_ASSERT_EQUALS(runs[i], 1);
+  TS_ASSERT(sched.empty());
+}
+
+
+/**
+ * A vertex left in the overflow must run before a later bucket which
+ * is scheduled once the window has moved far enough to reach it.
+ */
+void test_bucket_scheduler_spill() {
+  graphlab_options opts;
+  opts.set_ncpus(NCPUS);
+  opts.get_scheduler_args().set_option("delta", 1.0);
+  bucket_scheduler sched(4, opts);
+  sched.schedule(0, -0.0);
+  sched.schedule(1, -100.0);
+  sched.schedule(2, -300.0);
+  lvid_type v;
+  TS_ASSERT_EQUALS(sched.get_next(0, v), sched_status::NEW_TASK);
+  TS_ASSERT_EQUALS(v, 0);
+  TS_ASSERT_EQUALS(sched.get_next(0, v), sched_status::NEW_TASK);
+  TS_ASSERT_EQUALS(v, 1);
+  // the window now starts at bucket 100 and reaches bucket 310
+  sched.schedule(3, -310.0);
+  TS_ASSERT_EQUALS(sched.get_next(0, v), sched_status::NEW_TASK);
+  TS_ASSERT_EQUALS(v, 2);
+  TS_ASSERT_EQUALS(sched.get_next(0, v), sched_status::NEW_TASK);
+  TS_ASSERT_EQUALS(v, 3);
+  TS_ASSERT(sched.empty());
+}
+
+
+class SchedulerTestSuite : public CxxTest::TestSuite {
 public:
   void test_scheduler_basic_single_threaded() {
-    test_scheduler_basic_functionality_single_threaded<sweep_scheduler<message_type> >();
-    test_scheduler_basic_functionality_single_threaded<fifo_scheduler<message_type> >();
-    test_scheduler_basic_functionality_single_threaded<priority_scheduler<message_type> >();
-    test_scheduler_basic_functionality_single_threaded<queued_fifo_scheduler<message_type> >();
+    test_scheduler_basic_functionality_single_threaded<sweep_scheduler>();
+    test_scheduler_basic_functionality_single_threaded<fifo_scheduler>();
+    test_scheduler_basic_functionality_single_threaded<priority_scheduler>();
+    test_scheduler_basic_functionality_single_threaded<queued_fifo_scheduler>();
+    test_scheduler_basic_functionality_single_threaded<multiqueue_scheduler>();
+    test_scheduler_basic_functionality_single_threaded<bucket_scheduler>();
   }
-  
+
   void test_scheduler_basic_parallel() {
-    test_scheduler_basic_functionality_parallel<sweep_scheduler<message_type> >();
-    test_scheduler_basic_functionality_parallel<fifo_scheduler<message_type> >();
-    test_scheduler_basic_functionality_parallel<priority_scheduler<message_type> >();
-    test_scheduler_basic_functionality_parallel<queued_fifo_scheduler<message_type> >();
+    test_scheduler_basic_functionality_parallel<sweep_scheduler>();
+    test_scheduler_basic_functionality_parallel<fifo_scheduler>();
+    test_scheduler_basic_functionality_parallel<priority_scheduler>();
+    test_scheduler_basic_functionality_parallel<queued_fifo_scheduler>();
+    test_scheduler_basic_functionality_parallel<multiqueue_scheduler>();
+    test_scheduler_basic_functionality_parallel<bucket_scheduler>();
   }
-  
-    
+
+
   void test_scheduler_min_priority() {
-    test_scheduler_min_priority_parallel<sweep_scheduler<message_type> >();
-    test_scheduler_min_priority_parallel<fifo_scheduler<message_type> >();
-    test_scheduler_min_priority_parallel<priority_scheduler<message_type> >();
-    test_scheduler_min_priority_parallel<queued_fifo_scheduler<message_type> >();
+    test_scheduler_min_priority_parallel<priority_scheduler>();
+    test_scheduler_min_priority_parallel<multiqueue_scheduler>();
   }
 
-};
+  void test_scheduler_priority_promote() {
+    test_scheduler_promote<multiqueue_scheduler>();
+  }
 
+  void test_scheduler_bucket_order() {
+    test_bucket_scheduler_order();
+    test_bucket_scheduler_spill();
+  }
+
+};
@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+/**
+ * Compares serializing a large blob into an oarchive which reallocates
+ * its buffer with serializing it in gather mode.
+ *
+ * usage: serialize_benchmark [rounds]
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <graphlab/serialization/serialization_includes.hpp>
+#include <graphlab/util/timer.hpp>
+
+
+using namespace graphlab;
+
+int main(int argc, char** argv) {
+  const size_t rounds = argc > 1 ? atol(argv[1]) : 10;
+  // a large blob of many medium sized vectors, as in vertex data
+  std::vector<std::vector<double> > blob(200);
+  for (size_t i = 0; i < blob.size(); ++i) blob[i].assign(5000 + i * 100, i);
+
+  size_t nbytes = 0;
+  timer ti;
+  for (size_t r = 0; r < rounds; ++r) {
+    oarchive a;
+    a.buf = (char*)malloc(4096); a.len = 4096;
+    a << blob;
+    nbytes = a.off;
+    free(a.buf);
+  }
+  const double realloc_time = ti.current_time();
+
+  size_t nbuffers = 0;
+  ti.start();
+  for (size_t r = 0; r < rounds; ++r) {
+    oarchive b;
+    b.buf = (char*)malloc(4096); b.len = 4096;
+    b.gather = new oarchive_gather;
+    b << blob;
+    nbuffers = b.gather->segments.size() + 1;
+    for (size_t i = 0; i < b.gather->segments.size(); ++i) {
+      free(b.gather->segments[i].first);
+    }
+    delete b.gather;
+    free(b.buf);
+  }
+  const double gather_time = ti.current_time();
+
+  std::cout << "Serializing " << nbytes << " bytes: "
+            << realloc_time / rounds * 1000 << " ms reallocating, "
+            << gather_time / rounds * 1000 << " ms in gather mode, in "
+            << nbuffers << " buffers" << std::endl;
+  return 0;
+}
@@ -36,6 +36,7 @@
 
 #include <graphlab/util/generics/any.hpp>
 #include <graphlab/serialization/serialization_includes.hpp>
+#include <graphlab/rpc/dc_compile_parameters.hpp>
 
 
 using namespace graphlab;
@@ -414,5 +415,63 @@ public:
         TS_ASSERT_EQUALS(p1[i].x, p2[i].x);
     }
   }
+
+  // the bytes written to an archive in gather mode. Frees its buffers
+  static std::string gathered_bytes(oarchive& arc) {
+    std::string ret;
+    for (size_t i = 0;i < arc.gather->segments.size(); ++i) {
+      ret.append(arc.gather->segments[i].first, arc.gather->segments[i].second);
+      free(arc.gather->segments[i].first);
+    }
+    ret.append(arc.buf, arc.off);
+    TS_ASSERT_EQUALS(ret.size(), arc.size());
+    delete arc.gather;
+    free(arc.buf);
+    return ret;
+  }
+
+  void test_gather_archive() {
+    // many vectors, together much larger than INITIAL_BUFFER_SIZE
+    std::vector<std::vector<double> > blob(200);
+    for (size_t i = 0;i < blob.size(); ++i) blob[i].assign(500 + i * 10, i);
+    oarchive a;
+    a.buf = (char*)malloc(INITIAL_BUFFER_SIZE);
+    a.len = INITIAL_BUFFER_SIZE;
+    a.gather = new oarchive_gather;
+    a << blob << std::string("end");
+    TS_ASSERT(a.gather->segments.size() > 1);
+    std::string bytes = gathered_bytes(a);
+
+    std::vector<std::vector<double> > blob2;
+    std::string end;
+    iarchive b(bytes.c_str(), bytes.size());
+    b >> blob2 >> end;
+    TS_ASSERT(blob2 == blob);
+    TS_ASSERT_EQUALS(end, "end");
+  }
+
+  void test_gather_archive_boundary() {
+    // a value which does not fit in the rest of a buffer starts the next
+    // one. A value which fits exactly does not.
+    oarchive a;
+    a.buf = (char*)malloc(16);
+    a.len = 16;
+    a.gather = new oarchive_gather;
+    a << 1.0 << 2.0 << 3.0;
+    TS_ASSERT_EQUALS(a.gather->segments.size(), 1);
+    TS_ASSERT_EQUALS(a.gather->segments[0].second, 16);
+    a << 'x' << 5.0;
+    std::string bytes = gathered_bytes(a);
+
+    double x1, x2, x3, x5;
+    char x4;
+    iarchive b(bytes.c_str(), bytes.size());
+    b >> x1 >> x2 >> x3 >> x4 >> x5;
+    TS_ASSERT_EQUALS(x1, 1.0);
+    TS_ASSERT_EQUALS(x2, 2.0);
+    TS_ASSERT_EQUALS(x3, 3.0);
+    TS_ASSERT_EQUALS(x4, 'x');
+    TS_ASSERT_EQUALS(x5, 5.0);
+  }
 };
 
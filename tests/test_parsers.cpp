@@ -21,7 +21,12 @@
  */
 
 
+#include <string>
+#include <sstream>
+#include <boost/filesystem.hpp>
 #include <graphlab/graph/distributed_graph.hpp>
+#include <graphlab/util/timer.hpp>
+#include <graphlab/util/random.hpp>
 #include <graphlab/macros_def.hpp>
 
 typedef graphlab::distributed_graph<size_t, size_t> graph_type;
@@ -118,12 +123,172 @@ void test_save_load(graphlab::distributed_control& dc) {
 }
 
 
+size_t edge_signature(const graph_type::edge_type& edge) {
+  return edge.source().id() * 1000003 + edge.target().id();
+}
+
+void test_chunked_load(graphlab::distributed_control& dc) {
+  graphlab::distributed_graph<size_t, size_t> graph(dc);
+  if (dc.procid() == 0) {
+    for (size_t i = 0; i < 1000; ++i) {
+      graph.add_edge(i, (i + 1) % 1000);
+      graph.add_edge(i, (i * 7 + 3) % 1000);
+    }
+  }
+  graph.finalize();
+  // all the machines share one scratch directory outside the source tree
+  std::string dir;
+  if (dc.procid() == 0) {
+    boost::filesystem::path ph = boost::filesystem::temp_directory_path() /
+                                 boost::filesystem::unique_path();
+    boost::filesystem::create_directory(ph);
+    dir = ph.string();
+  }
+  dc.broadcast(dir, dc.procid() == 0);
+  const std::string prefix = dir + "/chunktest_tsv";
+  graph.save_format(prefix, "tsv", false, 1);
+  // a tiny chunk size puts most range boundaries in the middle of a line
+  graphlab::graphlab_options opts;
+  opts.get_graph_args().set_option("ingress_chunk_size", 37);
+  graphlab::distributed_graph<size_t, size_t> graph2(dc, opts);
+  graph2.load_format(prefix, "tsv");
+  graph2.finalize();
+  ASSERT_EQ(graph.num_vertices(), graph2.num_vertices());
+  ASSERT_EQ(graph.num_edges(), graph2.num_edges());
+  ASSERT_EQ(graph.map_reduce_edges<size_t>(edge_signature),
+            graph2.map_reduce_edges<size_t>(edge_signature));
+  dc.barrier();
+  if (dc.procid() == 0) boost::filesystem::remove_all(dir);
+}
+
+/**
+ * Minimal graph stand in which only records the parsed edges, so that
+ * the benchmark measures the parsers rather than the ingress.
+ */
+struct edge_counter {
+  size_t nedges;
+  size_t checksum;
+  edge_counter() : nedges(0), checksum(0) { }
+  void add_edge(size_t source, size_t target) {
+    ++nedges;
+    checksum += source * 1000003 + target;
+  }
+};
+
+// The strtoul and stringstream based parsers which the tokenizer replaced
+bool reference_tsv_parser(edge_counter& graph, const std::string& str) {
+  if (str.empty()) return true;
+  char* targetptr;
+  size_t source = strtoul(str.c_str(), &targetptr, 10);
+  size_t target = strtoul(targetptr, NULL, 10);
+  if (source != target) graph.add_edge(source, target);
+  return true;
+}
+
+bool reference_adj_parser(edge_counter& graph, const std::string& line) {
+  if (line.empty()) return true;
+  std::stringstream strm(line);
+  size_t source, n;
+  strm >> source >> n;
+  if (strm.fail()) return false;
+  size_t nadded = 0;
+  while (strm.good()) {
+    size_t target;
+    strm >> target;
+    if (strm.fail()) break;
+    if (source != target) graph.add_edge(source, target);
+    ++nadded;
+  }
+  return n == nadded;
+}
+
+template <typename Parser>
+double time_parser(const std::vector<std::string>& lines, Parser parser,
+                   edge_counter& counter) {
+  graphlab::timer ti; ti.start();
+  for (size_t i = 0; i < lines.size(); ++i) {
+    ASSERT_TRUE(parser(counter, "", lines[i]));
+  }
+  return ti.current_time();
+}
+
+bool reference_tsv(edge_counter& graph, const std::string&,
+                   const std::string& str) {
+  return reference_tsv_parser(graph, str);
+}
+
+bool reference_adj(edge_counter& graph, const std::string&,
+                   const std::string& str) {
+  return reference_adj_parser(graph, str);
+}
+
+void benchmark_parsers() {
+  graphlab::random::seed(1);
+  std::vector<std::string> tsv_lines, adj_lines;
+  size_t nbytes_tsv = 0, nbytes_adj = 0;
+  for (size_t i = 0; i < 500000; ++i) {
+    tsv_lines.push_back(graphlab::tostr(graphlab::random::fast_uniform<size_t>(0, 100000000)) + "\t" +
+                        graphlab::tostr(graphlab::random::fast_uniform<size_t>(0, 100000000)));
+    nbytes_tsv += tsv_lines.back().size() + 1;
+  }
+  for (size_t i = 0; i < 50000; ++i) {
+    std::string line = graphlab::tostr(i) + " 10";
+    for (size_t j = 0; j < 10; ++j) {
+      line += " " + graphlab::tostr(graphlab::random::fast_uniform<size_t>(0, 100000000));
+    }
+    adj_lines.push_back(line);
+    nbytes_adj += line.size() + 1;
+  }
+  edge_counter ref_tsv, new_tsv, ref_adj, new_adj;
+  double t_ref_tsv = time_parser(tsv_lines, reference_tsv, ref_tsv);
+  double t_new_tsv = time_parser(tsv_lines,
+                     graphlab::builtin_parsers::tsv_parser<edge_counter>, new_tsv);
+  double t_ref_adj = time_parser(adj_lines, reference_adj, ref_adj);
+  double t_new_adj = time_parser(adj_lines,
+                     graphlab::builtin_parsers::adj_parser<edge_counter>, new_adj);
+  ASSERT_EQ(ref_tsv.nedges, new_tsv.nedges);
+  ASSERT_EQ(ref_tsv.checksum, new_tsv.checksum);
+  ASSERT_EQ(ref_adj.nedges, new_adj.nedges);
+  ASSERT_EQ(ref_adj.checksum, new_adj.checksum);
+  const double mb = 1024.0 * 1024.0;
+  std::cout << "tsv parse: reference " << nbytes_tsv / mb / t_ref_tsv
+            << " MB/s, tokenizer " << nbytes_tsv / mb / t_new_tsv << " MB/s\n";
+  std::cout << "adj parse: reference " << nbytes_adj / mb / t_ref_adj
+            << " MB/s, tokenizer " << nbytes_adj / mb / t_new_adj << " MB/s\n";
+}
+
+void test_tokenizer() {
+  edge_counter counter;
+  // separators, trailing columns and blank lines
+  ASSERT_TRUE(graphlab::builtin_parsers::tsv_parser(counter, "", "  12\t34\t0.5\r"));
+  ASSERT_TRUE(graphlab::builtin_parsers::tsv_parser(counter, "", " \t "));
+  ASSERT_EQ(counter.nedges, 1);
+  ASSERT_EQ(counter.checksum, 12 * 1000003 + 34);
+  ASSERT_FALSE(graphlab::builtin_parsers::tsv_parser(counter, "", "12"));
+  ASSERT_FALSE(graphlab::builtin_parsers::tsv_parser(counter, "", "a b"));
+  // ids long enough to take the vector path
+  ASSERT_TRUE(graphlab::builtin_parsers::tsv_parser(counter, "",
+              "00000000000000000000000000000000000000007 18446744073709551615"));
+  ASSERT_EQ(counter.nedges, 2);
+  ASSERT_FALSE(graphlab::builtin_parsers::tsv_parser(counter, "",
+               "1 18446744073709551616"));
+  // adjacency lists with optional commas must match the target count
+  ASSERT_TRUE(graphlab::builtin_parsers::adj_parser(counter, "", "5, 2, 6, 7"));
+  ASSERT_EQ(counter.nedges, 4);
+  ASSERT_FALSE(graphlab::builtin_parsers::adj_parser(counter, "", "5 3 6 7"));
+  ASSERT_FALSE(graphlab::builtin_parsers::adj_parser(counter, "", "5 1 6 x"));
+  ASSERT_EQ(counter.nedges, 4);
+}
+
 int main(int argc, char** argv) {
+  test_tokenizer();
+  benchmark_parsers();
   graphlab::distributed_control dc;
   test_adj(dc);
   test_snap(dc);
   test_tsv(dc);
   test_powerlaw(dc);
   test_save_load(dc);
+  test_chunked_load(dc);
 };
 
@@ -26,6 +26,7 @@
 #include <graphlab/parallel/pthread_tools.hpp>
 #include <graphlab/parallel/thread_pool.hpp>
 #include <graphlab/parallel/atomic.hpp>
+#include <graphlab/parallel/work_stealing_ranges.hpp>
 #include <graphlab/logger/assertions.hpp>
 #include <graphlab/util/timer.hpp>
 #include <boost/bind.hpp>
@@ -154,6 +155,36 @@ void test_pool_exception_forwarding(){
 
 
 
+void claim_ranges(work_stealing_ranges* ranges, size_t thread_id,
+                  std::vector<atomic<size_t> >* claims) {
+  size_t begin, end;
+  while (ranges->next(thread_id, begin, end)) {
+    // thread 0 is slow so that the others run out of work and steal
+    if (thread_id == 0) usleep(1000);
+    for (size_t i = begin; i < end; ++i) (*claims)[i].inc();
+  }
+}
+
+void test_ranges() {
+  const size_t nthreads = 4, nchunks = 1000;
+  work_stealing_ranges ranges;
+  std::vector<size_t> bounds;
+  for (size_t i = 0; i <= nchunks; ++i) bounds.push_back(3 * i);
+  ranges.reset(nthreads, bounds);
+  TS_ASSERT_EQUALS(ranges.num_chunks(), nchunks);
+  std::vector<atomic<size_t> > claims(3 * nchunks);
+  thread_group group;
+  for (size_t i = 0; i < nthreads; ++i) {
+    group.launch(boost::bind(claim_ranges, &ranges, i, &claims));
+  }
+  group.join();
+  for (size_t i = 0; i < claims.size(); ++i) {
+    TS_ASSERT_EQUALS(claims[i].value, 1);
+  }
+  std::cout << ranges.num_steals() << " steals" << std::endl;
+  TS_ASSERT_LESS_THAN(0, ranges.num_steals());
+}
+
 
 
 class ThreadToolsTestSuite : public CxxTest::TestSuite {
@@ -170,4 +201,8 @@ public:
     test_pool_exception_forwarding();
   }
 
+  void test_work_stealing_ranges(void) {
+    test_ranges();
+  }
+
 };
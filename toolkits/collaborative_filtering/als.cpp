@@ -191,9 +191,20 @@ get_other_vertex(graph_type::edge_type& edge,
  * added. The gather type represents that tuple and provides the
  * necessary gather_type::operator+= operation.
  *
+ * If BLOCK is not zero, the gather function instead returns the
+ * neighbor factor itself. The factors are packed as the columns of X as
+ * they are added, and every BLOCK of them is added to XtX with a single
+ * symmetric rank-k update (XtX += X * X^T, a BLAS-3 syrk) instead of one
+ * rank-1 update per rating.
  */
 class gather_type {
 public:
+  /**
+   * \brief The number of neighbor factors packed before they are added
+   * to XtX. 0 adds every factor to XtX in the gather function.
+   */
+  static size_t BLOCK;
+
   /**
    * \brief Stores the current sum of nbr.factor.transpose() *
    * nbr.factor
@@ -205,48 +216,132 @@ public:
    */
   vec_type Xy;
 
+  /**
+   * \brief The neighbor factors not yet added to XtX and Xy, one per
+   * column. Only the first nX columns are used.
+   */
+  mat_type X;
+
+  /** \brief The observed values of the factors in X */
+  vec_type y;
+
+  /** \brief The number of factors in X */
+  size_t nX;
+
   /** \brief basic default constructor */
-  gather_type() { }
+  gather_type() : nX(0) { }
 
   /**
    * \brief This constructor computes XtX and Xy and stores the result
-   * in XtX and Xy
+   * in XtX and Xy, or packs X and y if BLOCK is set
    */
-  gather_type(const vec_type& X, const double y) :
-    XtX(X.size(), X.size()), Xy(X.size()) {
+  gather_type(const vec_type& X, const double y) : nX(0) {
+    if (BLOCK > 0) {
+      this->X = X;
+      this->y.resize(1);
+      this->y(0) = y;
+      nX = 1;
+      return;
+    }
+    XtX.resize(X.size(), X.size());
     XtX.triangularView<Eigen::Upper>() = X * X.transpose();
     Xy = X * y;
   } // end of constructor for gather type
 
   /** \brief Save the values to a binary archive */
-  void save(graphlab::oarchive& arc) const { arc << XtX << Xy; }
+  void save(graphlab::oarchive& arc) const {
+    arc << XtX << Xy << nX;
+    if (nX > 0) {
+      const size_t rows = X.rows();
+      arc << rows;
+      // only the used columns, which are contiguous
+      graphlab::serialize(arc, X.data(), rows * nX * sizeof(double));
+      graphlab::serialize(arc, y.data(), nX * sizeof(double));
+    }
+  }
 
   /** \brief Read the values from a binary archive */
-  void load(graphlab::iarchive& arc) { arc >> XtX >> Xy; }  
+  void load(graphlab::iarchive& arc) {
+    arc >> XtX >> Xy >> nX;
+    if (nX > 0) {
+      size_t rows = 0;
+      arc >> rows;
+      X.resize(rows, nX);
+      y.resize(nX);
+      graphlab::deserialize(arc, X.data(), rows * nX * sizeof(double));
+      graphlab::deserialize(arc, y.data(), nX * sizeof(double));
+    }
+  }
+
+  /** \brief Returns true if nothing was added */
+  bool empty() const { return Xy.size() == 0 && nX == 0; }
 
   /** 
    * \brief Computes XtX += other.XtX and Xy += other.Xy updating this
-   * tuples value
+   * tuples value, and packs the factors of other into X
    */
   gather_type& operator+=(const gather_type& other) {
-    if(other.Xy.size() == 0) {
+    if(other.empty()) {
       ASSERT_EQ(other.XtX.rows(), 0);
       ASSERT_EQ(other.XtX.cols(), 0);
+    } else if(empty()) {
+      ASSERT_EQ(XtX.rows(), 0); 
+      ASSERT_EQ(XtX.cols(), 0);
+      (*this) = other;
     } else {
-      if(Xy.size() == 0) {
-        ASSERT_EQ(XtX.rows(), 0); 
-        ASSERT_EQ(XtX.cols(), 0);
-        XtX = other.XtX; Xy = other.Xy;
-      } else {
-        XtX.triangularView<Eigen::Upper>() += other.XtX;  
-        Xy += other.Xy;
+      if(other.Xy.size() > 0) {
+        if(Xy.size() == 0) {
+          XtX = other.XtX; Xy = other.Xy;
+        } else {
+          XtX.triangularView<Eigen::Upper>() += other.XtX;  
+          Xy += other.Xy;
+        }
+      }
+      for(size_t j = 0; j < other.nX; ++j) {
+        if(nX == size_t(X.cols())) {
+          if(nX < BLOCK) {
+            X.conservativeResize(other.X.rows(), BLOCK);
+            y.conservativeResize(BLOCK);
+          } else {
+            add_packed(XtX, Xy);
+            nX = 0;
+          }
+        }
+        X.col(nX) = other.X.col(j);
+        y(nX) = other.y(j);
+        ++nX;
       }
     }
     return *this;
   } // end of operator+=
 
+  /**
+   * \brief Computes the complete sums XtX and Xy, including the
+   * factors which are still packed
+   */
+  void normal_equations(mat_type& XtX, vec_type& Xy) const {
+    if(this->Xy.size() > 0) {
+      XtX = this->XtX; Xy = this->Xy;
+    } else {
+      XtX.setZero(X.rows(), X.rows()); Xy.setZero(X.rows());
+    }
+    if(nX > 0) add_packed(XtX, Xy);
+  }
+
+private:
+  /** \brief Adds the packed factors to XtX and Xy */
+  void add_packed(mat_type& XtX, vec_type& Xy) const {
+    if(Xy.size() == 0) {
+      XtX.setZero(X.rows(), X.rows()); Xy.setZero(X.rows());
+    }
+    XtX.selfadjointView<Eigen::Upper>().rankUpdate(X.leftCols(nX));
+    Xy.noalias() += X.leftCols(nX) * y.head(nX);
+  }
+
 }; // end of gather type
 
+size_t gather_type::BLOCK = 0;
+
 
 
 /**
@@ -313,9 +408,9 @@ public:
     vertex_data& vdata = vertex.data(); 
     // Determine the number of neighbors.  Each vertex has only in or
     // out edges depending on which side of the graph it is located
-    if(sum.Xy.size() == 0) { vdata.residual = 0; ++vdata.nupdates; return; }
-    mat_type XtX = sum.XtX;
-    vec_type Xy = sum.Xy;
+    if(sum.empty()) { vdata.residual = 0; ++vdata.nupdates; return; }
+    mat_type XtX; vec_type Xy;
+    sum.normal_equations(XtX, Xy);
     // Add regularization
     double regularization = LAMBDA;
     if (REGNORMAL)
@@ -598,6 +693,10 @@ int main(int argc, char** argv) {
                        "The engine type synchronous or asynchronous");
   clopts.attach_option("regnormal", als_vertex_program::REGNORMAL, 
                        "regularization type. 1 = weighted according to neighbors num. 0 = no weighting - just lambda");
+  clopts.attach_option("block", gather_type::BLOCK,
+                       "If not 0, pack this many neighbor factors and add "
+                       "them to XtX with one rank-k update instead of one "
+                       "rank-1 update per rating");
   
   parse_implicit_command_line(clopts);
   
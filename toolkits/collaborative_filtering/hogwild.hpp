@@ -0,0 +1,196 @@
+/**
+ * Copyright (c) 2009 Carnegie Mellon University.
+ *     All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing,
+ *  software distributed under the License is distributed on an "AS
+ *  IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ *  express or implied.  See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ * For more about this software visit:
+ *
+ *      http://www.graphlab.ml.cmu.edu
+ *
+ */
+
+#ifndef _HOGWILD_HPP__
+#define _HOGWILD_HPP__
+
+/**
+ * \file
+ *
+ * \brief Lock free shared memory SGD over the local edges of the graph.
+ *
+ * Instead of running a vertex program, every machine makes passes over
+ * the training edges it holds, updating the latent factors in place.
+ * The users and the items are split into nblocks groups each, which
+ * splits the ratings into nblocks x nblocks blocks. Block (i, j) holds
+ * the ratings of the users in group i for the items in group j. A pass
+ * runs nblocks strata, and stratum s processes the blocks
+ * (i, (i + s) % nblocks) in parallel. These touch disjoint users and
+ * items, so no locks are needed and no update is lost. The ratings of
+ * every block are shuffled in place before each pass.
+ *
+ * The replicas of a vertex on different machines are updated
+ * independently. Every sync_interval passes, the changes made by all
+ * the replicas since the last synchronization are summed on the master
+ * and the result is sent back to the mirrors.
+ *
+ * The Model type provides the SGD step and the synchronization:
+ * \code
+ * struct model {
+ *   // the change in a vertex since the last synchronization
+ *   typedef ... delta_type; // supports +=, save and load
+ *   static void update(vertex_data& user, vertex_data& item, float obs);
+ *   static delta_type delta(const vertex_data& now, const vertex_data& last);
+ *   // sets v to last plus the sum of the deltas of all replicas
+ *   static void apply(vertex_data& v, const vertex_data& last,
+ *                     const delta_type& sum);
+ * };
+ * \endcode
+ */
+
+#include <vector>
+#include <boost/bind.hpp>
+#include <graphlab/util/generics/shuffle.hpp>
+
+template <typename Model>
+class hogwild_sgd {
+ public:
+  typedef graph_type::lvid_type lvid_type;
+  typedef typename Model::delta_type delta_type;
+
+  /// A training edge of the local graph
+  struct rating {
+    lvid_type user, item;
+    float obs;
+  };
+
+  /**
+   * Collects the training edges of the local graph into blocks. Must be
+   * called on all machines at the same time.
+   */
+  hogwild_sgd(graph_type& graph, const graphlab::graphlab_options& opts,
+              size_t nblocks) :
+    graph(graph), nblocks(std::max<size_t>(nblocks, 1)),
+    blocks(this->nblocks * this->nblocks), nratings(0),
+    sync(graph,
+         boost::bind(&hogwild_sgd::sync_gather, this, _1, _2),
+         boost::bind(&hogwild_sgd::sync_apply, this, _1, _2, _3),
+         opts) {
+    graph_type::local_graph_type& lgraph = graph.get_local_graph();
+    for (lvid_type lvid = 0; lvid < lgraph.num_vertices(); ++lvid) {
+      foreach(const graph_type::local_graph_type::edge_type& e,
+              lgraph.out_edges(lvid)) {
+        if (e.data().role != edge_data::TRAIN) continue;
+        rating r;
+        r.user = e.source().id();
+        r.item = e.target().id();
+        r.obs = e.data().obs;
+        blocks[block_of(r.user, r.item)].push_back(r);
+        ++nratings;
+      }
+    }
+    // the vertex data is random, so make the replicas agree first
+    graph.synchronize();
+    last.resize(lgraph.num_vertices());
+    for (lvid_type lvid = 0; lvid < lgraph.num_vertices(); ++lvid) {
+      last[lvid] = lgraph.vertex_data(lvid);
+    }
+  }
+
+  /// The number of training edges on this machine
+  size_t num_local_ratings() const { return nratings; }
+
+  /// Makes one pass over the local training edges
+  void run_pass() {
+    graph_type::local_graph_type& lgraph = graph.get_local_graph();
+    for (size_t s = 0; s < nblocks; ++s) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+      for (int i = 0; i < (int)nblocks; ++i) {
+        std::vector<rating>& block = blocks[i * nblocks + (i + s) % nblocks];
+        if (block.empty()) continue;
+        // walk the ratings in a new random order, but sequentially
+        std::vector<size_t> order =
+            graphlab::random::permutation<size_t>(block.size());
+        graphlab::inplace_shuffle(block.begin(), block.end(), order);
+        for (size_t j = 0; j < block.size(); ++j) {
+          Model::update(lgraph.vertex_data(block[j].user),
+                        lgraph.vertex_data(block[j].item),
+                        block[j].obs);
+        }
+      }
+    }
+  }
+
+  /**
+   * Makes all the replicas of every vertex agree again. Must be called
+   * on all machines at the same time.
+   */
+  void synchronize() {
+    sync.exec();
+  }
+
+ private:
+  graph_type& graph;
+  size_t nblocks;
+  std::vector<std::vector<rating> > blocks;
+  size_t nratings;
+  /// The vertex data at the last synchronization
+  std::vector<vertex_data> last;
+  graphlab::graph_gather_apply<graph_type, delta_type> sync;
+
+  size_t block_of(lvid_type user, lvid_type item) const {
+    return (user % nblocks) * nblocks + (item % nblocks);
+  }
+
+  delta_type sync_gather(lvid_type lvid, graph_type& graph) {
+    return Model::delta(graph.get_local_graph().vertex_data(lvid), last[lvid]);
+  }
+
+  void sync_apply(lvid_type lvid, const delta_type& sum, graph_type& graph) {
+    vertex_data& vdata = graph.get_local_graph().vertex_data(lvid);
+    Model::apply(vdata, last[lvid], sum);
+    last[lvid] = vdata;
+  }
+};
+
+
+/**
+ * Runs npasses hogwild passes on all machines, synchronizing the
+ * factors every sync_interval passes and after the last one, and
+ * multiplying the step size gamma by step_dec after every pass.
+ * Returns the total number of SGD steps taken by all machines.
+ */
+template <typename Model>
+size_t run_hogwild_sgd(graph_type& graph, graphlab::distributed_control& dc,
+                       const graphlab::graphlab_options& opts,
+                       size_t npasses, size_t sync_interval,
+                       double& gamma, double step_dec) {
+  hogwild_sgd<Model> sgd(graph, opts, opts.get_ncpus());
+  sync_interval = std::max<size_t>(sync_interval, 1);
+  graphlab::timer timer;
+  for (size_t pass = 1; pass <= npasses; ++pass) {
+    sgd.run_pass();
+    if (dc.numprocs() > 1 && (pass % sync_interval == 0 || pass == npasses)) {
+      sgd.synchronize();
+    }
+    gamma *= step_dec;
+    dc.cout() << "Pass " << pass << " finished at " << timer.current_time()
+              << " seconds" << std::endl;
+  }
+  size_t nupdates = sgd.num_local_ratings() * npasses;
+  dc.all_reduce(nupdates);
+  return nupdates;
+}
+
+#endif
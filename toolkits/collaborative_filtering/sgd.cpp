@@ -519,6 +519,43 @@ double sgd_vertex_program::MINVAL = -1e+100;
 double sgd_vertex_program::STEP_DEC = 0.9;
 bool sgd_vertex_program::debug = false;
 
+#include "hogwild.hpp"
+
+/**
+ * \brief The SGD step and factor synchronization used by the hogwild
+ * mode. See hogwild.hpp
+ */
+struct sgd_hogwild_model {
+	typedef gather_type delta_type;
+
+	static void update(vertex_data& user, vertex_data& item, float obs) {
+		double pred = user.pvec.dot(item.pvec);
+		pred = std::min(pred, sgd_vertex_program::MAXVAL);
+		pred = std::max(pred, sgd_vertex_program::MINVAL);
+		const double err = obs - pred;
+		const double gamma = sgd_vertex_program::GAMMA;
+		const double lambda = sgd_vertex_program::LAMBDA;
+		//both gradients use the old values, as in the vertex program
+		for (int i = 0; i < user.pvec.size(); i++){
+			const double u = user.pvec[i];
+			const double v = item.pvec[i];
+			user.pvec[i] += gamma*(err*v - lambda*u);
+			item.pvec[i] += gamma*(err*u - lambda*v);
+		}
+	}
+
+	static delta_type delta(const vertex_data& now, const vertex_data& last) {
+		return gather_type(now.pvec - last.pvec);
+	}
+
+	static void apply(vertex_data& vdata, const vertex_data& last,
+			const delta_type& sum) {
+		vdata.pvec = last.pvec;
+		if (sum.pvec.size() > 0)
+			vdata.pvec += sum.pvec;
+	}
+};
+
 
 /**
  * \brief The engine type used by the SGD matrix factorization
@@ -566,6 +603,12 @@ int main(int argc, char** argv) {
 			"The time in seconds between error reports");
 	clopts.attach_option("predictions", predictions,
 			"The prefix (folder and filename) to save predictions.");
+	bool hogwild = false;
+	size_t sync_interval = 1;
+	clopts.attach_option("hogwild", hogwild,
+			"If true, run lock free parallel SGD passes over the local ratings instead of the vertex program. max_iter is the number of passes");
+	clopts.attach_option("sync_interval", sync_interval,
+			"In hogwild mode, the number of passes between factor synchronizations across machines");
 
 	parse_implicit_command_line(clopts);
 
@@ -574,6 +617,10 @@ int main(int argc, char** argv) {
 		clopts.print_description();
 		return EXIT_FAILURE;
 	}
+	if (hogwild && sgd_vertex_program::MAX_UPDATES == size_t(-1)) {
+		std::cout << "--max_iter is required with --hogwild" << std::endl;
+		return EXIT_FAILURE;
+	}
 	debug = sgd_vertex_program::debug;
 	//  omp_set_num_threads(clopts.get_ncpus());
 	///! Initialize control plain using mpi
@@ -644,16 +691,25 @@ int main(int argc, char** argv) {
 	dc.cout() << "Time   Training    Validation" <<std::endl;
 	dc.cout() << "       RMSE        RMSE " <<std::endl;
 	timer.start();
-	engine.start();  
+	size_t num_updates = 0;
+	if (hogwild) {
+		num_updates = run_hogwild_sgd<sgd_hogwild_model>(graph, dc, clopts,
+				sgd_vertex_program::MAX_UPDATES, sync_interval,
+				sgd_vertex_program::GAMMA, sgd_vertex_program::STEP_DEC);
+	}
+	else {
+		engine.start();  
+		num_updates = engine.num_updates();
+	}
 
 	const double runtime = timer.current_time();
 	dc.cout() << "----------------------------------------------------------"
 		<< std::endl
 		<< "Final Runtime (seconds):   " << runtime 
 						    << std::endl
-								<< "Updates executed: " << engine.num_updates() << std::endl
+								<< "Updates executed: " << num_updates << std::endl
 											      << "Update Rate (updates/second): " 
-												      << engine.num_updates() / runtime << std::endl;
+												      << num_updates / runtime << std::endl;
 
 	// Compute the final training error -----------------------------------------
 	dc.cout() << "Final error: " << std::endl;
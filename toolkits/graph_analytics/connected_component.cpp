@@ -132,6 +132,15 @@ public:
       context.signal(edge.target(), min_message(vertex.data().labelid));
     }
   }
+
+  //scatter only signals the ends of the edge, so it can also be pulled
+  bool supports_pull() const {
+    return true;
+  }
+  edge_dir_type pull_edges(icontext_type& context,
+      const vertex_type& vertex) const {
+    return graphlab::ALL_EDGES;
+  }
 };
 
 class graph_writer {
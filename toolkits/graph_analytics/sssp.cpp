@@ -75,6 +75,14 @@ get_other_vertex(const graph_type::edge_type& edge,
 bool DIRECTED_SSSP = false;
 
 
+/**
+ * \brief Set if every edge has distance 1. The synchronous engine then
+ * runs a breadth first search, so a vertex is final once it has been
+ * reached.
+ */
+bool UNIT_DISTANCES = false;
+
+
 /**
  * \brief This class is used as the gather type.
  */
@@ -86,6 +94,11 @@ struct min_distance_type : graphlab::IS_POD_TYPE {
     dist = std::min(dist, other.dist);
     return *this;
   }
+  /**
+   * \brief Lets the priority schedulers (e.g. --scheduler=buckets)
+   * run the closest vertices first.
+   */
+  double priority() const { return -dist; }
 };
 
 
@@ -161,6 +174,30 @@ public:
     }
   } // end of scatter
 
+  /**
+   * \brief The scatter only signals the other end of the edge so it
+   * may also be pulled by the vertices receiving the signals
+   */
+  bool supports_pull() const { return true; }
+
+  edge_dir_type pull_edges(icontext_type& context,
+                           const vertex_type& vertex) const {
+    // with unit distances only the vertices not reached yet can improve
+    if (UNIT_DISTANCES &&
+        vertex.data().dist != std::numeric_limits<distance_type>::max())
+      return graphlab::NO_EDGES;
+    return DIRECTED_SSSP? graphlab::IN_EDGES : graphlab::ALL_EDGES;
+  }; // end of pull_edges
+
+  /**
+   * \brief With unit distances every vertex scattering in an iteration
+   * is at the same distance, so the first message is the final one.
+   */
+  bool pull_complete(icontext_type& context, const vertex_type& vertex,
+                     const min_distance_type& msg) const {
+    return UNIT_DISTANCES;
+  } // end of pull_complete
+
 }; // end of shortest path vertex program
 
 
@@ -199,6 +236,10 @@ max_deg_vertex_reducer find_max_deg_vertex(const graph_type::vertex_type vtx) {
   return red;
 }
 
+size_t count_non_unit_edges(const graph_type::edge_type& edge) {
+  return edge.data().dist == 1 ? 0 : 1;
+}
+
 int main(int argc, char** argv) {
   // Initialize control plain using mpi
   graphlab::mpi_tools::init(argc, argv);
@@ -266,6 +307,8 @@ int main(int argc, char** argv) {
   dc.cout() << "#vertices:  " << graph.num_vertices() << std::endl
             << "#edges:     " << graph.num_edges() << std::endl;
 
+  UNIT_DISTANCES = graph.map_reduce_edges<size_t>(count_non_unit_edges) == 0;
+
   double load_elapsed_secs = load_timer.current_time();
   std::cout << "Load: " << load_elapsed_secs << " seconds." << std::endl;
 
@@ -21,6 +21,10 @@
  */
 
 
+#include <algorithm>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include <boost/unordered_set.hpp>
 #include <graphlab.hpp>
 #include <graphlab/ui/metrics_server.hpp>
@@ -66,6 +70,15 @@
  * \endverbatim
  * Must be counted only once. (Only when processing edge AB, can one
  * observe that A and B have intersecting out-neighbor sets).
+ *
+ * When the whole graph is on one machine, a second "merge" path skips the
+ * engine and works on the local graph directly. Every edge is oriented
+ * from the endpoint with fewer edges to the one with more, the oriented
+ * neighbors of each vertex are kept in one sorted array, and the
+ * triangles on an oriented edge (u,v) are counted by a merge intersection
+ * of the arrays of u and v (SSE2 accelerated, or galloping if one array
+ * is much longer than the other). Every triangle is then found exactly
+ * once, and no neighbor sets are built on the vertices.
  */
  
 
@@ -315,8 +328,110 @@ static uint32_t count_set_intersect(
 }
 
 
+/*
+ * Galloping is used to intersect two sorted arrays when one is more than
+ * GALLOP_RATIO times longer than the other.
+ */
+size_t GALLOP_RATIO = 32;
+
+/*
+ * Returns the first position in [begin, end) which is not less than val.
+ * Probes 1, 2, 4, ... elements ahead before the binary search, so it is
+ * cheap when the answer is close to begin.
+ */
+static inline const uint32_t* gallop(const uint32_t* begin,
+                                     const uint32_t* end,
+                                     uint32_t val) {
+  const uint32_t* lo = begin;
+  size_t step = 1;
+  while (size_t(end - lo) > step && lo[step] < val) {
+    lo += step;
+    step <<= 1;
+  }
+  return std::lower_bound(lo, std::min(lo + step + 1, end), val);
+}
+
+/*
+ * Calls visit(w) for every w in the intersection of the sorted arrays
+ * [a, aend) and [b, bend), where the first array is the shorter one.
+ */
+template <typename Visitor>
+static void visit_intersect(const uint32_t* a, const uint32_t* aend,
+                            const uint32_t* b, const uint32_t* bend,
+                            Visitor& visit) {
+  if (size_t(aend - a) * GALLOP_RATIO < size_t(bend - b)) {
+    while (a < aend && b < bend) {
+      b = gallop(b, bend, *a);
+      if (b == bend) break;
+      if (*b == *a) {
+        visit(*a);
+        ++b;
+      }
+      ++a;
+    }
+  }
+  else {
+    while (a < aend && b < bend) {
+      if (*a < *b) ++a;
+      else if (*b < *a) ++b;
+      else {
+        visit(*a);
+        ++a; ++b;
+      }
+    }
+  }
+}
+
+// A visitor which only counts
+struct count_visitor {
+  size_t count;
+  count_visitor(): count(0) { }
+  void operator()(uint32_t) { ++count; }
+};
 
+// A visitor which also counts the triangle on the third vertex
+struct per_vertex_visitor {
+  uint32_t* counts;
+  size_t count;
+  per_vertex_visitor(uint32_t* counts): counts(counts), count(0) { }
+  void operator()(uint32_t w) {
+    __sync_fetch_and_add(counts + w, 1);
+    ++count;
+  }
+};
 
+/*
+ * Computes the size of the intersection of the sorted arrays
+ * [a, aend) and [b, bend), where the first array is the shorter one.
+ * Blocks of 4 elements of each array are compared all against all
+ * with SSE2, advancing the block with the smaller last element.
+ */
+static size_t count_sorted_intersect(const uint32_t* a, const uint32_t* aend,
+                                     const uint32_t* b, const uint32_t* bend) {
+  size_t count = 0;
+#if defined(__SSE2__)
+  if (size_t(aend - a) * GALLOP_RATIO >= size_t(bend - b)) {
+    while (aend - a >= 4 && bend - b >= 4) {
+      const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+      const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+      const __m128i eq = _mm_or_si128(
+          _mm_or_si128(_mm_cmpeq_epi32(va, vb),
+                       _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x39))),
+          _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x4e)),
+                       _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x93))));
+      count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(eq)));
+      const uint32_t amax = a[3];
+      const uint32_t bmax = b[3];
+      if (amax <= bmax) a += 4;
+      if (bmax <= amax) b += 4;
+    }
+  }
+#endif
+  // the rest, or all of it if galloping
+  count_visitor visit;
+  visit_intersect(a, aend, b, bend, visit);
+  return count + visit.count;
+}
 
 
 /*
@@ -592,6 +707,131 @@ struct save_triangle_count{
 };
 
 
+
+/*
+ * The local graph with every edge oriented from the endpoint with fewer
+ * edges to the endpoint with more (ties broken by the vertex ID). The
+ * oriented neighbors of vertex i are nbrs[begin[i]] ... nbrs[end[i] - 1],
+ * sorted and without duplicates.
+ */
+struct oriented_adjacency {
+  std::vector<size_t> begin;
+  std::vector<size_t> end;
+  std::vector<uint32_t> nbrs;
+};
+
+// Returns true if the edge between u and v is oriented from u to v
+struct degree_order {
+  const std::vector<size_t>& degree;
+  degree_order(const std::vector<size_t>& degree): degree(degree) { }
+  bool operator()(graphlab::lvid_type u, graphlab::lvid_type v) const {
+    return degree[u] < degree[v] || (degree[u] == degree[v] && u < v);
+  }
+};
+
+void build_oriented_adjacency(graph_type& graph, oriented_adjacency& adj) {
+  graph_type::local_graph_type& lgraph = graph.get_local_graph();
+  const size_t n = lgraph.num_vertices();
+  ASSERT_LT(n, size_t(uint32_t(-1)));
+  std::vector<size_t> degree(n);
+  for (size_t i = 0; i < n; ++i) {
+    degree[i] = lgraph.num_in_edges(i) + lgraph.num_out_edges(i);
+  }
+  degree_order precedes(degree);
+
+  // count the oriented edges on every vertex, then fill them in
+  std::vector<size_t> num_nbrs(n, 0);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < (int)n; ++i) {
+    const graphlab::lvid_type u = i;
+    foreach(const graph_type::local_graph_type::edge_type& e, lgraph.in_edges(u)) {
+      if (precedes(u, e.source().id())) ++num_nbrs[i];
+    }
+    foreach(const graph_type::local_graph_type::edge_type& e, lgraph.out_edges(u)) {
+      if (precedes(u, e.target().id())) ++num_nbrs[i];
+    }
+  }
+  adj.begin.resize(n);
+  adj.end.resize(n);
+  size_t total = 0;
+  for (size_t i = 0; i < n; ++i) {
+    adj.begin[i] = total;
+    total += num_nbrs[i];
+  }
+  adj.nbrs.resize(total);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < (int)n; ++i) {
+    const graphlab::lvid_type u = i;
+    uint32_t* out = &(adj.nbrs[0]) + adj.begin[i];
+    uint32_t* cur = out;
+    foreach(const graph_type::local_graph_type::edge_type& e, lgraph.in_edges(u)) {
+      if (precedes(u, e.source().id())) *cur++ = e.source().id();
+    }
+    foreach(const graph_type::local_graph_type::edge_type& e, lgraph.out_edges(u)) {
+      if (precedes(u, e.target().id())) *cur++ = e.target().id();
+    }
+    std::sort(out, cur);
+    adj.end[i] = adj.begin[i] + (std::unique(out, cur) - out);
+  }
+}
+
+/*
+ * Counts the triangles in the graph, which must all be on this machine,
+ * by intersecting the oriented neighbors on each oriented edge.
+ * If per_vertex is set, also stores the number of triangles each vertex
+ * is involved in on the vertex.
+ */
+size_t count_triangles_merge(graph_type& graph, bool per_vertex) {
+  oriented_adjacency adj;
+  build_oriented_adjacency(graph, adj);
+  const size_t n = adj.begin.size();
+  if (adj.nbrs.empty()) return 0;
+  const uint32_t* nbrs = &(adj.nbrs[0]);
+  std::vector<uint32_t> counts(per_vertex ? n : 0, 0);
+
+  size_t total = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64) reduction(+ : total)
+#endif
+  for (int i = 0; i < (int)n; ++i) {
+    const uint32_t* ubegin = nbrs + adj.begin[i];
+    const uint32_t* uend = nbrs + adj.end[i];
+    for (const uint32_t* v = ubegin; v != uend; ++v) {
+      const uint32_t* vbegin = nbrs + adj.begin[*v];
+      const uint32_t* vend = nbrs + adj.end[*v];
+      const bool u_shorter = (uend - ubegin) <= (vend - vbegin);
+      const uint32_t* sbegin = u_shorter ? ubegin : vbegin;
+      const uint32_t* send = u_shorter ? uend : vend;
+      const uint32_t* lbegin = u_shorter ? vbegin : ubegin;
+      const uint32_t* lend = u_shorter ? vend : uend;
+      if (!per_vertex) {
+        total += count_sorted_intersect(sbegin, send, lbegin, lend);
+      }
+      else {
+        per_vertex_visitor visit(&(counts[0]));
+        visit_intersect(sbegin, send, lbegin, lend, visit);
+        if (visit.count > 0) {
+          __sync_fetch_and_add(&(counts[i]), visit.count);
+          __sync_fetch_and_add(&(counts[*v]), visit.count);
+          total += visit.count;
+        }
+      }
+    }
+  }
+  if (per_vertex) {
+    graph_type::local_graph_type& lgraph = graph.get_local_graph();
+    for (size_t i = 0; i < n; ++i) {
+      lgraph.vertex_data(i).num_triangles = counts[i];
+    }
+  }
+  return total;
+}
+
+
 int main(int argc, char** argv) {
   std::cout << "This program counts the exact number of triangles in the "
             "provided graph.\n\n";
@@ -617,6 +857,15 @@ int main(int argc, char** argv) {
                        "save to file with prefix \"[per_vertex]\". "
                        "The algorithm used is slightly different "
                        "and thus will be a little slower");
+  bool merge = true;
+  clopts.attach_option("merge", merge,
+                       "If true, count by intersecting sorted adjacency "
+                       "lists on the local graph instead of running the "
+                       "engine. Only supported on a single machine: with "
+                       "more machines the engine is always used");
+  clopts.attach_option("gallop", GALLOP_RATIO,
+                       "In the merge path, gallop through the longer "
+                       "adjacency list if it is this many times longer");
   if(!clopts.parse(argc, argv)) return EXIT_FAILURE;
   if (prefix == "") {
     std::cout << "--graph is not optional\n";
@@ -644,30 +893,45 @@ int main(int argc, char** argv) {
             << "Number of edges:    " << graph.num_edges() << std::endl;
 
   graphlab::timer ti;
-  
-  // create engine to count the number of triangles
-  dc.cout() << "Counting Triangles..." << std::endl;
-  engine_type engine(dc, graph, clopts);
-  engine.signal_all();
-  engine.start();
 
-  dc.cout() << "Counted in " << ti.current_time() << " seconds" << std::endl;
-
-  if (PER_VERTEX_COUNT == false) {
-    size_t count = graph.map_reduce_edges<size_t>(get_edge_data);
+  if (merge && dc.numprocs() > 1) {
+    dc.cout() << "--merge needs the whole graph on one machine. Using the "
+              << "engine on " << dc.numprocs() << " machines." << std::endl;
+  }
+  if (merge && dc.numprocs() == 1) {
+    // all the edges are local. No engine needed.
+    dc.cout() << "Counting Triangles on the local graph..." << std::endl;
+    size_t count = count_triangles_merge(graph, PER_VERTEX_COUNT);
+    dc.cout() << "Counted in " << ti.current_time() << " seconds" << std::endl;
     dc.cout() << count << " Triangles"  << std::endl;
   }
   else {
-    graphlab::synchronous_engine<get_per_vertex_count> engine(dc, graph, clopts);
+    // create engine to count the number of triangles
+    dc.cout() << "Counting Triangles..." << std::endl;
+    engine_type engine(dc, graph, clopts);
     engine.signal_all();
     engine.start();
+
+    dc.cout() << "Counted in " << ti.current_time() << " seconds" << std::endl;
+
+    if (PER_VERTEX_COUNT == false) {
+      size_t count = graph.map_reduce_edges<size_t>(get_edge_data);
+      dc.cout() << count << " Triangles"  << std::endl;
+    }
+    else {
+      graphlab::synchronous_engine<get_per_vertex_count> engine(dc, graph, clopts);
+      engine.signal_all();
+      engine.start();
+    }
+  }
+
+  if (PER_VERTEX_COUNT) {
     graph.save(per_vertex,
             save_triangle_count(),
             false, /* no compression */
             true, /* save vertex */
             false, /* do not save edge */
             clopts.get_ncpus()); /* one file per machine */
-
   }
   
   graphlab::stop_metric_server();